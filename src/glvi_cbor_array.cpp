@@ -17,8 +17,6 @@
 #include "glvi_cbor_array.h"
 #include "glvi_cbor_value.h"
 
-auto CBORArray::size() noexcept -> size_type { return elements.size(); }
-
 [[maybe_unused]]
 char const *_glvi_cbor_array() {
   return "GLVI CBOR ARRAY";
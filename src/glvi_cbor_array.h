@@ -22,6 +22,10 @@ struct CBORValue;
 
 /**
    CBOR major type 4: Array of CBOR values.
+
+   Member functions are defined in glvi_cbor_value.h, where
+   `CBORValue` is complete, so that arrays can be built in constant
+   expressions.
  */
 class CBORArray {
   using Self = CBORArray;
@@ -30,6 +34,7 @@ public:
   using storage_type = std::vector<CBORValue>;
   using value_type = storage_type::value_type;
   using size_type = storage_type::size_type;
+  using const_iterator = storage_type::const_iterator;
 
 private:
   storage_type elements;
@@ -37,12 +42,33 @@ private:
 public:
   explicit CBORArray() noexcept = default;
 
+  /**
+     Move-constructs a CBOR array from a vector of CBOR values.
+   */
+  constexpr explicit CBORArray(storage_type&& other) noexcept;
+
   CBORArray(CBORArray&&) = default;
   CBORArray(CBORArray const&) = default;
   CBORArray& operator=(CBORArray&&) = default;
   CBORArray& operator=(CBORArray const&) = default;
 
-  size_type size() noexcept;
+  /**
+     Returns the number of elements in the array.
+   */
+  constexpr size_type size() const noexcept;
+
+  /**
+     Returns the element at index `i`
+   */
+  constexpr value_type const& operator[](size_type i) const noexcept;
+
+  constexpr const_iterator begin() const noexcept;
+  constexpr const_iterator end() const noexcept;
+
+  /**
+     Appends `value` to the end of the array.
+   */
+  constexpr void push_back(value_type&& value);
 
   constexpr void sassert();
 };
@@ -0,0 +1,90 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_bignum.h"
+#include <bit>
+#include <cstring>
+
+namespace {
+
+  using limb_type = CBORBignum::limb_type;
+
+  auto load_be64(std::byte const* p) noexcept -> limb_type {
+    limb_type limb;
+    std::memcpy(&limb, p, sizeof limb);
+    if constexpr (std::endian::native == std::endian::little)
+      limb = std::byteswap(limb);
+    return limb;
+  }
+
+  void store_be64(std::byte* p, limb_type limb) noexcept {
+    if constexpr (std::endian::native == std::endian::little)
+      limb = std::byteswap(limb);
+    std::memcpy(p, &limb, sizeof limb);
+  }
+
+  /// Bytes in the shortest big-endian representation of `limb`
+  auto significant_bytes(limb_type limb) noexcept -> std::size_t {
+    return (std::bit_width(limb) + 7) / 8;
+  }
+
+} // namespace
+
+CBORBignum::CBORBignum(storage_type&& limbs, bool negative) noexcept
+    : magnitude(std::move(limbs)), negative(negative) {
+  while (not magnitude.empty() and magnitude.back() == 0)
+    magnitude.pop_back();
+}
+
+auto CBORBignum::from_bytes(std::span<std::byte const> bytes, bool negative)
+    -> CBORBignum {
+  constexpr auto w = sizeof(limb_type);
+  auto const n = bytes.size();
+  storage_type limbs((n + w - 1) / w);
+  auto const end = bytes.data() + n;
+  for (std::size_t i = 0; i < n / w; ++i)
+    limbs[i] = load_be64(end - (i + 1) * w);
+  if (auto const rest = n % w) {
+    // the most significant limb is short; pad it with leading zeros
+    std::byte padded[w]{};
+    std::memcpy(padded + w - rest, bytes.data(), rest);
+    limbs.back() = load_be64(padded);
+  }
+  return CBORBignum(std::move(limbs), negative);
+}
+
+auto CBORBignum::byte_size() const noexcept -> std::size_t {
+  if (magnitude.empty()) return 0;
+  return significant_bytes(magnitude.back()) +
+         sizeof(limb_type) * (magnitude.size() - 1);
+}
+
+auto CBORBignum::write_bytes(std::byte* out) const noexcept -> std::byte* {
+  if (magnitude.empty()) return out;
+  std::byte top[sizeof(limb_type)];
+  store_be64(top, magnitude.back());
+  auto const k = significant_bytes(magnitude.back());
+  std::memcpy(out, top + sizeof top - k, k);
+  out += k;
+  for (auto i = magnitude.size() - 1; i-- > 0; out += sizeof(limb_type))
+    store_be64(out, magnitude[i]);
+  return out;
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_bignum() {
+  return "GLVI CBOR BIGNUM";
+}
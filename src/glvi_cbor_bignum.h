@@ -0,0 +1,115 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+   CBOR bignum (tags 2 and 3) as an arbitrary-precision integer.
+
+   Like `CBORNint`, a negative bignum stores its CBOR argument `n`,
+   and represents the integer `-1 - n`. The argument is held in 64-bit
+   limbs, least significant first, without leading zero limbs.
+
+   The parser produces bignums only for arguments that do not fit into
+   64 bits; smaller ones become `CBORUint` or `CBORNint`. The encoder
+   likewise writes bignums that fit into 64 bits as plain integers.
+ */
+class CBORBignum {
+  using Self = CBORBignum;
+
+public:
+  using limb_type = std::uint64_t;
+  using storage_type = std::vector<limb_type>;
+
+private:
+  storage_type magnitude;
+  bool negative = false;
+
+public:
+  /**
+     Constructs the bignum 0.
+   */
+  explicit CBORBignum() noexcept = default;
+
+  /**
+     Constructs a bignum from its argument in `limbs`, least
+     significant first, and its sign.
+   */
+  explicit CBORBignum(storage_type&& limbs, bool negative = false) noexcept;
+
+  /**
+     Constructs a bignum from the content of a tag 2 or 3 byte string,
+     i.e. its argument as a big-endian number of any length.
+   */
+  static auto from_bytes(std::span<std::byte const> bytes, bool negative)
+      -> CBORBignum;
+
+  CBORBignum(CBORBignum&&) = default;
+  CBORBignum(CBORBignum const&) = default;
+  CBORBignum& operator=(CBORBignum&&) = default;
+  CBORBignum& operator=(CBORBignum const&) = default;
+
+  auto is_negative() const noexcept -> bool { return negative; }
+
+  /**
+     Returns the limbs of the argument, least significant first.
+   */
+  auto limbs() const noexcept -> std::span<limb_type const> {
+    return magnitude;
+  }
+
+  /**
+     Whether the argument fits into 64 bits, so that the bignum is
+     encoded as `CBORUint` or `CBORNint`.
+   */
+  auto fits_u64() const noexcept -> bool { return magnitude.size() <= 1; }
+
+  /**
+     Returns the argument, provided it fits into 64 bits.
+   */
+  auto low_limb() const noexcept -> limb_type {
+    return magnitude.empty() ? 0 : magnitude.front();
+  }
+
+  /**
+     Returns the number of bytes in the shortest big-endian
+     representation of the argument.
+   */
+  auto byte_size() const noexcept -> std::size_t;
+
+  /**
+     Writes the shortest big-endian representation of the argument to
+     `out`, and returns the pointer past the last byte written.
+   */
+  auto write_bytes(std::byte* out) const noexcept -> std::byte*;
+
+  friend bool operator==(CBORBignum const&, CBORBignum const&) = default;
+
+  constexpr void sassert();
+};
+
+constexpr void CBORBignum::sassert() {
+  static_assert(std::is_nothrow_default_constructible_v<Self>);
+  static_assert(std::is_copy_constructible_v<Self>);
+  static_assert(std::is_nothrow_move_constructible_v<Self>);
+  static_assert(not std::is_constructible_v<Self, unsigned>);
+}
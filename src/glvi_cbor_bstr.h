@@ -15,6 +15,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
+#include <cstddef>
 #include <initializer_list>
 #include <utility>
 #include <vector>
@@ -42,22 +43,27 @@ public:
   /**
      Constructs a CBOR byte string from a list of bytes.
    */
-  explicit CBORBstr(std::initializer_list<std::byte> ilist) noexcept : storage(ilist) {}
+  constexpr explicit CBORBstr(std::initializer_list<std::byte> ilist) noexcept : storage(ilist) {}
 
   /**
      Move-constructs a CBOR byte string from a vector of bytes.
    */
-  explicit CBORBstr(storage_type &&other) : storage(std::move(other)) {}
+  constexpr explicit CBORBstr(storage_type &&other) : storage(std::move(other)) {}
 
   /**
      Copy-constructs a CBOR byte string from a vector of bytes.
    */
-  explicit CBORBstr(storage_type const &other) : storage(other) {}
+  constexpr explicit CBORBstr(storage_type const &other) : storage(other) {}
 
   /**
      Returns the number of bytes in the byte string.
    */
-  constexpr auto size() noexcept { return storage.size(); }
+  constexpr auto size() const noexcept { return storage.size(); }
+
+  /**
+     Returns a pointer to the first byte of the byte string.
+   */
+  constexpr auto data() const noexcept { return storage.data(); }
 
   /**
      Returns the byte at index `i` from the byte string
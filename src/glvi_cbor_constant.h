@@ -0,0 +1,236 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_head.h"
+#include "glvi_cbor_value.h"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+   Compile-time encoding of constant CBOR values
+ */
+namespace constant_encoding {
+
+  /**
+     Walks a value with preferred serialisation, counting bytes when
+     `Out` is `std::nullptr_t`, and writing them otherwise.
+
+     Tags cannot be built in constant expressions, as `CBORTag` holds
+     its value in a `std::shared_ptr`; the tag and custom cases are only
+     reachable at run time, as is the bignum case.
+   */
+  template <typename Out> struct Walk {
+    Out out;
+    std::size_t size = 0;
+
+    constexpr void head(MajorType major, std::uint64_t arg) {
+      if constexpr (std::same_as<Out, std::nullptr_t>)
+        size += head_size(arg);
+      else
+        out = write_head(out, major, arg);
+    }
+
+    template <typename Char>
+    constexpr void bytes(Char const* p, std::size_t n) {
+      if constexpr (std::same_as<Out, std::nullptr_t>)
+        size += n;
+      else
+        for (std::size_t i = 0; i < n; ++i)
+          *out++ = static_cast<std::byte>(p[i]);
+    }
+
+    constexpr void operator()(CBORUint const& x) {
+      head(MajorType::Uint, static_cast<std::uint64_t>(CBOR_U64(x)));
+    }
+
+    constexpr void operator()(CBORNint const& x) {
+      head(MajorType::Nint, static_cast<std::uint64_t>(CBOR_U64(x)));
+    }
+
+    constexpr void operator()(CBORBstr const& x) {
+      head(MajorType::Bstr, x.size());
+      bytes(x.data(), x.size());
+    }
+
+    constexpr void operator()(CBORTstr const& x) {
+      head(MajorType::Tstr, x.size());
+      bytes(x.data(), x.size());
+    }
+
+    constexpr void operator()(CBORArray const& x) {
+      head(MajorType::Array, x.size());
+      for (auto const& element : x)
+        element.visit(*this);
+    }
+
+    constexpr void operator()(CBORMap const& x) {
+      head(MajorType::Map, x.size());
+      for (CBORMap::size_type i = 0; i < x.size(); ++i) {
+        x.key(i).visit(*this);
+        x.value(i).visit(*this);
+      }
+    }
+
+    constexpr void operator()(CBORTag const& x) {
+      head(MajorType::Tag, static_cast<std::uint64_t>(x.tag()));
+      x.value().visit(*this);
+    }
+
+    constexpr void operator()(CBORSimple const& x) {
+      head(MajorType::Simple, static_cast<std::uint8_t>(x));
+    }
+
+    constexpr void operator()(CBORFloat const& x) {
+      if constexpr (std::same_as<Out, std::nullptr_t>)
+        size += float_size(x, EncodeMode::Preferred);
+      else
+        out = write_float(out, x, EncodeMode::Preferred);
+    }
+
+    constexpr void operator()(CBORCustom const& x) { (*this)(x.as_tag()); }
+
+    constexpr void operator()(CBORBignum const& x) {
+      if (x.fits_u64())
+        return head(x.is_negative() ? MajorType::Nint : MajorType::Uint,
+                    x.low_limb());
+      std::vector<std::byte> bytes(x.byte_size());
+      x.write_bytes(bytes.data());
+      head(MajorType::Tag, x.is_negative() ? 3 : 2);
+      head(MajorType::Bstr, bytes.size());
+      this->bytes(bytes.data(), bytes.size());
+    }
+  };
+
+  /**
+     Returns the number of bytes the preferred serialisation of `value`
+     occupies.
+   */
+  constexpr auto size(CBORValue const& value) -> std::size_t {
+    Walk<std::nullptr_t> walk{nullptr};
+    value.visit(walk);
+    return walk.size;
+  }
+
+  /**
+     Checks well-formedness of the item at `pos`, see RFC 8949
+     Appendix C, and advances `pos` past it.
+   */
+  constexpr auto well_formed(std::span<std::byte const> bytes,
+                             std::size_t& pos, unsigned depth) -> bool {
+    if (depth > deterministic_depth_max) return false;
+    auto const opt_head = read_head(bytes.subspan(pos));
+    if (not opt_head) return false;
+    auto const head = *opt_head;
+    pos += head.size;
+    if (head.is_indefinite()) {
+      switch (head.major) {
+      case MajorType::Bstr:
+      case MajorType::Tstr:
+        // chunks are definite-length strings of the same major type
+        while (pos < bytes.size() and bytes[pos] != std::byte{0xff}) {
+          auto const chunk = read_head(bytes.subspan(pos));
+          if (not chunk or chunk->major != head.major or
+              chunk->is_indefinite())
+            return false;
+          if (not well_formed(bytes, pos, depth + 1)) return false;
+        }
+        break;
+      case MajorType::Array:
+      case MajorType::Map: {
+        std::size_t items = 0;
+        while (pos < bytes.size() and bytes[pos] != std::byte{0xff}) {
+          if (not well_formed(bytes, pos, depth + 1)) return false;
+          ++items;
+        }
+        if (head.major == MajorType::Map and items % 2 != 0) return false;
+        break;
+      }
+      default: return false; // including a stray "break"
+      }
+      if (pos == bytes.size()) return false;
+      pos += 1;
+      return true;
+    }
+    switch (head.major) {
+    case MajorType::Bstr:
+    case MajorType::Tstr:
+      if (head.arg > bytes.size() - pos) return false;
+      pos += head.arg;
+      return true;
+    case MajorType::Array:
+      for (std::uint64_t i = 0; i < head.arg; ++i)
+        if (not well_formed(bytes, pos, depth + 1)) return false;
+      return true;
+    case MajorType::Map:
+      for (std::uint64_t i = 0; i < 2 * head.arg; ++i)
+        if (not well_formed(bytes, pos, depth + 1)) return false;
+      return true;
+    case MajorType::Tag: return well_formed(bytes, pos, depth + 1);
+    case MajorType::Simple: return head.info != 24 or head.arg >= 32;
+    default: return true;
+    }
+  }
+
+} // namespace constant_encoding
+
+/**
+   Encodes the value returned by `describe` at compile time, using
+   preferred serialisation, into an array of exactly the required
+   size.
+
+   `describe` must be a captureless lambda (or another default
+   constructible function object) that builds the value in a constant
+   expression, e.g.
+
+       constexpr auto ack = encode_constant([] {
+         CBORMap map;
+         map.insert(u8"type"_cbor_tstr, u8"ack"_cbor_tstr);
+         map.insert(u8"seq"_cbor_tstr, CBORUint(0_cbor));
+         return map;
+       });
+
+   The resulting array can live in read-only storage. Tags are not
+   supported, see `constant_encoding::Walk`.
+ */
+template <typename Describe>
+  requires std::default_initializable<Describe> and
+           std::constructible_from<CBORValue, std::invoke_result_t<Describe>>
+consteval auto encode_constant(Describe) {
+  constexpr auto n = constant_encoding::size(CBORValue(Describe{}()));
+  std::array<std::byte, n> result{};
+  constant_encoding::Walk<std::byte*> walk{result.data()};
+  CBORValue(Describe{}()).visit(walk);
+  return result;
+}
+
+/**
+   Checks whether `bytes` holds exactly one well-formed data item.
+   Usable in `static_assert` to verify constant messages at build time.
+
+   Items nested deeper than `deterministic_depth_max` are reported as
+   not well-formed.
+ */
+constexpr auto is_well_formed(std::span<std::byte const> bytes) -> bool {
+  std::size_t pos = 0;
+  return constant_encoding::well_formed(bytes, pos, 0) and
+         pos == bytes.size();
+}
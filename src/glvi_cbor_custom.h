@@ -0,0 +1,75 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_tag.h"
+#include "glvi_cbor_u64.h"
+#include <any>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+   Tagged CBOR value together with its interpretation as a user type,
+   as produced by a tag decoder while parsing, see `TagRegistry`.
+
+   The tagged value is kept, so a custom value encodes exactly like
+   the tagged value it was decoded from.
+ */
+class CBORCustom {
+  using Self = CBORCustom;
+
+public:
+  explicit CBORCustom(CBORTag&& tagged, std::any&& interpretation)
+    : tagged(std::move(tagged))
+    , interpretation(std::make_shared<std::any const>(std::move(interpretation)))
+  {}
+
+  CBOR_U64 tag() const noexcept { return tagged.tag(); }
+
+  /**
+     Returns the tagged value this custom value was decoded from.
+   */
+  auto const& as_tag() const noexcept { return tagged; }
+
+  /**
+     Returns the interpretation of the tagged value.
+   */
+  auto const& value() const noexcept { return *interpretation; }
+
+  /**
+     Returns a pointer to the interpretation if it has type `T`, and a
+     null pointer otherwise.
+   */
+  template <typename T> auto get() const noexcept -> T const* {
+    return std::any_cast<T>(interpretation.get());
+  }
+
+  constexpr void sassert();
+
+private:
+  CBORTag tagged;
+  // shared, so that copying stays cheap and cannot throw, as for tags
+  std::shared_ptr<std::any const> interpretation;
+};
+
+constexpr void CBORCustom::sassert() {
+  static_assert(not std::is_default_constructible_v<Self>);
+  static_assert(std::is_nothrow_copy_constructible_v<Self>);
+  static_assert(std::is_nothrow_move_constructible_v<Self>);
+  static_assert(std::is_nothrow_copy_assignable_v<Self>);
+  static_assert(std::is_nothrow_move_assignable_v<Self>);
+}
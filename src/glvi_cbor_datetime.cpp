@@ -0,0 +1,239 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_datetime.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+  using std::chrono::nanoseconds;
+
+  /**
+     Layout of one 8-byte word of "YYYY-MM-DDTHH:MM:SS": `digits` has
+     0xff at digit positions, `separators` holds the separators in
+     the other positions. Byte `i` of the text is byte `i` of the word,
+     counting from the least significant byte.
+   */
+  struct WordLayout {
+    std::uint64_t digits;
+    std::uint64_t separators;
+  };
+
+  constexpr auto word_layout(std::u8string_view pattern) noexcept
+      -> WordLayout {
+    WordLayout layout{0, 0};
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+      auto const c = static_cast<std::uint64_t>(pattern[i]);
+      if (c == u8'D')
+        layout.digits |= std::uint64_t{0xff} << 8 * i;
+      else
+        layout.separators |= c << 8 * i;
+    }
+    return layout;
+  }
+
+  // 'T' is case-insensitive; setting bit 5 maps it to 't'
+  constexpr auto layout0 = word_layout(u8"DDDD-DD-");
+  constexpr auto layout1 = word_layout(u8"DDtDD:DD");
+  constexpr auto layout2 = word_layout(u8":DD");
+  constexpr std::uint64_t lower1 = std::uint64_t{0x20} << 16;
+
+  constexpr std::uint64_t ones = 0x0101010101010101;
+
+  auto load_le64(char8_t const* p, std::size_t n) noexcept -> std::uint64_t {
+    std::uint64_t word = 0;
+    std::memcpy(&word, p, n);
+    if constexpr (std::endian::native == std::endian::big)
+      word = std::byteswap(word);
+    return word;
+  }
+
+  /**
+     Checks the separators and digits of `word` against `layout`,
+     and replaces the digits by their values.
+   */
+  auto check_word(std::uint64_t& word, WordLayout layout) noexcept -> bool {
+    auto const d = layout.digits;
+    if ((word & ~d) != layout.separators) return false;
+    // digits are 0x30..0x39: high nibble 3, and no carry out of the
+    // low nibble when adding 6
+    auto const high = (0xf0 * ones) & d;
+    auto const three = (0x30 * ones) & d;
+    if ((word & high) != three) return false;
+    if (((word + (0x06 * ones & d)) & high) != three) return false;
+    word = (word & d) - three;
+    return true;
+  }
+
+  constexpr auto digit(std::uint64_t word, unsigned i) noexcept -> int {
+    return static_cast<int>((word >> 8 * i) & 0xf);
+  }
+
+  constexpr auto two(std::uint64_t word, unsigned i) noexcept -> int {
+    return 10 * digit(word, i) + digit(word, i + 1);
+  }
+
+  auto is_digit(char8_t c) noexcept -> bool {
+    return c >= u8'0' and c <= u8'9';
+  }
+
+  /// "00" to "99"
+  constexpr auto digit_pairs = [] {
+    std::array<char8_t, 200> pairs{};
+    for (int i = 0; i < 100; ++i) {
+      pairs[2 * i] = static_cast<char8_t>(u8'0' + i / 10);
+      pairs[2 * i + 1] = static_cast<char8_t>(u8'0' + i % 10);
+    }
+    return pairs;
+  }();
+
+  auto put2(char8_t* out, unsigned n) noexcept -> char8_t* {
+    std::memcpy(out, digit_pairs.data() + 2 * n, 2);
+    return out + 2;
+  }
+
+} // namespace
+
+auto parse_rfc3339(std::u8string_view text) noexcept
+    -> std::optional<CBORTime> {
+  using namespace std::chrono;
+  constexpr std::size_t fixed = 19;
+  // fixed part, plus at least "Z"
+  if (text.size() < fixed + 1) return std::nullopt;
+  auto const p = text.data();
+  auto w0 = load_le64(p, 8);
+  auto w1 = load_le64(p + 8, 8) | lower1;
+  auto w2 = load_le64(p + 16, 3);
+  if (not check_word(w0, layout0) or not check_word(w1, layout1) or
+      not check_word(w2, layout2))
+    return std::nullopt;
+  auto const y = 100 * two(w0, 0) + two(w0, 2);
+  auto const mo = two(w0, 5);
+  auto const d = two(w1, 0);
+  auto const h = two(w1, 3);
+  auto const mi = two(w1, 6);
+  auto const s = two(w2, 1);
+  year_month_day const ymd{year(y), month(mo), day(d)};
+  if (not ymd.ok() or h > 23 or mi > 59 or s > 59) return std::nullopt;
+
+  auto pos = fixed;
+  nanoseconds fraction{0};
+  if (text[pos] == u8'.') {
+    auto const first = ++pos;
+    std::int64_t ns = 0;
+    while (pos < text.size() and is_digit(text[pos])) {
+      if (pos - first < 9) ns = 10 * ns + (text[pos] - u8'0');
+      ++pos;
+    }
+    if (pos == first) return std::nullopt;
+    for (auto n = pos - first; n < 9; ++n) ns *= 10;
+    fraction = nanoseconds(ns);
+  }
+  if (pos == text.size()) return std::nullopt;
+
+  minutes offset{0};
+  auto const zone = text[pos];
+  if ((zone | 0x20) == u8'z') {
+    pos += 1;
+  } else if (zone == u8'+' or zone == u8'-') {
+    if (text.size() - pos != 6 or not is_digit(text[pos + 1]) or
+        not is_digit(text[pos + 2]) or text[pos + 3] != u8':' or
+        not is_digit(text[pos + 4]) or not is_digit(text[pos + 5]))
+      return std::nullopt;
+    auto const oh = 10 * (text[pos + 1] - u8'0') + (text[pos + 2] - u8'0');
+    auto const om = 10 * (text[pos + 4] - u8'0') + (text[pos + 5] - u8'0');
+    if (oh > 23 or om > 59) return std::nullopt;
+    offset = minutes(60 * oh + om);
+    if (zone == u8'-') offset = -offset;
+    pos += 6;
+  } else {
+    return std::nullopt;
+  }
+  if (pos != text.size()) return std::nullopt;
+
+  auto const whole =
+      sys_days(ymd) + hours(h) + minutes(mi) + seconds(s) - offset;
+  // keeps whole seconds plus fraction within the range of nanoseconds
+  constexpr seconds::rep limit =
+      std::numeric_limits<nanoseconds::rep>::max() / 1'000'000'000 - 1;
+  auto const count = whole.time_since_epoch().count();
+  if (count < -limit or count > limit) return std::nullopt;
+  return whole + fraction;
+}
+
+auto format_rfc3339(CBORTime time, char8_t* out) noexcept -> std::size_t {
+  using namespace std::chrono;
+  auto const days = floor<std::chrono::days>(time);
+  year_month_day const ymd{days};
+  // the range of CBORTime lies within years 1677..2262
+  auto const y = static_cast<int>(ymd.year());
+  hh_mm_ss const hms{time - days};
+  auto const first = out;
+  out = put2(out, static_cast<unsigned>(y / 100));
+  out = put2(out, static_cast<unsigned>(y % 100));
+  *out++ = u8'-';
+  out = put2(out, static_cast<unsigned>(ymd.month()));
+  *out++ = u8'-';
+  out = put2(out, static_cast<unsigned>(ymd.day()));
+  *out++ = u8'T';
+  out = put2(out, static_cast<unsigned>(hms.hours().count()));
+  *out++ = u8':';
+  out = put2(out, static_cast<unsigned>(hms.minutes().count()));
+  *out++ = u8':';
+  out = put2(out, static_cast<unsigned>(hms.seconds().count()));
+  if (auto ns = static_cast<std::uint32_t>(hms.subseconds().count())) {
+    char8_t digits[9];
+    for (int i = 8; i >= 0; --i, ns /= 10)
+      digits[i] = static_cast<char8_t>(u8'0' + ns % 10);
+    auto n = 9;
+    while (digits[n - 1] == u8'0') --n;
+    *out++ = u8'.';
+    std::memcpy(out, digits, n);
+    out += n;
+  }
+  *out++ = u8'Z';
+  return static_cast<std::size_t>(out - first);
+}
+
+auto format_rfc3339(CBORTime time) -> std::u8string {
+  char8_t buffer[rfc3339_size_max];
+  return std::u8string(buffer, format_rfc3339(time, buffer));
+}
+
+auto make_datetime(CBORTime time) -> CBORTag {
+  return CBORTag(0_cbor, CBORTstr(format_rfc3339(time)));
+}
+
+auto make_epoch_time(CBORTime time) -> CBORTag {
+  auto const ns = time.time_since_epoch().count();
+  if (ns % 1'000'000'000 == 0) {
+    auto const s = ns / 1'000'000'000;
+    // major type 1 encodes -1 - n
+    if (s < 0)
+      return CBORTag(1_cbor, CBORNint(CBOR_U64(std::uint64_t(-1 - s))));
+    return CBORTag(1_cbor, CBORUint(CBOR_U64(std::uint64_t(s))));
+  }
+  return CBORTag(1_cbor, CBORFloat{static_cast<double>(ns) / 1e9});
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_datetime() {
+  return "GLVI CBOR DATETIME";
+}
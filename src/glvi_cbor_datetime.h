@@ -0,0 +1,72 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_value.h"
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+   Point in time as decoded from tags 0 and 1
+ */
+using CBORTime = std::chrono::sys_time<std::chrono::nanoseconds>;
+
+/**
+   Maximum length of a date/time string written by `format_rfc3339`,
+   e.g. "2025-01-31T23:59:59.123456789Z"
+ */
+constexpr std::size_t rfc3339_size_max = 30;
+
+/**
+   Parses an RFC 3339 date/time string, see RFC 3339 §5.6, as used by
+   tag 0, e.g. "2013-03-21T20:04:00Z" or "2013-03-21T20:04:00.5+01:00".
+
+   The fixed part of the layout is validated a word at a time: all 14
+   digits and 5 separators of "YYYY-MM-DDTHH:MM:SS" in three loads.
+   Fractions beyond nanoseconds are truncated. Returns an empty
+   optional for strings that are malformed, that denote an invalid
+   date, or that `CBORTime` cannot hold: leap seconds, and times more
+   than about 292 years away from 1970.
+ */
+auto parse_rfc3339(std::u8string_view text) noexcept
+    -> std::optional<CBORTime>;
+
+/**
+   Writes `time` as an RFC 3339 date/time string in UTC to `out`,
+   which must hold `rfc3339_size_max` characters, and returns the
+   number of characters written. Fractional seconds are written
+   without trailing zeros, or omitted.
+ */
+auto format_rfc3339(CBORTime time, char8_t* out) noexcept -> std::size_t;
+
+/**
+   Returns `time` as an RFC 3339 date/time string in UTC, see above.
+ */
+auto format_rfc3339(CBORTime time) -> std::u8string;
+
+/**
+   Makes a tag 0 value holding `time` as a date/time string.
+ */
+auto make_datetime(CBORTime time) -> CBORTag;
+
+/**
+   Makes a tag 1 value holding `time` as seconds since the epoch: an
+   integer for whole seconds, and a float otherwise.
+ */
+auto make_epoch_time(CBORTime time) -> CBORTag;
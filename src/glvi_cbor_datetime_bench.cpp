@@ -0,0 +1,107 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_datetime.h"
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+   Compares `parse_rfc3339` with `std::chrono::parse` on date/time
+   strings as found in tag 0, and `format_rfc3339` with
+   `std::format`. Build with `make glvi_cbor_datetime_bench`.
+ */
+
+using namespace std::chrono;
+
+namespace {
+
+  constexpr std::size_t count = 200'000;
+
+  auto timestamps() -> std::vector<CBORTime> {
+    std::vector<CBORTime> times;
+    times.reserve(count);
+    auto t = sys_days(2025y / January / 1) + 0ns;
+    for (std::size_t i = 0; i < count; ++i) {
+      t += 7s + 123457us * static_cast<int>(i % 3);
+      times.push_back(t);
+    }
+    return times;
+  }
+
+  template <typename F> auto measure(char const* name, F&& f) -> double {
+    auto const start = steady_clock::now();
+    auto const checksum = f();
+    auto const elapsed =
+        duration<double, std::nano>(steady_clock::now() - start);
+    auto const per_item = elapsed.count() / count;
+    std::printf("%-24s %8.1f ns/item  (checksum %lld)\n", name, per_item,
+                static_cast<long long>(checksum));
+    return per_item;
+  }
+
+} // namespace
+
+int main() {
+  auto const times = timestamps();
+  std::vector<std::u8string> texts;
+  std::vector<std::string> plain;
+  texts.reserve(count);
+  plain.reserve(count);
+  for (auto t : times) {
+    texts.push_back(format_rfc3339(t));
+    plain.emplace_back(texts.back().begin(), texts.back().end());
+  }
+
+  auto const ours = measure("parse_rfc3339", [&] {
+    std::int64_t sum = 0;
+    for (auto const& text : texts)
+      sum += parse_rfc3339(text)->time_since_epoch().count();
+    return sum;
+  });
+  auto const theirs = measure("std::chrono::parse", [&] {
+    std::int64_t sum = 0;
+    std::istringstream in;
+    for (auto const& text : plain) {
+      in.clear();
+      in.str(text);
+      CBORTime t;
+      in >> std::chrono::parse("%FT%TZ", t);
+      sum += t.time_since_epoch().count();
+    }
+    return sum;
+  });
+  std::printf("speed-up %.1fx\n\n", theirs / ours);
+
+  auto const format_ours = measure("format_rfc3339", [&] {
+    std::int64_t sum = 0;
+    char8_t buffer[rfc3339_size_max];
+    for (auto t : times)
+      sum += format_rfc3339(t, buffer);
+    return sum;
+  });
+  auto const format_theirs = measure("std::format", [&] {
+    std::int64_t sum = 0;
+    for (auto t : times)
+      sum += std::format("{:%FT%TZ}", t).size();
+    return sum;
+  });
+  std::printf("speed-up %.1fx\n", format_theirs / format_ours);
+  return 0;
+}
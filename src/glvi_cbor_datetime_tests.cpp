@@ -0,0 +1,131 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_datetime.h"
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_parser.h"
+#include <dejagnu.h>
+#include <source_location>
+
+using namespace std::chrono;
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+class CBORDateTimeTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(parse_valid)
+  {
+    // the example of RFC 8949 §3.4.1, and variants
+    auto const example = sys_days(2013y / March / 21) + 20h + 4min;
+    if (parse_rfc3339(u8"2013-03-21T20:04:00Z") == example and
+        parse_rfc3339(u8"2013-03-21t20:04:00z") == example and
+        parse_rfc3339(u8"2013-03-21T21:34:00+01:30") == example and
+        parse_rfc3339(u8"2013-03-21T19:04:00-01:00") == example and
+        parse_rfc3339(u8"2013-03-21T20:04:00.25Z") == example + 250ms and
+        parse_rfc3339(u8"2013-03-21T20:04:00.0000000019Z") ==
+            example + 1ns and
+        parse_rfc3339(u8"2024-02-29T00:00:00Z") ==
+            sys_days(2024y / February / 29) and
+        parse_rfc3339(u8"1900-01-01T00:00:00Z") ==
+            sys_days(1900y / January / 1)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(parse_invalid)
+  {
+    for (auto text : {
+             u8"2013-03-21T20:04:00", u8"2013-03-21 20:04:00Z",
+             u8"2013-03-21T20:04Z", u8"2013-3-21T20:04:00Z",
+             u8"2013-03-21T20:04:0aZ", u8"2013-03-21T20:04:00.Z",
+             u8"2013-13-21T20:04:00Z", u8"2023-02-29T20:04:00Z",
+             u8"2013-03-21T24:00:00Z", u8"2016-12-31T23:59:60Z",
+             u8"2013-03-21T20:04:00+0100", u8"2013-03-21T20:04:00Z ",
+             u8"2013/03/21T20:04:00Z", u8"1500-01-01T00:00:00Z",
+         }) {
+      if (parse_rfc3339(text)) {
+        return fail(std::source_location::current().function_name());
+      }
+    }
+    return pass(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(format)
+  {
+    auto const t = sys_days(2013y / March / 21) + 20h + 4min;
+    char8_t buffer[rfc3339_size_max];
+    auto const longest = format_rfc3339(
+        sys_days(2200y / December / 31) + 86399s + 999999999ns, buffer);
+    if (format_rfc3339(t) == u8"2013-03-21T20:04:00Z" and
+        format_rfc3339(t + 120ms) == u8"2013-03-21T20:04:00.12Z" and
+        format_rfc3339(sys_days(1969y / December / 31) + 1ns) ==
+            u8"1969-12-31T00:00:00.000000001Z" and
+        longest == rfc3339_size_max) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(tags)
+  {
+    StaticTagRegistry<tag_decoders::DateTime, tag_decoders::EpochTime> tags;
+    auto const t = sys_days(2013y / March / 21) + 20h + 4min + 500ms;
+    auto const round_trip = [&](CBORValue const& value) {
+      std::vector<std::uint8_t> octets;
+      for (auto b : encode(value))
+        octets.push_back(std::to_integer<std::uint8_t>(b));
+      auto const decoded = decode(octets, tags);
+      auto const custom = decoded->as_custom_cref();
+      return custom ? *custom->get().get<CBORTime>() : CBORTime{};
+    };
+    if (round_trip(make_datetime(t)) == t and
+        round_trip(make_epoch_time(t)) == t and
+        round_trip(make_epoch_time(sys_days(1969y / December / 31))) ==
+            sys_days(1969y / December / 31) and
+        make_epoch_time(sys_seconds(1363896240s)).value().is_uint()) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORDateTimeTests testSuite{};
+  testSuite.test_parse_valid();
+  testSuite.test_parse_invalid();
+  testSuite.test_format();
+  testSuite.test_tags();
+  return testSuite.failure();
+}
@@ -0,0 +1,328 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_diagnostic.h"
+#include "glvi_cbor_constant.h"
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_float.h"
+#include "glvi_cbor_head.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+  template <typename... Ts> struct adhoc : Ts... {
+    using Ts::operator()...;
+  };
+  template <typename... Ts> adhoc(Ts...) -> adhoc<Ts...>;
+
+  /**
+     Writes diagnostic notation for items read in place from `bytes`
+     into `[p, end)`, keeping room for a final "..." in case the text
+     does not fit.
+   */
+  struct DiagnosticWriter {
+    std::span<std::byte const> bytes;
+    char* p;
+    char* limit;
+    DiagnosticOptions options;
+    std::size_t pos = 0;
+    bool full = false;
+
+    auto put(std::string_view text) noexcept -> bool {
+      if (full) return false;
+      auto const room = static_cast<std::size_t>(limit - p);
+      auto const n = std::min(room, text.size());
+      p = std::copy_n(text.data(), n, p);
+      full = n < text.size();
+      return not full;
+    }
+
+    auto put(char c) noexcept -> bool { return put(std::string_view(&c, 1)); }
+
+    auto malformed() noexcept -> bool {
+      (void)put("<malformed>");
+      return false;
+    }
+
+    template <typename Number> auto number(Number x) noexcept -> bool {
+      char buffer[32];
+      auto const result = std::to_chars(buffer, buffer + sizeof buffer, x);
+      return put(std::string_view(buffer, result.ptr - buffer));
+    }
+
+    auto floating(double x) noexcept -> bool {
+      if (std::isnan(x)) return put("NaN");
+      if (std::isinf(x)) return put(x < 0 ? "-Infinity" : "Infinity");
+      char buffer[32];
+      auto const result = std::to_chars(buffer, buffer + sizeof buffer, x);
+      std::string_view const text(buffer, result.ptr - buffer);
+      // keep floats with integral values apart from integers
+      if (text.find_first_of(".e") == text.npos)
+        return put(text) and put(".0");
+      return put(text);
+    }
+
+    auto string(MajorType major, std::span<std::byte const> payload) noexcept
+        -> bool {
+      constexpr char hex[] = "0123456789abcdef";
+      auto n = std::min(payload.size(), options.string_max);
+      if (major == MajorType::Bstr) {
+        if (not put("h'")) return false;
+        for (std::size_t i = 0; i < n; ++i) {
+          auto const octet = std::to_integer<std::uint8_t>(payload[i]);
+          if (not put(hex[octet >> 4]) or not put(hex[octet & 0xf]))
+            return false;
+        }
+        return (n == payload.size() or put("...")) and put('\'');
+      }
+      // do not cut a UTF-8 sequence apart
+      while (n < payload.size() and n > 0 and
+             (std::to_integer<std::uint8_t>(payload[n]) & 0xc0) == 0x80)
+        --n;
+      if (not put('"')) return false;
+      for (std::size_t i = 0; i < n; ++i) {
+        auto const c = std::to_integer<char>(payload[i]);
+        auto const ok = [&] {
+          switch (c) {
+          case '"': return put("\\\"");
+          case '\\': return put("\\\\");
+          case '\n': return put("\\n");
+          default:
+            if (static_cast<unsigned char>(c) < 0x20)
+              return put("\\u00") and put(hex[c >> 4]) and put(hex[c & 0xf]);
+            return put(c);
+          }
+        }();
+        if (not ok) return false;
+      }
+      return (n == payload.size() or put("...")) and put('"');
+    }
+
+    auto payload(std::uint64_t n, std::span<std::byte const>& result) noexcept
+        -> bool {
+      if (n > bytes.size() - pos) return false;
+      result = bytes.subspan(pos, n);
+      pos += n;
+      return true;
+    }
+
+    /**
+       Writes the elements of an array (`per_element` 1) or the
+       entries of a map (2), skipping those beyond `items_max`.
+     */
+    auto elements(ItemHead const& head, unsigned depth,
+                  unsigned per_element) noexcept -> bool {
+      for (std::uint64_t i = 0;; ++i) {
+        if (head.is_indefinite()) {
+          if (pos == bytes.size()) return malformed();
+          if (bytes[pos] == std::byte{0xff}) {
+            pos += 1;
+            return true;
+          }
+        } else if (i == head.arg) {
+          return true;
+        }
+        if (i >= options.items_max) {
+          if (i == options.items_max and not put(i > 0 ? ", ..." : "..."))
+            return false;
+          for (unsigned k = 0; k < per_element; ++k)
+            if (not constant_encoding::well_formed(bytes, pos, depth + 1))
+              return malformed();
+          continue;
+        }
+        if (i > 0 and not put(", ")) return false;
+        if (not item(depth + 1)) return false;
+        if (per_element == 2 and not (put(": ") and item(depth + 1)))
+          return false;
+      }
+    }
+
+    auto item(unsigned depth) noexcept -> bool {
+      if (depth > deterministic_depth_max) return malformed();
+      auto const opt_head = read_head(bytes.subspan(pos));
+      if (not opt_head) return malformed();
+      auto const head = *opt_head;
+      pos += head.size;
+      switch (head.major) {
+      case MajorType::Uint:
+        if (head.is_indefinite()) return malformed();
+        return number(head.arg);
+      case MajorType::Nint:
+        if (head.is_indefinite()) return malformed();
+        if (head.arg == std::numeric_limits<std::uint64_t>::max())
+          return put("-18446744073709551616");
+        return put('-') and number(head.arg + 1);
+      case MajorType::Bstr:
+      case MajorType::Tstr: {
+        std::span<std::byte const> content;
+        if (not head.is_indefinite()) {
+          if (not payload(head.arg, content)) return malformed();
+          return string(head.major, content);
+        }
+        if (not put("(_ ")) return false;
+        for (std::size_t i = 0;; ++i) {
+          if (pos == bytes.size()) return malformed();
+          if (bytes[pos] == std::byte{0xff}) break;
+          auto const chunk = read_head(bytes.subspan(pos));
+          if (not chunk or chunk->major != head.major or
+              chunk->is_indefinite())
+            return malformed();
+          pos += chunk->size;
+          if (not payload(chunk->arg, content)) return malformed();
+          if (i > 0 and not put(", ")) return false;
+          if (not string(head.major, content)) return false;
+        }
+        pos += 1;
+        return put(')');
+      }
+      case MajorType::Array:
+        return put(head.is_indefinite() ? "[_ " : "[") and
+               elements(head, depth, 1) and put(']');
+      case MajorType::Map:
+        return put(head.is_indefinite() ? "{_ " : "{") and
+               elements(head, depth, 2) and put('}');
+      case MajorType::Tag:
+        if (head.is_indefinite()) return malformed();
+        return number(head.arg) and put('(') and item(depth + 1) and
+               put(')');
+      case MajorType::Simple:
+        switch (head.info) {
+        case 20: return put("false");
+        case 21: return put("true");
+        case 22: return put("null");
+        case 23: return put("undefined");
+        case 24:
+          if (head.arg < 32) return malformed();
+          return put("simple(") and number(head.arg) and put(')');
+        case 25:
+        case 26:
+        case 27:
+          return floating(from_bits(
+              head.arg, static_cast<std::uint8_t>(1 << (head.info - 24))));
+        case CBOR_INDEFINITE: return malformed(); // stray "break"
+        default:
+          return put("simple(") and number(head.arg) and put(')');
+        }
+      }
+      return malformed();
+    }
+
+    /**
+       Writes `node` as `item` writes its encoding, walking the value
+       rather than encoding it, so that writing stops once the text is
+       full. Leaves other than strings are encoded one at a time.
+     */
+    auto walk(CBORValue const& node, unsigned depth) -> bool {
+      if (depth > deterministic_depth_max) return malformed();
+      return node.visit(adhoc{
+          [&](CBORBstr const& x) {
+            auto const content = std::as_bytes(std::span(x.data(), x.size()));
+            return string(MajorType::Bstr, content);
+          },
+          [&](CBORTstr const& x) {
+            auto const content = std::as_bytes(std::span(x.data(), x.size()));
+            return string(MajorType::Tstr, content);
+          },
+          [&](CBORArray const& a) {
+            if (not put('[')) return false;
+            for (CBORArray::size_type i = 0; i < a.size(); ++i) {
+              if (i == options.items_max) return put(i > 0 ? ", ...]" : "...]");
+              if (i > 0 and not put(", ")) return false;
+              if (not walk(a[i], depth + 1)) return false;
+            }
+            return put(']');
+          },
+          [&](CBORMap const& m) {
+            if (not put('{')) return false;
+            for (CBORMap::size_type i = 0; i < m.size(); ++i) {
+              if (i == options.items_max) return put(i > 0 ? ", ...}" : "...}");
+              if (i > 0 and not put(", ")) return false;
+              if (not (walk(m.key(i), depth + 1) and put(": ") and
+                       walk(m.value(i), depth + 1)))
+                return false;
+            }
+            return put('}');
+          },
+          [&](CBORTag const& t) {
+            return number(static_cast<std::uint64_t>(t.tag())) and put('(') and
+                   walk(t.value(), depth + 1) and put(')');
+          },
+          [&](auto const&) {
+            auto const encoded = encode(node);
+            auto const outer = std::exchange(bytes, encoded);
+            auto const at = std::exchange(pos, 0);
+            auto const written = item(depth);
+            bytes = outer;
+            pos = at;
+            return written;
+          },
+      });
+    }
+  };
+
+  /**
+     Runs `write` on a writer into `out`, which ends the text with
+     "..." if it does not fit, and returns the number of characters
+     written.
+   */
+  template <typename Write>
+  auto write_diagnostic(std::span<std::byte const> bytes, std::span<char> out,
+                        DiagnosticOptions options, Write&& write)
+      -> std::size_t {
+    constexpr std::string_view ellipsis = "...";
+    auto const reserve = std::min(out.size(), ellipsis.size());
+    DiagnosticWriter writer{bytes, out.data(),
+                            out.data() + out.size() - reserve, options};
+    write(writer);
+    if (writer.full)
+      writer.p = std::copy_n(ellipsis.data(), reserve, writer.p);
+    return writer.p - out.data();
+  }
+
+} // namespace
+
+auto format_diagnostic(std::span<std::byte const> bytes, std::span<char> out,
+                       DiagnosticOptions options) noexcept -> std::size_t {
+  return write_diagnostic(bytes, out, options, [](DiagnosticWriter& writer) {
+    (void)writer.item(0);
+  });
+}
+
+#if __cpp_lib_format
+
+auto std::formatter<CBORValue, char>::format(CBORValue const& value,
+                                             std::format_context& ctx) const
+    -> std::format_context::iterator {
+  std::string text(size, '\0');
+  text.resize(write_diagnostic({}, text, {}, [&](DiagnosticWriter& writer) {
+    (void)writer.walk(value, 0);
+  }));
+  return std::ranges::copy(text, ctx.out()).out;
+}
+
+#endif
+
+[[maybe_unused]]
+char const *_glvi_cbor_diagnostic() {
+  return "GLVI CBOR DIAGNOSTIC";
+}
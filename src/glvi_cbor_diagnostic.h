@@ -0,0 +1,81 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_value.h"
+#include <cstddef>
+#include <span>
+#if __has_include(<format>)
+#include <format>
+#endif
+
+/**
+   Bounds on the diagnostic notation written for one item
+ */
+struct DiagnosticOptions {
+  /// bytes of a string shown before it is cut off with "..."
+  std::size_t string_max = 64;
+  /// elements of an array, or entries of a map, shown before "..."
+  std::size_t items_max = 16;
+};
+
+/**
+   Writes the CBOR item at the start of `bytes` in diagnostic
+   notation, see RFC 8949 §8, to `out`, and returns the number of
+   characters written.
+
+   Reads the item in place and writes into `out` only, so it does not
+   allocate. Long strings and containers are cut off with "..." as
+   `options` says, and so is the whole text if `out` is too small.
+   Malformed input ends the text with "<malformed>".
+
+       char buffer[200];
+       auto n = format_diagnostic(bytes, buffer);
+       log(std::string_view(buffer, n));
+ */
+auto format_diagnostic(std::span<std::byte const> bytes, std::span<char> out,
+                       DiagnosticOptions options = {}) noexcept
+    -> std::size_t;
+
+#if __cpp_lib_format
+
+/**
+   Formats a `CBORValue` in diagnostic notation. The format
+   specification may give the maximum length of the text, e.g.
+   `std::format("{:80}", value)`; the default is 256. The value is
+   written as it is walked, which stops at that length, so a large
+   value is not encoded in full to show the start of it.
+ */
+template <> struct std::formatter<CBORValue, char> {
+  std::size_t size = 256;
+
+  constexpr auto parse(std::format_parse_context& ctx) {
+    auto it = ctx.begin();
+    if (it != ctx.end() and *it >= '0' and *it <= '9') {
+      size = 0;
+      while (it != ctx.end() and *it >= '0' and *it <= '9')
+        size = size * 10 + static_cast<std::size_t>(*it++ - '0');
+    }
+    if (it != ctx.end() and *it != '}')
+      throw std::format_error("invalid format specification for CBORValue");
+    return it;
+  }
+
+  auto format(CBORValue const& value, std::format_context& ctx) const
+      -> std::format_context::iterator;
+};
+
+#endif
@@ -0,0 +1,129 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_diagnostic.h"
+#include "glvi_cbor_encoder.h"
+#include <dejagnu.h>
+#include <source_location>
+#include <string>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+
+  auto bytes(std::initializer_list<int> octets) -> std::vector<std::byte> {
+    std::vector<std::byte> result;
+    for (auto octet : octets) result.push_back(static_cast<std::byte>(octet));
+    return result;
+  }
+
+  auto diagnostic(std::vector<std::byte> const& input, std::size_t size = 200,
+                  DiagnosticOptions options = {}) -> std::string {
+    std::string out(size, '\0');
+    out.resize(format_diagnostic(input, out, options));
+    return out;
+  }
+
+} // namespace
+
+class CBORDiagnosticTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(format_items)
+  {
+    auto const input = bytes({
+        0x8d, 0x01, 0x21, 0x42, 0x01, 0x02, 0x63, 'a', '"', 'b', 0xf9,
+        0x3c, 0x00, 0xf9, 0x3e, 0x00, 0xf5, 0xf6, 0xf7, 0xf0, 0xc0, 0x61,
+        'x', 0xbf, 0x01, 0x02, 0xff, 0x7f, 0x62, 'a', 'b', 0x61, 'c', 0xff,
+    });
+    if (diagnostic(input) ==
+        "[1, -2, h'0102', \"a\\\"b\", 1.0, 1.5, true, null, undefined, "
+        "simple(16), 0(\"x\"), {_ 1: 2}, (_ \"ab\", \"c\")]") {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(format_bounded)
+  {
+    DiagnosticOptions const short_items{.string_max = 3, .items_max = 2};
+    auto const seven = bytes({0x87, 1, 2, 3, 4, 5, 6, 7});
+    if (diagnostic(seven, 200, short_items) == "[1, 2, ...]" and
+        diagnostic(bytes({0x66, 'a', 'b', 'c', 'd', 0xc3, 0xa9}), 200,
+                   short_items) == "\"abc...\"" and
+        diagnostic(bytes({0x63, 'a', 0xc3, 0xa9}), 200,
+                   {.string_max = 2}) == "\"a...\"" and
+        diagnostic(bytes({0x44, 1, 2, 3, 4}), 200, short_items) ==
+            "h'010203...'" and
+        diagnostic(seven, 10) == "[1, 2, ..." and
+        diagnostic(bytes({0x82, 0x01})) == "[1, <malformed>" and
+        diagnostic(bytes({0xff})) == "<malformed>") {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(format_value)
+  {
+#if __cpp_lib_format
+    // the formatter walks the value, and writes what format_diagnostic
+    // writes for its encoding
+    CBORArray inner;
+    for (unsigned i = 0; i < 20; ++i) inner.push_back(CBORNint(CBOR_U64(i)));
+    CBORMap map;
+    map.insert(u8"key"_cbor_tstr, CBORBstr(bytes({1, 2})));
+    map.insert(CBORFloat{1.5}, CBORTag(CBOR_U64(0u), u8"x"_cbor_tstr));
+    CBORArray value;
+    value.push_back(std::move(inner));
+    value.push_back(std::move(map));
+    value.push_back(CBOR_Null);
+    auto const encoded = encode(value);
+    auto const text = std::format("{}", CBORValue(value));
+    auto const cut = std::format("{:24}", CBORValue(value));
+    if (text == diagnostic(encoded, 256) and cut == diagnostic(encoded, 24) and
+        cut.size() == 24 and cut.ends_with("...")) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+#else
+    return pass(std::source_location::current().function_name());
+#endif
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORDiagnosticTests testSuite{};
+  testSuite.test_format_items();
+  testSuite.test_format_bounded();
+  testSuite.test_format_value();
+  return testSuite.failure();
+}
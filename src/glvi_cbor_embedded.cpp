@@ -0,0 +1,63 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_embedded.h"
+#include "glvi_cbor_encoder.h"
+#include <cstdint>
+
+EmbeddedCBOR::EmbeddedCBOR(CBORTag const& tagged, DecodeLimits const& limits)
+    : owner{tagged}, limits{limits} {
+  auto const& bstr = owner->value().as_bstr_cref()->get();
+  encoded = std::span(bstr.data(), bstr.size());
+}
+
+auto EmbeddedCBOR::is_decoded() const noexcept -> bool {
+  return decoded->done.load(std::memory_order_acquire);
+}
+
+auto EmbeddedCBOR::value() const
+    -> std::expected<CBORValue, ParseError> const& {
+  std::call_once(decoded->once, [this] {
+    // nested embedded items become views as well
+    static StaticTagRegistry<tag_decoders::Embedded> const tags;
+    auto const octets = std::span(
+        reinterpret_cast<std::uint8_t const*>(encoded.data()), encoded.size());
+    decoded->result.emplace(decode(octets, tags, limits));
+    decoded->done.store(true, std::memory_order_release);
+  });
+  return *decoded->result;
+}
+
+auto tag_decoders::Embedded::decode(CBORTag&& tagged) -> CBORValue {
+  return decode(std::move(tagged), DecodeLimits{});
+}
+
+auto tag_decoders::Embedded::decode(CBORTag&& tagged,
+                                    DecodeLimits const& limits) -> CBORValue {
+  if (not tagged.value().is_bstr()) return std::move(tagged);
+  EmbeddedCBOR embedded(tagged, limits);
+  return CBORCustom(std::move(tagged), std::move(embedded));
+}
+
+auto make_embedded(CBORValue const& value) -> CBORTag {
+  return CBORTag(CBOR_U64(tag_decoders::Embedded::tag),
+                 CBORBstr(encode(value)));
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_embedded() {
+  return "GLVI CBOR EMBEDDED";
+}
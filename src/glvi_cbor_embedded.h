@@ -0,0 +1,109 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_parser.h"
+#include "glvi_cbor_value.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+
+/**
+   Encoded CBOR data item embedded in a byte string (tag 24, see
+   RFC 8949 §3.4.5.1), decoded on first access.
+
+   `bytes()` returns the embedded item as it was received, so the
+   item can be forwarded without decoding it. Copies of a view share
+   the decoded value, which is computed at most once, also when
+   several threads access it.
+
+   Embedded items within the embedded item are again views, so each
+   level of nesting is decoded only when it is accessed. Decoding
+   enforces the `DecodeLimits` the view was made with; views made by
+   the parser get the limits of that parser.
+ */
+class EmbeddedCBOR {
+  /// Keeps `encoded` alive when it is the content of a tag
+  std::optional<CBORTag> owner;
+  std::span<std::byte const> encoded;
+  DecodeLimits limits;
+
+  struct Decoded {
+    std::once_flag once;
+    std::atomic<bool> done = false;
+    std::optional<std::expected<CBORValue, ParseError>> result;
+  };
+  std::shared_ptr<Decoded> decoded = std::make_shared<Decoded>();
+
+public:
+  /**
+     Borrows `encoded`, which must outlive the view and its copies.
+   */
+  explicit EmbeddedCBOR(std::span<std::byte const> encoded,
+                        DecodeLimits const& limits = {})
+      : encoded{encoded}, limits{limits} {}
+
+  /**
+     Shares the content of `tagged`, which must be a byte string.
+   */
+  explicit EmbeddedCBOR(CBORTag const& tagged,
+                        DecodeLimits const& limits = {});
+
+  /**
+     Returns the encoded item.
+   */
+  auto bytes() const noexcept -> std::span<std::byte const> {
+    return encoded;
+  }
+
+  /**
+     Returns whether the item has been decoded.
+   */
+  auto is_decoded() const noexcept -> bool;
+
+  /**
+     Returns the decoded item, decoding it on the first call.
+   */
+  auto value() const -> std::expected<CBORValue, ParseError> const&;
+};
+
+namespace tag_decoders {
+
+  /**
+     Tag 24: encoded CBOR data item, see RFC 8949 §3.4.5.1. Decodes a
+     byte string into an `EmbeddedCBOR` sharing its bytes; the
+     custom value still encodes as the original tag. The view
+     decodes with the `limits` of the parser, if given.
+   */
+  struct Embedded {
+    using type = EmbeddedCBOR;
+    static constexpr std::uint64_t tag = 24;
+    static auto decode(CBORTag&& tagged) -> CBORValue;
+    static auto decode(CBORTag&& tagged, DecodeLimits const& limits)
+        -> CBORValue;
+  };
+
+} // namespace tag_decoders
+
+/**
+   Returns tag 24 around the encoding of `value`.
+ */
+auto make_embedded(CBORValue const& value) -> CBORTag;
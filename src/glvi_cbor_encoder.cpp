@@ -0,0 +1,420 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+  using Result = std::expected<void, EncodeError>;
+
+  /**
+     Loads the first (up to) eight bytes of `p` as a big-endian
+     integer, padding with zeros. Comparing prefixes orders keys the
+     same way as comparing their first eight bytes with `memcmp`.
+   */
+  auto key_prefix(std::byte const* p, std::size_t n) noexcept
+      -> std::uint64_t {
+    std::uint64_t prefix = 0;
+    if (n >= sizeof prefix) {
+      std::memcpy(&prefix, p, sizeof prefix);
+      if constexpr (std::endian::native == std::endian::little)
+        prefix = std::byteswap(prefix);
+      return prefix;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+      prefix |= std::to_integer<std::uint64_t>(p[i]) << (56 - 8 * i);
+    return prefix;
+  }
+
+  /**
+     Bytewise comparison of two encoded keys, see RFC 8949 §4.2.1.
+   */
+  auto compare_keys(std::byte const* a, std::size_t a_size,
+                    std::byte const* b, std::size_t b_size) noexcept -> int {
+    if (auto c = std::memcmp(a, b, std::min(a_size, b_size)))
+      return c;
+    return a_size < b_size ? -1 : a_size > b_size ? 1 : 0;
+  }
+
+  /**
+     Computes encoded sizes, optionally recording the size of each
+     item in pre-order.
+   */
+  struct SizeCounter {
+    EncodeMode mode;
+    std::vector<std::size_t>* index = nullptr;
+
+    auto item(CBORValue const& value) -> std::size_t {
+      if (not index) return value.visit(*this);
+      auto const slot = index->size();
+      index->push_back(0);
+      auto const n = value.visit(*this);
+      (*index)[slot] = n;
+      return n;
+    }
+
+    auto operator()(CBORUint const& x) -> std::size_t {
+      return head_size(static_cast<std::uint64_t>(CBOR_U64(x)));
+    }
+
+    auto operator()(CBORNint const& x) -> std::size_t {
+      return head_size(static_cast<std::uint64_t>(CBOR_U64(x)));
+    }
+
+    auto operator()(CBORBstr const& x) -> std::size_t {
+      return head_size(x.size()) + x.size();
+    }
+
+    auto operator()(CBORTstr const& x) -> std::size_t {
+      return head_size(x.size()) + x.size();
+    }
+
+    auto operator()(CBORArray const& x) -> std::size_t {
+      auto n = head_size(x.size());
+      for (auto const& element : x)
+        n += item(element);
+      return n;
+    }
+
+    auto operator()(CBORMap const& x) -> std::size_t {
+      auto n = head_size(x.size());
+      for (CBORMap::size_type i = 0; i < x.size(); ++i) {
+        n += item(x.key(i));
+        n += item(x.value(i));
+      }
+      return n;
+    }
+
+    auto operator()(CBORTag const& x) -> std::size_t {
+      return head_size(static_cast<std::uint64_t>(x.tag())) + item(x.value());
+    }
+
+    auto operator()(CBORSimple const& x) -> std::size_t {
+      return head_size(static_cast<std::uint8_t>(x));
+    }
+
+    auto operator()(CBORFloat const& x) -> std::size_t {
+      return float_size(x, mode);
+    }
+
+    auto operator()(CBORCustom const& x) -> std::size_t {
+      return (*this)(x.as_tag());
+    }
+
+    auto operator()(CBORBignum const& x) -> std::size_t {
+      if (x.fits_u64()) return head_size(x.low_limb());
+      auto const n = x.byte_size();
+      return 1 + head_size(n) + n;
+    }
+  };
+
+  /**
+     Writes into a buffer that is known to be large enough, see
+     `encoded_size`.
+   */
+  struct Encoder {
+    std::byte* pos;
+    EncodeMode mode;
+
+    /// Encoded map entry awaiting sorting
+    struct Entry {
+      std::uint64_t prefix;
+      std::byte* key;
+      std::size_t key_size;
+      std::size_t size;
+    };
+
+    /// Entries of all maps currently being encoded, innermost last
+    std::vector<Entry> entries{};
+
+    /// Staging area for reordering map entries
+    std::vector<std::byte> scratch{};
+
+    void head(MajorType major, std::uint64_t arg) {
+      pos = write_head(pos, major, arg);
+    }
+
+    void bytes(void const* p, std::size_t n) {
+      if (n > 0) std::memcpy(pos, p, n);
+      pos += n;
+    }
+
+    auto operator()(CBORUint const& x) -> Result {
+      head(MajorType::Uint, static_cast<std::uint64_t>(CBOR_U64(x)));
+      return {};
+    }
+
+    auto operator()(CBORNint const& x) -> Result {
+      head(MajorType::Nint, static_cast<std::uint64_t>(CBOR_U64(x)));
+      return {};
+    }
+
+    auto operator()(CBORBstr const& x) -> Result {
+      head(MajorType::Bstr, x.size());
+      bytes(x.data(), x.size());
+      return {};
+    }
+
+    auto operator()(CBORTstr const& x) -> Result {
+      head(MajorType::Tstr, x.size());
+      bytes(x.data(), x.size());
+      return {};
+    }
+
+    auto operator()(CBORArray const& x) -> Result {
+      head(MajorType::Array, x.size());
+      for (auto const& element : x)
+        if (auto result = element.visit(*this); not result)
+          return result;
+      return {};
+    }
+
+    auto operator()(CBORMap const& x) -> Result {
+      head(MajorType::Map, x.size());
+      if (mode == EncodeMode::Deterministic and x.size() > 1)
+        return sorted_entries(x);
+      for (CBORMap::size_type i = 0; i < x.size(); ++i) {
+        if (auto result = x.key(i).visit(*this); not result)
+          return result;
+        if (auto result = x.value(i).visit(*this); not result)
+          return result;
+      }
+      return {};
+    }
+
+    auto operator()(CBORTag const& x) -> Result {
+      head(MajorType::Tag, static_cast<std::uint64_t>(x.tag()));
+      return x.value().visit(*this);
+    }
+
+    auto operator()(CBORSimple const& x) -> Result {
+      auto const number = static_cast<std::uint8_t>(x);
+      if (number >= 24 and number < 32)
+        return std::unexpected(encode_error::ReservedSimple{number});
+      head(MajorType::Simple, number);
+      return {};
+    }
+
+    auto operator()(CBORFloat const& x) -> Result {
+      pos = write_float(pos, x, mode);
+      return {};
+    }
+
+    auto operator()(CBORCustom const& x) -> Result {
+      return (*this)(x.as_tag());
+    }
+
+    auto operator()(CBORBignum const& x) -> Result {
+      if (x.fits_u64()) {
+        head(x.is_negative() ? MajorType::Nint : MajorType::Uint,
+             x.low_limb());
+        return {};
+      }
+      head(MajorType::Tag, x.is_negative() ? 3 : 2);
+      head(MajorType::Bstr, x.byte_size());
+      pos = x.write_bytes(pos);
+      return {};
+    }
+
+    /**
+       Encodes all entries of `map` in place, then reorders the
+       encoded entries by key. Nested maps push their entries on top
+       of ours, and pop them before we continue.
+     */
+    auto sorted_entries(CBORMap const& map) -> Result {
+      auto const base = pos;
+      auto const first = entries.size();
+      for (CBORMap::size_type i = 0; i < map.size(); ++i) {
+        auto const key = pos;
+        if (auto result = map.key(i).visit(*this); not result)
+          return result;
+        auto const key_size = static_cast<std::size_t>(pos - key);
+        if (auto result = map.value(i).visit(*this); not result)
+          return result;
+        entries.push_back(Entry{key_prefix(key, key_size), key, key_size,
+                                static_cast<std::size_t>(pos - key)});
+      }
+      auto const less = [](Entry const& a, Entry const& b) noexcept {
+        if (a.prefix != b.prefix) return a.prefix < b.prefix;
+        return compare_keys(a.key, a.key_size, b.key, b.key_size) < 0;
+      };
+      auto const begin = entries.begin() + first;
+      auto const end = entries.end();
+      auto const sorted = std::is_sorted(begin, end, less);
+      if (not sorted)
+        std::sort(begin, end, less);
+      auto const dup = std::adjacent_find(
+          begin, end, [&less](Entry const& a, Entry const& b) noexcept {
+            return not less(a, b);
+          });
+      if (dup != end) {
+        auto error =
+            encode_error::DuplicateKey{{dup->key, dup->key + dup->key_size}};
+        entries.resize(first);
+        return std::unexpected(std::move(error));
+      }
+      if (not sorted) {
+        scratch.assign(base, pos);
+        auto to = base;
+        for (auto it = begin; it != end; ++it)
+          to = std::copy_n(scratch.data() + (it->key - base), it->size, to);
+      }
+      entries.resize(first);
+      return {};
+    }
+  };
+
+  /**
+     Single-pass check for core deterministic encoding. Reads heads in
+     place, and compares each map key with its predecessor where both
+     reside in the input.
+   */
+  struct DeterministicCheck {
+    std::span<std::byte const> bytes;
+    std::size_t pos = 0;
+
+    auto item(unsigned depth) noexcept -> bool {
+      if (depth > deterministic_depth_max) return false;
+      auto const opt_head = read_head(bytes.subspan(pos));
+      if (not opt_head or opt_head->is_indefinite()) return false;
+      auto const head = *opt_head;
+      pos += head.size;
+      switch (head.major) {
+      case MajorType::Uint:
+      case MajorType::Nint: return head.is_shortest();
+      case MajorType::Bstr:
+      case MajorType::Tstr:
+        if (not head.is_shortest() or head.arg > bytes.size() - pos)
+          return false;
+        pos += head.arg;
+        return true;
+      case MajorType::Array:
+        if (not head.is_shortest()) return false;
+        for (std::uint64_t i = 0; i < head.arg; ++i)
+          if (not item(depth + 1)) return false;
+        return true;
+      case MajorType::Map: {
+        if (not head.is_shortest()) return false;
+        std::size_t prev = 0, prev_size = 0;
+        for (std::uint64_t i = 0; i < head.arg; ++i) {
+          auto const key = pos;
+          if (not item(depth + 1)) return false;
+          auto const key_size = pos - key;
+          if (i > 0 and compare_keys(bytes.data() + prev, prev_size,
+                                     bytes.data() + key, key_size) >= 0)
+            return false;
+          prev = key;
+          prev_size = key_size;
+          if (not item(depth + 1)) return false;
+        }
+        return true;
+      }
+      case MajorType::Tag:
+        return head.is_shortest() and item(depth + 1);
+      case MajorType::Simple: return simple_or_float(head);
+      }
+      return false;
+    }
+
+    static auto simple_or_float(ItemHead const& head) noexcept -> bool {
+      switch (head.info) {
+      case 24: return head.is_shortest();
+      case 25:
+        // the only NaN permitted is the canonical 0xf97e00
+        if ((head.arg & 0x7c00) == 0x7c00 and (head.arg & 0x03ff) != 0)
+          return head.arg == 0x7e00;
+        return true;
+      case 26: {
+        auto const value = from_single(static_cast<std::uint32_t>(head.arg));
+        if (value != value) return false;
+        return not to_half_exact(value);
+      }
+      case 27: {
+        auto const value = std::bit_cast<double>(head.arg);
+        if (value != value) return false;
+        return not to_single_exact(value);
+      }
+      default: return true;
+      }
+    }
+  };
+
+} // namespace
+
+auto encode(CBORValue const& value) -> std::vector<std::byte> {
+  std::vector<std::byte> out;
+  // Preferred serialisation only fails on reserved simple values,
+  // which leaves `out` empty
+  (void)encode(value, out, EncodeMode::Preferred);
+  return out;
+}
+
+auto encoded_size(CBORValue const& value, EncodeMode mode) noexcept
+    -> std::size_t {
+  return SizeCounter{mode}.item(value);
+}
+
+SizeIndex::SizeIndex(CBORValue const& value, EncodeMode mode) : mode_(mode) {
+  SizeCounter{mode, &sizes}.item(value);
+}
+
+auto encode(CBORValue const& value, std::vector<std::byte>& out,
+            EncodeMode mode) -> std::expected<void, EncodeError> {
+  auto const n = out.size();
+  out.resize(n + encoded_size(value, mode));
+  if (auto result = value.visit(Encoder{out.data() + n, mode}); not result) {
+    out.resize(n);
+    return result;
+  }
+  return {};
+}
+
+auto encode_to(CBORValue const& value, std::span<std::byte> out,
+               EncodeMode mode) -> std::expected<std::size_t, EncodeError> {
+  auto const required = encoded_size(value, mode);
+  if (out.size() < required)
+    return std::unexpected(encode_error::BufferTooSmall{required});
+  if (auto result = value.visit(Encoder{out.data(), mode}); not result)
+    return std::unexpected(std::move(result).error());
+  return required;
+}
+
+auto encode_to(CBORValue const& value, SizeIndex const& index,
+               std::span<std::byte> out)
+    -> std::expected<std::size_t, EncodeError> {
+  auto const required = index.size();
+  if (out.size() < required)
+    return std::unexpected(encode_error::BufferTooSmall{required});
+  if (auto result = value.visit(Encoder{out.data(), index.mode()}); not result)
+    return std::unexpected(std::move(result).error());
+  return required;
+}
+
+auto encode_deterministic(CBORValue const& value)
+    -> std::expected<std::vector<std::byte>, EncodeError> {
+  std::vector<std::byte> out;
+  if (auto result = encode(value, out, EncodeMode::Deterministic); not result)
+    return std::unexpected(std::move(result).error());
+  return out;
+}
+
+auto is_deterministic(std::span<std::byte const> bytes) noexcept -> bool {
+  DeterministicCheck check{bytes};
+  return check.item(0) and check.pos == bytes.size();
+}
@@ -0,0 +1,253 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_head.h"
+#include "glvi_cbor_value.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <variant>
+#include <vector>
+
+/**
+   Errors specific to encoding
+ */
+namespace encode_error {
+
+  /**
+     This error indicates that a map holds two keys whose encodings
+     are identical, which deterministic encoding does not permit.
+   */
+  struct DuplicateKey {
+    std::vector<std::byte> key;
+  };
+
+  /**
+     This error indicates that the output buffer cannot hold the
+     encoded value, which requires `required` bytes.
+   */
+  struct BufferTooSmall {
+    std::size_t required;
+  };
+
+  /**
+     This error indicates a simple value in the range 24..31, which
+     has no well-formed encoding, see RFC 8949 §3.3.
+   */
+  struct ReservedSimple {
+    std::uint8_t value;
+  };
+
+  /**
+     Errors that can occur during encoding
+   */
+  using EncodeError = std::variant<DuplicateKey, BufferTooSmall,
+                                   ReservedSimple>;
+
+} // namespace encode_error
+
+/// @copydoc encode_error::EncodeError
+using encode_error::EncodeError;
+
+/**
+   Selects the serialisation rules used by the encoder.
+ */
+enum class EncodeMode {
+  /**
+     Preferred serialisation, see RFC 8949 §4.1: shortest heads,
+     shortest floats that preserve the value (or their decoded width,
+     see `CBORFloat::width`), definite lengths, and map entries in
+     insertion order.
+   */
+  Preferred,
+
+  /**
+     Core deterministic encoding, see RFC 8949 §4.2.1: preferred
+     serialisation, plus map keys sorted bytewise by their encoded
+     form, NaN in its canonical half-precision form, and no
+     duplicate keys.
+   */
+  Deterministic,
+};
+
+/**
+   Returns the width in bytes of the encoding chosen for `x`: the
+   shortest width that preserves the value, including NaN payloads. In
+   preferred serialisation, a width recorded in `x` is kept if it
+   preserves the value. In deterministic mode, NaN takes its canonical
+   half-precision form.
+ */
+constexpr auto float_width(CBORFloat const& x, EncodeMode mode) noexcept
+    -> std::uint8_t {
+  if (mode == EncodeMode::Deterministic and x.value != x.value) return 2;
+  if (mode == EncodeMode::Preferred) {
+    if (x.width == 8 or (x.width == 4 and to_single_exact(x.value)) or
+        (x.width == 2 and to_half_exact(x.value)))
+      return x.width;
+  }
+  if (to_half_exact(x.value)) return 2;
+  if (to_single_exact(x.value)) return 4;
+  return 8;
+}
+
+/**
+   Returns the number of bytes `write_float` writes for `x`.
+ */
+constexpr auto float_size(CBORFloat const& x, EncodeMode mode) noexcept
+    -> std::size_t {
+  return 1 + float_width(x, mode);
+}
+
+/**
+   Writes `x` with the width chosen by `float_width` to `out` and
+   returns the iterator past the last byte written.
+
+   `out` must accept at least 9 bytes.
+ */
+template <typename OutputIt>
+constexpr auto write_float(OutputIt out, CBORFloat const& x, EncodeMode mode)
+    -> OutputIt {
+  auto const put = [&out](std::uint8_t initial, std::uint64_t arg, int n) {
+    *out++ = std::byte{initial};
+    for (auto shift = 8 * n; shift > 0; shift -= 8)
+      *out++ = std::byte(arg >> (shift - 8));
+  };
+  switch (float_width(x, mode)) {
+  case 8: put(0xfb, std::bit_cast<std::uint64_t>(x.value), 8); break;
+  case 4: put(0xfa, *to_single_exact(x.value), 4); break;
+  default:
+    if (mode == EncodeMode::Deterministic and x.value != x.value)
+      put(0xf9, 0x7e00, 2);
+    else
+      put(0xf9, *to_half_exact(x.value), 2);
+  }
+  return out;
+}
+
+/**
+   Returns the exact number of bytes that encoding `value` using
+   `mode` produces. Does not allocate.
+ */
+auto encoded_size(CBORValue const& value,
+                  EncodeMode mode = EncodeMode::Preferred) noexcept
+    -> std::size_t;
+
+/**
+   Encoded sizes of a value and all items nested in it, in pre-order:
+   the value itself is item 0, followed by the items of its first
+   child, and so on. Each map entry contributes its key, then its
+   value.
+
+   Building the index takes one pass over the value. Encoding with
+   the index skips that pass, which pays off when the same value is
+   encoded repeatedly, or when the lengths of nested items are needed
+   up front, e.g. to wrap them in a byte string.
+
+   The index is valid as long as the value it was built from is not
+   modified.
+ */
+class SizeIndex {
+  std::vector<std::size_t> sizes;
+  EncodeMode mode_;
+
+public:
+  explicit SizeIndex(CBORValue const& value,
+                     EncodeMode mode = EncodeMode::Preferred);
+
+  auto mode() const noexcept -> EncodeMode { return mode_; }
+
+  /**
+     Returns the encoded size of the value the index was built from.
+   */
+  auto size() const noexcept -> std::size_t { return sizes.front(); }
+
+  /**
+     Returns the number of items in the index.
+   */
+  auto items() const noexcept -> std::size_t { return sizes.size(); }
+
+  /**
+     Returns the encoded size of the item at pre-order position `i`.
+   */
+  auto operator[](std::size_t i) const noexcept -> std::size_t {
+    return sizes[i];
+  }
+};
+
+/**
+   Encodes `value` using preferred serialisation.
+
+   Returns no bytes if `value` holds a reserved simple value.
+ */
+auto encode(CBORValue const& value) -> std::vector<std::byte>;
+
+/**
+   Encodes `value` using `mode`, appending the encoded bytes to `out`.
+
+   The exact size is computed first, so `out` grows at most once and
+   the encoder writes without bounds checks. If encoding fails, `out`
+   is restored to its original size.
+ */
+auto encode(CBORValue const& value, std::vector<std::byte>& out,
+            EncodeMode mode) -> std::expected<void, EncodeError>;
+
+/**
+   Encodes `value` into the beginning of `out`, using `mode`, and
+   returns the number of bytes written.
+
+   Fails with `BufferTooSmall` before writing anything if `out` cannot
+   hold the encoding. If encoding fails otherwise, the contents of
+   `out` are unspecified.
+ */
+auto encode_to(CBORValue const& value, std::span<std::byte> out,
+               EncodeMode mode) -> std::expected<std::size_t, EncodeError>;
+
+/**
+   Encodes `value` into the beginning of `out`, like the overload
+   above, but takes the mode and size from `index`, which must have
+   been built from `value`.
+ */
+auto encode_to(CBORValue const& value, SizeIndex const& index,
+               std::span<std::byte> out)
+    -> std::expected<std::size_t, EncodeError>;
+
+/**
+   Encodes `value` using core deterministic encoding.
+
+   Each map key is encoded exactly once; entries are then ordered by
+   comparing the encoded keys, and duplicate keys are rejected.
+ */
+auto encode_deterministic(CBORValue const& value)
+    -> std::expected<std::vector<std::byte>, EncodeError>;
+
+/**
+   Checks whether `bytes` holds exactly one data item in core
+   deterministic encoding.
+
+   The check runs in a single pass over `bytes` and does not
+   allocate. Items nested deeper than `deterministic_depth_max` are
+   reported as not deterministic.
+ */
+auto is_deterministic(std::span<std::byte const> bytes) noexcept -> bool;
+
+/**
+   Nesting limit of `is_deterministic`, which walks nested items
+   recursively.
+ */
+constexpr unsigned deterministic_depth_max = 1024;
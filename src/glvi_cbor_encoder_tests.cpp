@@ -0,0 +1,522 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_constant.h"
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_gather.h"
+#include "glvi_cbor_packed.h"
+#include "glvi_cbor_parser.h"
+#include "glvi_cbor_prepared.h"
+#include "glvi_cbor_stringref.h"
+#include <cstdio>
+#include <dejagnu.h>
+#include <source_location>
+
+using namespace std::string_literals;
+
+using vec_byte = std::vector<std::byte>;
+
+template <typename... Octets> auto bytes(Octets... octets) -> vec_byte {
+  return vec_byte{std::byte(octets)...};
+}
+
+static auto decode_bytes(vec_byte const& encoded) {
+  std::vector<std::uint8_t> octets;
+  for (auto b : encoded) octets.push_back(std::to_integer<std::uint8_t>(b));
+  return decode(octets);
+}
+
+constexpr auto constant_ack = encode_constant([] {
+  CBORMap map;
+  map.insert(u8"type"_cbor_tstr, u8"ack"_cbor_tstr);
+  map.insert(u8"seq"_cbor_tstr, CBORUint(1000_cbor));
+  map.insert(CBORNint(0_cbor), CBORArray{});
+  map.insert(CBOR_True, CBORFloat{1.5});
+  return map;
+});
+
+static_assert(constant_ack.size() == 23);
+static_assert(is_well_formed(constant_ack));
+static_assert(not is_well_formed(std::span(constant_ack).first(22)));
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+class CBOREncoderTests : TestState, std::source_location {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+  /**
+     Array holding a byte string large enough to be gathered in place
+   */
+  static auto with_attachment() -> CBORValue {
+    CBORArray array;
+    array.push_back(CBORUint(1_cbor));
+    array.push_back(CBORBstr{vec_byte(4096, std::byte{0x55})});
+    array.push_back(u8"tail"_cbor_tstr);
+    return array;
+  }
+
+  static auto concat(GatheredEncoding const& encoding) -> vec_byte {
+    vec_byte result;
+    for (auto segment : encoding.segments())
+      result.insert(result.end(), segment.begin(), segment.end());
+    return result;
+  }
+
+  /**
+     Map with keys in the reverse of the order given in RFC 8949 §4.2.1
+   */
+  static auto reversed_map() -> CBORMap {
+    CBORMap map;
+    map.insert(u8"aa"_cbor_tstr, CBORUint(4_cbor));
+    map.insert(u8"z"_cbor_tstr, CBORUint(3_cbor));
+    map.insert(CBORNint(0_cbor), CBORUint(2_cbor));
+    map.insert(CBORUint(100_cbor), CBORUint(1_cbor));
+    map.insert(CBORUint(10_cbor), CBORUint(0_cbor));
+    return map;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(encode_uint) {
+    if (encode(CBORUint(23_cbor)) == bytes(0x17) and
+        encode(CBORUint(500_cbor)) == bytes(0x19, 0x01, 0xf4) and
+        encode(CBORNint(0x10000_cbor)) == bytes(0x3a, 0, 1, 0, 0)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_float_shortest) {
+    if (encode(CBORFloat{1.5}) == bytes(0xf9, 0x3e, 0x00) and
+        encode(CBORFloat{100000.0}) == bytes(0xfa, 0x47, 0xc3, 0x50, 0x00) and
+        encode(CBORFloat{1.1}) ==
+            bytes(0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_preferred_keeps_insertion_order) {
+    auto encoded = encode(reversed_map());
+    if (encoded.size() > 3 and encoded[0] == std::byte{0xa5} and
+        encoded[1] == std::byte{0x62} and not is_deterministic(encoded)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_deterministic_sorts_keys) {
+    auto expected = bytes(0xa5, 0x0a, 0x00, 0x18, 0x64, 0x01, 0x20, 0x02, 0x61,
+                          0x7a, 0x03, 0x62, 0x61, 0x61, 0x04);
+    auto encoded = encode_deterministic(reversed_map());
+    if (encoded and *encoded == expected and is_deterministic(*encoded)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_deterministic_sorts_nested_maps) {
+    CBORMap outer;
+    outer.insert(CBORUint(1_cbor), reversed_map());
+    outer.insert(CBORUint(0_cbor), CBOR_Null);
+    auto encoded = encode_deterministic(outer);
+    if (encoded and encoded->size() == 19 and
+        (*encoded)[1] == std::byte{0x00} and is_deterministic(*encoded)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_deterministic_rejects_duplicate_key) {
+    CBORMap map;
+    map.insert(u8"k"_cbor_tstr, CBORUint(0_cbor));
+    map.insert(CBORUint(1_cbor), CBORUint(1_cbor));
+    map.insert(u8"k"_cbor_tstr, CBORUint(2_cbor));
+    auto encoded = encode_deterministic(map);
+    if (not encoded) {
+      auto const& dup = std::get<encode_error::DuplicateKey>(encoded.error());
+      if (dup.key == bytes(0x61, 0x6b))
+        return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_rejects_reserved_simple) {
+    CBORArray array;
+    array.push_back(CBORUint(1_cbor));
+    array.push_back(CBORSimple(24));
+    vec_byte out = bytes(0xff);
+    auto encoded = encode(array, out, EncodeMode::Preferred);
+    if (not encoded and
+        std::get<encode_error::ReservedSimple>(encoded.error()).value == 24 and
+        out == bytes(0xff) and encode(CBORSimple(31)).empty() and
+        encode(CBORSimple(32)) == bytes(0xf8, 0x20) and
+        encode(CBORSimple(23)) == bytes(0xf7)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(is_deterministic_rejects) {
+    // non-shortest argument, indefinite length, non-shortest float,
+    // non-canonical NaN, unsorted keys, trailing input
+    if (not is_deterministic(bytes(0x18, 0x17)) and
+        not is_deterministic(bytes(0x5f, 0x41, 0x00, 0xff)) and
+        not is_deterministic(bytes(0xfa, 0x3f, 0xc0, 0x00, 0x00)) and
+        not is_deterministic(bytes(0xf9, 0x7e, 0x01)) and
+        not is_deterministic(bytes(0xa2, 0x01, 0x00, 0x00, 0x00)) and
+        not is_deterministic(bytes(0x00, 0x00)) and
+        is_deterministic(bytes(0xf9, 0x7e, 0x00))) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_gather_references_payload) {
+    auto value = with_attachment();
+    auto encoding = encode_gather(value);
+    if (concat(encoding) == encode(value) and encoding.size() == 4106 and
+        encoding.staged() == 10 and encoding.segments().size() == 3) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(write_gathered) {
+    auto value = with_attachment();
+    auto encoding = encode_gather(value);
+    auto file = std::tmpfile();
+    auto written = write_gathered(fileno(file), encoding);
+    vec_byte read_back(encoding.size() + 1);
+    std::rewind(file);
+    auto n = std::fread(read_back.data(), 1, read_back.size(), file);
+    std::fclose(file);
+    read_back.resize(n);
+    if (written and *written == encoding.size() and
+        read_back == encode(value)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encoded_size_is_exact) {
+    CBORMap map = reversed_map();
+    map.insert(CBORFloat{0.0 / 0.0}, with_attachment());
+    CBORValue value = std::move(map);
+    auto deterministic = encode_deterministic(value);
+    if (encoded_size(value) == encode(value).size() and deterministic and
+        encoded_size(value, EncodeMode::Deterministic) ==
+            deterministic->size()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(size_index_records_items) {
+    auto value = with_attachment();
+    SizeIndex index{value};
+    if (index.size() == 4106 and index.items() == 4 and index[1] == 1 and
+        index[2] == 4099 and index[3] == 5) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_to_checks_buffer_once) {
+    auto value = with_attachment();
+    SizeIndex index{value};
+    vec_byte buffer(index.size());
+    auto too_small = encode_to(value, std::span(buffer).first(100),
+                               EncodeMode::Preferred);
+    auto written = encode_to(value, index, buffer);
+    if (not too_small and
+        std::get<encode_error::BufferTooSmall>(too_small.error()).required ==
+            4106 and
+        written and *written == 4106 and buffer == encode(value)) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_constant_matches_encode) {
+    CBORMap map;
+    map.insert(u8"type"_cbor_tstr, u8"ack"_cbor_tstr);
+    map.insert(u8"seq"_cbor_tstr, CBORUint(1000_cbor));
+    map.insert(CBORNint(0_cbor), CBORArray{});
+    map.insert(CBOR_True, CBORFloat{1.5});
+    if (vec_byte(constant_ack.begin(), constant_ack.end()) == encode(map) and
+        is_well_formed(bytes(0x5f, 0x41, 0x00, 0xff)) and
+        not is_well_formed(bytes(0x5f, 0x61, 0x00, 0xff)) and
+        not is_well_formed(bytes(0xbf, 0x00, 0xff)) and
+        not is_well_formed(bytes(0xf8, 0x1f))) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(prepared_message_patches_slots) {
+    MessageTemplateBuilder builder;
+    builder.map(3);
+    builder.value(u8"seq"_cbor_tstr);
+    auto const seq = builder.uint_slot();
+    builder.value(u8"delta"_cbor_tstr);
+    auto const delta = builder.int_slot();
+    builder.value(u8"id"_cbor_tstr);
+    auto const id = builder.tstr_slot(2);
+    auto message = std::move(builder).build();
+    if (not message) return fail(current().function_name());
+    auto const patched = message->set_uint(seq, 0x0102) and
+                         message->set_int(delta, -1) and
+                         message->set_tstr(id, u8"ab");
+    auto const wrong_kind = message->set_float(seq, 1.0);
+    auto const wrong_length = message->set_tstr(id, u8"abc");
+    auto const no_such_slot = message->set_uint(id + 1, 0);
+    auto expected = bytes(0xa3, 0x63, 's', 'e', 'q', 0x1b, 0, 0, 0, 0, 0, 0,
+                          0x01, 0x02, 0x65, 'd', 'e', 'l', 't', 'a', 0x3b, 0,
+                          0, 0, 0, 0, 0, 0, 0, 0x62, 'i', 'd', 0x62, 'a', 'b');
+    auto const actual = message->bytes();
+    if (patched and not wrong_kind and not wrong_length and
+        std::get<prepared_error::WrongLength>(wrong_length.error())
+                .expected == 2 and
+        not no_such_slot and
+        std::holds_alternative<prepared_error::NoSuchSlot>(
+            no_such_slot.error()) and
+        vec_byte(actual.begin(), actual.end()) == expected) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(prepared_message_rejects_malformed) {
+    MessageTemplateBuilder builder;
+    builder.array(2);
+    builder.uint_slot();
+    if (not std::move(builder).build()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_stringref_round_trip) {
+    // ["aaa", "aaa", h'616161', "aa"]: only the second "aaa" is a
+    // reference, as byte strings have their own table, and "aa" is
+    // shorter than a reference
+    CBORArray small;
+    small.push_back(u8"aaa"_cbor_tstr);
+    small.push_back(u8"aaa"_cbor_tstr);
+    small.push_back(CBORBstr{bytes(0x61, 0x61, 0x61)});
+    small.push_back(u8"aa"_cbor_tstr);
+    auto const expected =
+        bytes(0xd9, 0x01, 0x00, 0x84, 0x63, 0x61, 0x61, 0x61, 0xd8, 0x19,
+              0x00, 0x43, 0x61, 0x61, 0x61, 0x62, 0x61, 0x61);
+    // records repeating their keys
+    CBORArray records;
+    for (unsigned i = 0; i < 50; ++i) {
+      CBORMap record;
+      record.insert(u8"identifier"_cbor_tstr, CBORUint(CBOR_U64(i)));
+      record.insert(u8"status"_cbor_tstr, u8"nominal"_cbor_tstr);
+      records.push_back(std::move(record));
+    }
+    auto const plain = encode(records);
+    auto const packed = encode_stringref(records);
+    auto const decoded = decode_bytes(packed);
+    if (encode_stringref(small) == expected and
+        encode(*decode_bytes(expected)) == encode(small) and
+        packed.size() < plain.size() / 2 and decoded and
+        encode(*decoded) == plain) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(encode_packed_round_trip) {
+    // 113([["packed"], ["https://example.com/"], [simple(0), 224("foo")]])
+    vec_byte example = bytes(0xd8, 0x71, 0x83, 0x81, 0x66, 'p', 'a', 'c', 'k',
+                             'e', 'd', 0x81, 0x74);
+    for (auto c : std::string_view("https://example.com/"))
+      example.push_back(static_cast<std::byte>(c));
+    for (auto b : bytes(0x82, 0xe0, 0xd8, 0xe0, 0x63, 'f', 'o', 'o'))
+      example.push_back(b);
+    CBORArray expected;
+    expected.push_back(u8"packed"_cbor_tstr);
+    expected.push_back(u8"https://example.com/foo"_cbor_tstr);
+    auto document = PackedDocument::from(*decode_bytes(example));
+    if (not document) return fail(current().function_name());
+    auto const root = document->root();
+    auto const first = root.at(0);
+    auto const unpacked = root.unpack();
+    // records repeating their keys and some of their values
+    std::vector<CBORValue> batch;
+    for (unsigned i = 0; i < 50; ++i) {
+      CBORMap record;
+      record.insert(u8"identifier"_cbor_tstr, CBORUint(CBOR_U64(i)));
+      record.insert(u8"status"_cbor_tstr,
+                    i % 7 ? u8"nominal"_cbor_tstr : u8"degraded"_cbor_tstr);
+      batch.push_back(std::move(record));
+    }
+    CBORArray records;
+    for (auto const& record : batch) records.push_back(CBORValue(record));
+    auto const packed = encode_packed(batch);
+    auto packed_document = PackedDocument::from(*decode_bytes(packed));
+    if (not packed_document) return fail(current().function_name());
+    auto const records_unpacked = packed_document->root().unpack();
+    // the string only occurs inside the shared item, and is not shared
+    std::string_view const repeated = "a fairly long repeated string";
+    CBORArray inner;
+    inner.push_back(u8"a fairly long repeated string"_cbor_tstr);
+    CBORArray outer;
+    outer.push_back(std::move(inner));
+    std::vector<CBORValue> nested(3, CBORValue(outer));
+    vec_byte nested_expected = bytes(0xd8, 0x71, 0x83, 0x81, 0x81, 0x81,
+                                     0x78, repeated.size());
+    for (auto c : repeated) nested_expected.push_back(std::byte(c));
+    for (auto b : bytes(0x80, 0x83, 0xe0, 0xe0, 0xe0))
+      nested_expected.push_back(b);
+    if (first and first->value().as_tstr() and
+        encode_packed(nested) == nested_expected and
+        unpacked and encode(*unpacked) == encode(expected) and
+        not PackedDocument::from(expected) and
+        records_unpacked and encode(*records_unpacked) == encode(records) and
+        packed.size() < encode(records).size() / 2) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+
+  TEST_CASE(unpack_packed_rejects_bad_documents) {
+    using packed_error::BadReference;
+    using packed_error::OverBudget;
+    // 113([["abc"], [], 6(0x7ffffffffffffff8)]): 16 + 2n wraps to 0
+    auto const wrapping =
+        bytes(0xd8, 0x71, 0x83, 0x81, 0x63, 'a', 'b', 'c', 0x80, 0xc6, 0x1b,
+              0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8);
+    // 113([["a", [simple(0), simple(0)], [simple(1), simple(1)], ...],
+    //      [], simple(15)]): item n + 1 holds item n twice, 2^15 "a"s
+    auto doubling = bytes(0xd8, 0x71, 0x83, 0x90, 0x61, 'a');
+    for (unsigned i = 0; i < 15; ++i)
+      for (auto b : bytes(0x82, 0xe0 + i, 0xe0 + i)) doubling.push_back(b);
+    for (auto b : bytes(0x80, 0xef)) doubling.push_back(b);
+    // 113([[], [224("a")], 224("b")]): argument 0 refers to itself
+    auto const cyclic = bytes(0xd8, 0x71, 0x83, 0x80, 0x81, 0xd8, 0xe0, 0x61,
+                              'a', 0xd8, 0xe0, 0x61, 'b');
+    auto const fails_with = [](vec_byte const& encoded, auto error,
+                               std::size_t bytes_max) {
+      auto const document = PackedDocument::from(*decode_bytes(encoded));
+      if (not document) return false;
+      auto const unpacked = document->root().unpack(bytes_max);
+      return not unpacked and
+             std::holds_alternative<decltype(error)>(unpacked.error());
+    };
+    auto const unbounded = PackedDocument::from(*decode_bytes(doubling));
+    if (not unbounded) return fail(current().function_name());
+    auto const unpacked = unbounded->root().unpack();
+    if (fails_with(wrapping, BadReference{}, 65536) and
+        fails_with(doubling, OverBudget{}, 65536) and
+        fails_with(cyclic, BadReference{}, 65536) and unpacked and
+        encode(*unpacked).size() > 65536) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+  catch (...) {
+    return fail(current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBOREncoderTests testSuite{};
+  testSuite.test_encode_uint();
+  testSuite.test_encode_float_shortest();
+  testSuite.test_encode_preferred_keeps_insertion_order();
+  testSuite.test_encode_deterministic_sorts_keys();
+  testSuite.test_encode_deterministic_sorts_nested_maps();
+  testSuite.test_encode_deterministic_rejects_duplicate_key();
+  testSuite.test_encode_rejects_reserved_simple();
+  testSuite.test_is_deterministic_rejects();
+  testSuite.test_encode_gather_references_payload();
+  testSuite.test_write_gathered();
+  testSuite.test_encoded_size_is_exact();
+  testSuite.test_size_index_records_items();
+  testSuite.test_encode_to_checks_buffer_once();
+  testSuite.test_encode_constant_matches_encode();
+  testSuite.test_prepared_message_patches_slots();
+  testSuite.test_prepared_message_rejects_malformed();
+  testSuite.test_encode_stringref_round_trip();
+  testSuite.test_encode_packed_round_trip();
+  testSuite.test_unpack_packed_rejects_bad_documents();
+  return testSuite.failure();
+}
@@ -14,7 +14,92 @@
 //
 //  You should have received a copy of the GNU General Public License
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "config.h"
 #include "glvi_cbor_float.h"
+#include <cstddef>
+
+#if HAVE_IMMINTRIN_H && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define GLVI_CBOR_HALF_F16C 1
+#include <immintrin.h>
+#elif HAVE_ARM_NEON_H && defined(__aarch64__)
+#define GLVI_CBOR_HALF_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+  void halves_to_doubles_scalar(std::uint16_t const* in, double* out,
+                                std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = from_half(in[i]);
+  }
+
+#if GLVI_CBOR_HALF_F16C
+
+  // Hardware conversion quietens signalling NaNs; blocks holding
+  // infinities or NaNs are converted in software instead.
+  __attribute__((target("avx,f16c"))) void
+  halves_to_doubles_f16c(std::uint16_t const* in, double* out,
+                         std::size_t n) noexcept {
+    auto const exp_mask = _mm_set1_epi16(0x7c00);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      auto const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+      auto const special =
+          _mm_cmpeq_epi16(_mm_and_si128(h, exp_mask), exp_mask);
+      if (_mm_movemask_epi8(special)) {
+        halves_to_doubles_scalar(in + i, out + i, 8);
+        continue;
+      }
+      auto const f = _mm256_cvtph_ps(h);
+      _mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm256_castps256_ps128(f)));
+      _mm256_storeu_pd(out + i + 4,
+                       _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)));
+    }
+    halves_to_doubles_scalar(in + i, out + i, n - i);
+  }
+
+  auto has_f16c() noexcept -> bool {
+    static bool const supported =
+        __builtin_cpu_supports("avx") and __builtin_cpu_supports("f16c");
+    return supported;
+  }
+
+#elif GLVI_CBOR_HALF_NEON
+
+  // See above: blocks holding infinities or NaNs go through software.
+  void halves_to_doubles_neon(std::uint16_t const* in, double* out,
+                              std::size_t n) noexcept {
+    auto const exp_mask = vdup_n_u16(0x7c00);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      auto const h = vld1_u16(in + i);
+      if (vmaxv_u16(vceq_u16(vand_u16(h, exp_mask), exp_mask))) {
+        halves_to_doubles_scalar(in + i, out + i, 4);
+        continue;
+      }
+      auto const f = vcvt_f32_f16(vreinterpret_f16_u16(h));
+      vst1q_f64(out + i, vcvt_f64_f32(vget_low_f32(f)));
+      vst1q_f64(out + i + 2, vcvt_high_f64_f32(f));
+    }
+    halves_to_doubles_scalar(in + i, out + i, n - i);
+  }
+
+#endif
+
+} // namespace
+
+void halves_to_doubles(std::span<std::uint16_t const> halves,
+                       std::span<double> out) noexcept {
+#if GLVI_CBOR_HALF_F16C
+  if (has_f16c())
+    return halves_to_doubles_f16c(halves.data(), out.data(), halves.size());
+#elif GLVI_CBOR_HALF_NEON
+  return halves_to_doubles_neon(halves.data(), out.data(), halves.size());
+#endif
+  halves_to_doubles_scalar(halves.data(), out.data(), halves.size());
+}
 
 char const * _glvi_cbor_float() {
   return "GLVI CBOR FLOAT";
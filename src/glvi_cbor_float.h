@@ -15,6 +15,10 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
 
 /**
    CBOR major type 7: Floating-point values.
@@ -23,4 +27,138 @@
  */
 struct CBORFloat {
   double value;
+
+  /**
+     Width in bytes of the encoding the value was decoded from -- 2,
+     4 or 8 -- or 0 if the value was not decoded. Preferred
+     serialisation keeps this width where it preserves the value, so
+     that decoded floats round-trip unchanged.
+   */
+  std::uint8_t width = 0;
 };
+
+namespace float_bits {
+
+  /**
+     Narrows the IEEE 754 binary64 `bits` to a format with `M`
+     mantissa bits and `E` exponent bits, if the value (or the NaN
+     payload) is preserved exactly.
+   */
+  template <int M, int E>
+  constexpr auto narrow(std::uint64_t bits) noexcept
+      -> std::optional<std::uint64_t> {
+    constexpr int bias = (1 << (E - 1)) - 1;
+    constexpr int drop = 52 - M;
+    constexpr std::uint64_t drop_mask = (std::uint64_t{1} << drop) - 1;
+    auto const sign = (bits >> 63) << (M + E);
+    auto const exp = static_cast<int>((bits >> 52) & 0x7ff);
+    auto const mant = bits & 0xfffffffffffff;
+    if (exp == 0x7ff) {
+      if (mant & drop_mask) return std::nullopt;
+      return sign | std::uint64_t((1 << E) - 1) << M | mant >> drop;
+    }
+    if (exp == 0) {
+      // binary64 subnormals are too small for any narrower format
+      if (mant != 0) return std::nullopt;
+      return sign;
+    }
+    auto const e = exp - 1023;
+    if (e > bias) return std::nullopt;
+    if (e >= 1 - bias) {
+      if (mant & drop_mask) return std::nullopt;
+      return sign | std::uint64_t(e + bias) << M | mant >> drop;
+    }
+    auto const shift = drop + (1 - bias - e);
+    if (shift > 52) return std::nullopt;
+    auto const full = (std::uint64_t{1} << 52) | mant;
+    if (full & ((std::uint64_t{1} << shift) - 1)) return std::nullopt;
+    return sign | full >> shift;
+  }
+
+  /**
+     Widens `bits` of a format with `M` mantissa bits and `E` exponent
+     bits to IEEE 754 binary64. Exact for all values, including
+     subnormals, infinities and NaN payloads.
+   */
+  template <int M, int E>
+  constexpr auto widen(std::uint64_t bits) noexcept -> std::uint64_t {
+    constexpr int bias = (1 << (E - 1)) - 1;
+    constexpr std::uint64_t emax = (std::uint64_t{1} << E) - 1;
+    constexpr std::uint64_t mmask = (std::uint64_t{1} << M) - 1;
+    auto const sign = (bits >> (M + E)) << 63;
+    auto const exp = (bits >> M) & emax;
+    auto mant = bits & mmask;
+    if (exp == emax) return sign | std::uint64_t{0x7ff} << 52 | mant << (52 - M);
+    if (exp != 0)
+      return sign | (exp - bias + 1023) << 52 | mant << (52 - M);
+    if (mant == 0) return sign;
+    auto e = 1 - bias;
+    while (not (mant & (std::uint64_t{1} << M))) {
+      mant <<= 1;
+      e -= 1;
+    }
+    return sign | std::uint64_t(e + 1023) << 52 | (mant & mmask) << (52 - M);
+  }
+
+} // namespace float_bits
+
+/**
+   Returns the IEEE 754 binary16 representation of `d`, if `d`
+   converts to half precision without loss.
+ */
+constexpr auto to_half_exact(double d) noexcept
+    -> std::optional<std::uint16_t> {
+  if (auto opt = float_bits::narrow<10, 5>(std::bit_cast<std::uint64_t>(d)))
+    return static_cast<std::uint16_t>(*opt);
+  return std::nullopt;
+}
+
+/**
+   Returns the IEEE 754 binary32 representation of `d`, if `d`
+   converts to single precision without loss.
+ */
+constexpr auto to_single_exact(double d) noexcept
+    -> std::optional<std::uint32_t> {
+  if (auto opt = float_bits::narrow<23, 8>(std::bit_cast<std::uint64_t>(d)))
+    return static_cast<std::uint32_t>(*opt);
+  return std::nullopt;
+}
+
+/**
+   Converts the IEEE 754 binary16 representation `h` to double.
+ */
+constexpr auto from_half(std::uint16_t h) noexcept -> double {
+  return std::bit_cast<double>(float_bits::widen<10, 5>(h));
+}
+
+/**
+   Converts the IEEE 754 binary32 representation `f` to double.
+ */
+constexpr auto from_single(std::uint32_t f) noexcept -> double {
+  return std::bit_cast<double>(float_bits::widen<23, 8>(f));
+}
+
+/**
+   Converts the IEEE 754 representation `bits` of width `width` (2, 4
+   or 8 bytes) to double.
+ */
+constexpr auto from_bits(std::uint64_t bits, std::uint8_t width) noexcept
+    -> double {
+  switch (width) {
+  case 2 : return from_half(static_cast<std::uint16_t>(bits));
+  case 4 : return from_single(static_cast<std::uint32_t>(bits));
+  default: return std::bit_cast<double>(bits);
+  }
+}
+
+/**
+   Converts the IEEE 754 binary16 representations in `halves` to
+   double, storing the results at the beginning of `out`, which must
+   hold at least as many elements as `halves`.
+
+   Uses F16C or NEON conversions where the processor supports them,
+   and `from_half` otherwise. Results are identical either way,
+   including NaN payloads.
+ */
+void halves_to_doubles(std::span<std::uint16_t const> halves,
+                       std::span<double> out) noexcept;
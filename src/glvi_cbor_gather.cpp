@@ -0,0 +1,201 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "config.h"
+#include "glvi_cbor_gather.h"
+#include "glvi_cbor_encoder.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#if HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
+/**
+   Encoder that appends heads and small items to the staging buffer,
+   and records large string payloads as external pieces.
+ */
+struct GatherEncoder {
+  GatheredEncoding& encoding;
+  std::size_t threshold;
+
+  void stage(void const* p, std::size_t n) {
+    auto const first = static_cast<std::byte const*>(p);
+    auto& pieces = encoding.pieces;
+    if (pieces.empty() or pieces.back().external)
+      pieces.push_back({nullptr, encoding.staging.size(), 0});
+    encoding.staging.insert(encoding.staging.end(), first, first + n);
+    pieces.back().size += n;
+    encoding.total += n;
+  }
+
+  void head(MajorType major, std::uint64_t arg) {
+    std::byte buffer[9];
+    auto const end = write_head(buffer, major, arg);
+    stage(buffer, end - buffer);
+  }
+
+  void payload(void const* p, std::size_t n) {
+    if (n < threshold)
+      return stage(p, n);
+    encoding.pieces.push_back({static_cast<std::byte const*>(p), 0, n});
+    encoding.total += n;
+  }
+
+  void operator()(CBORUint const& x) {
+    head(MajorType::Uint, static_cast<std::uint64_t>(CBOR_U64(x)));
+  }
+
+  void operator()(CBORNint const& x) {
+    head(MajorType::Nint, static_cast<std::uint64_t>(CBOR_U64(x)));
+  }
+
+  void operator()(CBORBstr const& x) {
+    head(MajorType::Bstr, x.size());
+    payload(x.data(), x.size());
+  }
+
+  void operator()(CBORTstr const& x) {
+    head(MajorType::Tstr, x.size());
+    payload(x.data(), x.size());
+  }
+
+  void operator()(CBORArray const& x) {
+    head(MajorType::Array, x.size());
+    for (auto const& element : x)
+      element.visit(*this);
+  }
+
+  void operator()(CBORMap const& x) {
+    head(MajorType::Map, x.size());
+    for (CBORMap::size_type i = 0; i < x.size(); ++i) {
+      x.key(i).visit(*this);
+      x.value(i).visit(*this);
+    }
+  }
+
+  void operator()(CBORTag const& x) {
+    head(MajorType::Tag, static_cast<std::uint64_t>(x.tag()));
+    x.value().visit(*this);
+  }
+
+  void operator()(CBORSimple const& x) {
+    head(MajorType::Simple, static_cast<std::uint8_t>(x));
+  }
+
+  void operator()(CBORFloat const& x) {
+    std::byte buffer[9];
+    auto const end = write_float(buffer, x, EncodeMode::Preferred);
+    stage(buffer, end - buffer);
+  }
+
+  void operator()(CBORCustom const& x) { (*this)(x.as_tag()); }
+
+  void operator()(CBORBignum const& x) {
+    if (x.fits_u64())
+      return head(x.is_negative() ? MajorType::Nint : MajorType::Uint,
+                  x.low_limb());
+    std::vector<std::byte> bytes(x.byte_size());
+    x.write_bytes(bytes.data());
+    head(MajorType::Tag, x.is_negative() ? 3 : 2);
+    head(MajorType::Bstr, bytes.size());
+    stage(bytes.data(), bytes.size());
+  }
+};
+
+auto GatheredEncoding::segments() const
+    -> std::vector<std::span<std::byte const>> {
+  std::vector<std::span<std::byte const>> result;
+  result.reserve(pieces.size());
+  for (auto const& piece : pieces) {
+    if (piece.size == 0)
+      continue;
+    auto const data = piece.external ? piece.external
+                                     : staging.data() + piece.offset;
+    result.emplace_back(data, piece.size);
+  }
+  return result;
+}
+
+auto encode_gather(CBORValue const& value, std::size_t threshold)
+    -> GatheredEncoding {
+  GatheredEncoding encoding;
+  value.visit(GatherEncoder{encoding, threshold});
+  return encoding;
+}
+
+namespace {
+  auto system_error() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::error_code(errno, std::system_category()));
+  }
+} // namespace
+
+#if HAVE_WRITEV
+
+auto write_gathered(int fd, GatheredEncoding const& encoding)
+    -> std::expected<std::size_t, std::error_code> {
+#ifdef IOV_MAX
+  constexpr std::size_t batch_max = IOV_MAX;
+#else
+  constexpr std::size_t batch_max = 16;
+#endif
+  std::vector<iovec> iov;
+  for (auto segment : encoding.segments())
+    iov.push_back({const_cast<std::byte*>(segment.data()), segment.size()});
+  std::size_t written = 0;
+  for (std::size_t i = 0; i < iov.size();) {
+    auto const count = std::min(iov.size() - i, batch_max);
+    auto n = ::writev(fd, iov.data() + i, static_cast<int>(count));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return system_error();
+    }
+    written += n;
+    for (auto rest = static_cast<std::size_t>(n); rest > 0;) {
+      if (rest >= iov[i].iov_len) {
+        rest -= iov[i].iov_len;
+        ++i;
+      } else {
+        iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + rest;
+        iov[i].iov_len -= rest;
+        rest = 0;
+      }
+    }
+  }
+  return written;
+}
+
+#else
+
+auto write_gathered(int fd, GatheredEncoding const& encoding)
+    -> std::expected<std::size_t, std::error_code> {
+  std::size_t written = 0;
+  for (auto segment : encoding.segments()) {
+    while (not segment.empty()) {
+      auto n = ::write(fd, segment.data(), segment.size());
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return system_error();
+      }
+      written += n;
+      segment = segment.subspan(n);
+    }
+  }
+  return written;
+}
+
+#endif
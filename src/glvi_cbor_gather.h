@@ -0,0 +1,89 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_value.h"
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <system_error>
+#include <vector>
+
+/**
+   Byte and text strings of at least this many bytes are referenced in
+   place by `encode_gather`, unless specified otherwise.
+ */
+constexpr std::size_t gather_threshold_default = 1024;
+
+/**
+   Encoded CBOR value in the form of a list of segments, suitable for
+   scatter-gather output.
+
+   Heads and small items are copied into a staging buffer owned by the
+   encoding. Payloads of large byte strings and text strings are
+   referenced in place: the encoded value must not outlive the
+   `CBORValue` it was made from, and that value must not be modified
+   while the encoding is in use.
+ */
+class GatheredEncoding {
+  /// Run of bytes, either in the staging buffer, or referenced in place
+  struct Piece {
+    std::byte const* external;
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  std::vector<std::byte> staging;
+  std::vector<Piece> pieces;
+  std::size_t total = 0;
+
+  friend struct GatherEncoder;
+
+public:
+  /**
+     Returns the total number of encoded bytes.
+   */
+  auto size() const noexcept -> std::size_t { return total; }
+
+  /**
+     Returns the number of bytes copied into the staging buffer.
+   */
+  auto staged() const noexcept -> std::size_t { return staging.size(); }
+
+  /**
+     Returns the segments that make up the encoding, in order.
+   */
+  auto segments() const -> std::vector<std::span<std::byte const>>;
+};
+
+/**
+   Encodes `value` using preferred serialisation, referencing payloads
+   of byte strings and text strings of at least `threshold` bytes in
+   place.
+ */
+auto encode_gather(CBORValue const& value,
+                   std::size_t threshold = gather_threshold_default)
+    -> GatheredEncoding;
+
+/**
+   Writes all segments of `encoding` to the file descriptor `fd` with
+   `writev(2)`, resuming after partial writes and interruptions.
+
+   Returns the number of bytes written, or the error reported by the
+   system.
+ */
+auto write_gathered(int fd, GatheredEncoding const& encoding)
+    -> std::expected<std::size_t, std::error_code>;
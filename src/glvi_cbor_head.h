@@ -0,0 +1,129 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/**
+   CBOR major types, see RFC 8949 §3.1
+ */
+enum class MajorType : std::uint8_t {
+  Uint   = 0,
+  Nint   = 1,
+  Bstr   = 2,
+  Tstr   = 3,
+  Array  = 4,
+  Map    = 5,
+  Tag    = 6,
+  Simple = 7,
+};
+
+/**
+   Additional information signalling an indefinite length, or the
+   "break" stop code in major type 7.
+ */
+constexpr std::uint8_t CBOR_INDEFINITE = 31;
+
+/**
+   Returns the number of bytes needed for the shortest head carrying
+   argument `arg`.
+ */
+constexpr auto head_size(std::uint64_t arg) noexcept -> std::size_t {
+  if (arg < 24) return 1;
+  if (arg <= 0xff) return 2;
+  if (arg <= 0xffff) return 3;
+  if (arg <= 0xffffffff) return 5;
+  return 9;
+}
+
+/**
+   Writes the shortest head for major type `major` and argument `arg`
+   to `out`, and returns the iterator past the last byte written.
+
+   `out` must accept at least `head_size(arg)` bytes.
+ */
+template <typename OutputIt>
+constexpr auto write_head(OutputIt out, MajorType major, std::uint64_t arg)
+    -> OutputIt {
+  auto const mt = static_cast<std::uint64_t>(major) << 5;
+  auto const width = head_size(arg) - 1;
+  switch (width) {
+  case 0 : *out++ = std::byte(mt | arg); return out;
+  case 1 : *out++ = std::byte(mt | 24); break;
+  case 2 : *out++ = std::byte(mt | 25); break;
+  case 4 : *out++ = std::byte(mt | 26); break;
+  default: *out++ = std::byte(mt | 27); break;
+  }
+  for (auto shift = 8 * width; shift > 0; shift -= 8)
+    *out++ = std::byte(arg >> (shift - 8));
+  return out;
+}
+
+/**
+   Decoded head of a data item
+ */
+struct ItemHead {
+  /// major type, high-order 3 bits of the initial byte
+  MajorType major;
+  /// additional information, low-order 5 bits of the initial byte
+  std::uint8_t info;
+  /// argument; 0 for indefinite lengths and the break stop code
+  std::uint64_t arg;
+  /// number of bytes the head occupies
+  std::size_t size;
+
+  constexpr auto is_indefinite() const noexcept -> bool {
+    return info == CBOR_INDEFINITE;
+  }
+
+  /**
+     Whether the argument uses the shortest possible encoding, see
+     RFC 8949 §4.2.1. Not meaningful for floats (major type 7,
+     additional information 25..27).
+   */
+  constexpr auto is_shortest() const noexcept -> bool {
+    if (info == CBOR_INDEFINITE) return true;
+    if (major == MajorType::Simple and info == 24) return arg >= 32;
+    return size == head_size(arg);
+  }
+};
+
+/**
+   Reads the head at the start of `bytes`.
+
+   Returns an empty optional if `bytes` is too short to hold the head,
+   or if the initial byte uses one of the reserved additional
+   information values 28..30.
+ */
+constexpr auto read_head(std::span<std::byte const> bytes) noexcept
+    -> std::optional<ItemHead> {
+  if (bytes.empty()) return std::nullopt;
+  auto const initial = std::to_integer<std::uint8_t>(bytes[0]);
+  auto const major = static_cast<MajorType>(initial >> 5);
+  auto const info = static_cast<std::uint8_t>(initial & 0x1f);
+  if (info < 24) return ItemHead{major, info, info, 1};
+  if (info == CBOR_INDEFINITE) return ItemHead{major, info, 0, 1};
+  if (info > 27) return std::nullopt;
+  auto const width = std::size_t{1} << (info - 24);
+  if (bytes.size() < 1 + width) return std::nullopt;
+  std::uint64_t arg = 0;
+  for (std::size_t i = 1; i <= width; ++i)
+    arg = (arg << 8) | std::to_integer<std::uint64_t>(bytes[i]);
+  return ItemHead{major, info, arg, 1 + width};
+}
@@ -0,0 +1,306 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_index.h"
+#include "glvi_cbor_constant.h"
+#include "glvi_cbor_head.h"
+#include "glvi_cbor_mapped.h"
+#include "glvi_cbor_typed_array.h"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <fcntl.h>
+#include <string_view>
+#include <unistd.h>
+
+namespace {
+  auto system_error() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::error_code(errno, std::system_category()));
+  }
+
+  auto not_an_index() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+  }
+
+  constexpr std::u8string_view magic = u8"GLVI CBOR INDEX 1";
+
+  /// bytes buffered by `save` before they are written
+  constexpr std::size_t save_buffer_size = 1 << 20;
+
+  /**
+     Walks a document, recording the containers at the chosen depths
+   */
+  struct Builder {
+    std::span<std::byte const> bytes;
+    std::vector<bool> chosen;
+    IndexPath path;
+    std::vector<IndexedContainer> containers;
+
+    /// Walks the item at `pos`, at `depth`, and advances `pos` past it.
+    auto walk(std::size_t& pos, std::size_t depth) -> bool {
+      // nothing below is indexed
+      if (depth >= chosen.size())
+        return constant_encoding::well_formed(bytes, pos, 0);
+      auto head = read_head(bytes.subspan(pos));
+      while (head and head->major == MajorType::Tag) {
+        pos += head->size;
+        head = read_head(bytes.subspan(pos));
+      }
+      if (not head or (head->major != MajorType::Array and
+                       head->major != MajorType::Map))
+        return constant_encoding::well_formed(bytes, pos, 0);
+      auto const map = head->major == MajorType::Map;
+      auto const slot = containers.size();
+      if (chosen[depth]) {
+        containers.push_back({path, pos, map, {}});
+        if (not head->is_indefinite())
+          containers.back().elements.reserve(
+              std::min<std::uint64_t>(head->arg, bytes.size() - pos));
+      }
+      pos += head->size;
+      auto const more = [&](std::uint64_t i) {
+        if (head->is_indefinite())
+          return pos < bytes.size() and bytes[pos] != std::byte{0xff};
+        return i < head->arg;
+      };
+      for (std::uint64_t i = 0; more(i); ++i) {
+        if (chosen[depth]) containers[slot].elements.push_back(pos);
+        if (map and not constant_encoding::well_formed(bytes, pos, 0))
+          return false;
+        path.push_back(i);
+        auto const ok = walk(pos, depth + 1);
+        path.pop_back();
+        if (not ok) return false;
+      }
+      if (head->is_indefinite()) {
+        if (pos == bytes.size()) return false;
+        pos += 1;
+      }
+      return true;
+    }
+  };
+
+  /**
+     Reader of a saved index
+   */
+  struct Cursor {
+    std::span<std::byte const> bytes;
+    std::size_t pos = 0;
+
+    auto head(MajorType major) -> std::optional<ItemHead> {
+      auto const head = read_head(bytes.subspan(pos));
+      if (not head or head->major != major or head->is_indefinite())
+        return std::nullopt;
+      pos += head->size;
+      return head;
+    }
+
+    auto uint() -> std::optional<std::uint64_t> {
+      if (auto const head = this->head(MajorType::Uint)) return head->arg;
+      return std::nullopt;
+    }
+
+    auto array() -> std::optional<std::uint64_t> {
+      if (auto const head = this->head(MajorType::Array)) return head->arg;
+      return std::nullopt;
+    }
+
+    auto boolean() -> std::optional<bool> {
+      auto const head = this->head(MajorType::Simple);
+      if (not head or (head->arg != 20 and head->arg != 21))
+        return std::nullopt;
+      return head->arg == 21;
+    }
+
+    auto string() -> std::optional<std::span<std::byte const>> {
+      auto const head = this->head(MajorType::Tstr);
+      if (not head or head->arg > bytes.size() - pos) return std::nullopt;
+      pos += head->arg;
+      return bytes.subspan(pos - head->arg, head->arg);
+    }
+
+    auto offsets() -> std::optional<std::vector<std::uint64_t>> {
+      auto const tag = head(MajorType::Tag);
+      auto const bstr = tag ? head(MajorType::Bstr) : std::nullopt;
+      if (not bstr or bstr->arg > bytes.size() - pos) return std::nullopt;
+      auto const elements = typed_array_as<std::uint64_t>(
+          tag->arg, bytes.subspan(pos, bstr->arg));
+      if (not elements) return std::nullopt;
+      pos += bstr->arg;
+      return std::vector(elements->span().begin(), elements->span().end());
+    }
+  };
+
+  auto decode_item(std::span<std::byte const> item, DecodeLimits const& limits)
+      -> std::expected<CBORValue, ParseError> {
+    Parser parser(limits);
+    auto result = parser.consume(item);
+    if (result.is_complete()) return std::move(result.as_complete().value);
+    if (result.is_error())
+      return std::unexpected(std::move(result.as_error()));
+    return std::unexpected(parse_error::Incomplete{});
+  }
+} // namespace
+
+auto OffsetIndex::build(std::span<std::byte const> document,
+                        IndexOptions const& options)
+    -> std::optional<OffsetIndex> {
+  Builder builder{document, {}, {}, {}};
+  for (auto const depth : options.depths) {
+    if (depth >= builder.chosen.size()) builder.chosen.resize(depth + 1);
+    builder.chosen[depth] = true;
+  }
+  std::size_t pos = 0;
+  if (document.empty() or not builder.walk(pos, 0) or
+      pos != document.size())
+    return std::nullopt;
+  OffsetIndex index;
+  index.documentSize = document.size();
+  index.containerList = std::move(builder.containers);
+  return index;
+}
+
+auto OffsetIndex::load(char const* path)
+    -> std::expected<OffsetIndex, std::error_code> {
+  auto const file = MappedDocument::open(path, MapAdvice::Sequential);
+  if (not file) return std::unexpected(file.error());
+  Cursor in{file->bytes()};
+  auto const text = in.array() == 3 ? in.string() : std::nullopt;
+  if (not text or
+      not std::ranges::equal(*text, std::as_bytes(std::span(magic))))
+    return not_an_index();
+  auto const size = in.uint();
+  auto const count = size ? in.array() : std::nullopt;
+  if (not count) return not_an_index();
+  OffsetIndex index;
+  index.documentSize = *size;
+  for (std::uint64_t i = 0; i < *count; ++i) {
+    auto const depth = in.array() == 4 ? in.array() : std::nullopt;
+    if (not depth) return not_an_index();
+    IndexedContainer container;
+    for (std::uint64_t level = 0; level < *depth; ++level) {
+      auto const step = in.uint();
+      if (not step) return not_an_index();
+      container.path.push_back(*step);
+    }
+    auto const offset = in.uint();
+    auto const map = offset ? in.boolean() : std::nullopt;
+    auto elements = map ? in.offsets() : std::nullopt;
+    if (not elements) return not_an_index();
+    container.offset = *offset;
+    container.map = *map;
+    container.elements = *std::move(elements);
+    index.containerList.push_back(std::move(container));
+  }
+  if (in.pos != file->bytes().size() or
+      not std::ranges::is_sorted(index.containerList, {},
+                                 &IndexedContainer::path))
+    return not_an_index();
+  return index;
+}
+
+auto OffsetIndex::save(char const* path) const
+    -> std::expected<void, std::error_code> {
+  auto const fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) return system_error();
+  std::vector<std::byte> buffer;
+  auto const flush = [&]() -> bool {
+    for (std::size_t done = 0; done < buffer.size();) {
+      auto const n = ::write(fd, buffer.data() + done, buffer.size() - done);
+      if (n < 0 and errno != EINTR) return false;
+      if (n > 0) done += static_cast<std::size_t>(n);
+    }
+    buffer.clear();
+    return true;
+  };
+  auto const head = [&](MajorType major, std::uint64_t arg) {
+    std::byte bytes[9];
+    buffer.insert(buffer.end(), bytes, write_head(bytes, major, arg));
+  };
+  head(MajorType::Array, 3);
+  head(MajorType::Tstr, magic.size());
+  auto const text = std::as_bytes(std::span(magic));
+  buffer.insert(buffer.end(), text.begin(), text.end());
+  head(MajorType::Uint, documentSize);
+  head(MajorType::Array, containerList.size());
+  auto ok = true;
+  for (auto const& container : containerList) {
+    head(MajorType::Array, 4);
+    head(MajorType::Array, container.path.size());
+    for (auto const step : container.path) head(MajorType::Uint, step);
+    head(MajorType::Uint, container.offset);
+    head(MajorType::Simple, container.map ? 21 : 20);
+    append_typed_array(buffer, std::span(container.elements),
+                       std::endian::little);
+    if (buffer.size() >= save_buffer_size and not (ok = flush())) break;
+  }
+  if (ok) ok = flush() and ::fsync(fd) == 0;
+  auto result = ok ? std::expected<void, std::error_code>{} : system_error();
+  if (::close(fd) != 0 and result) result = system_error();
+  return result;
+}
+
+auto OffsetIndex::find(IndexPath const& path) const
+    -> IndexedContainer const* {
+  auto const it = std::ranges::lower_bound(containerList, path, {},
+                                           &IndexedContainer::path);
+  if (it == containerList.end() or it->path != path) return nullptr;
+  return &*it;
+}
+
+auto OffsetIndex::item_at(std::span<std::byte const> document,
+                          IndexPath const& path, std::uint64_t i,
+                          bool key) const
+    -> std::optional<std::span<std::byte const>> {
+  auto const container = find(path);
+  if (not container or i >= container->elements.size() or
+      (key and not container->map))
+    return std::nullopt;
+  auto start = container->elements[i];
+  if (start >= document.size()) return std::nullopt;
+  auto pos = static_cast<std::size_t>(start);
+  if (not constant_encoding::well_formed(document, pos, 0))
+    return std::nullopt;
+  if (container->map and not key) {
+    start = pos;
+    if (not constant_encoding::well_formed(document, pos, 0))
+      return std::nullopt;
+  }
+  return document.subspan(start, pos - start);
+}
+
+auto OffsetIndex::element_at(std::span<std::byte const> document,
+                             IndexPath const& path, std::uint64_t i,
+                             DecodeLimits const& limits) const
+    -> std::expected<CBORValue, ParseError> {
+  auto const item = item_at(document, path, i, false);
+  if (not item) return std::unexpected(parse_error::Incomplete{});
+  return decode_item(*item, limits);
+}
+
+auto OffsetIndex::key_at(std::span<std::byte const> document,
+                         IndexPath const& path, std::uint64_t i,
+                         DecodeLimits const& limits) const
+    -> std::expected<CBORValue, ParseError> {
+  auto const item = item_at(document, path, i, true);
+  if (not item) return std::unexpected(parse_error::Incomplete{});
+  return decode_item(*item, limits);
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_index() {
+  return "GLVI CBOR INDEX";
+}
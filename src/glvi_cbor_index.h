@@ -0,0 +1,139 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+/**
+   Position of a container in a document: the number of the element
+   at each level, from the root; for maps, the number of the entry,
+   whose value is the next level. Tags do not add a level.
+ */
+using IndexPath = std::vector<std::uint64_t>;
+
+/**
+   Options of `OffsetIndex::build`
+ */
+struct IndexOptions {
+  /// depths of the arrays and maps to index; the root is at depth 0
+  std::vector<std::size_t> depths = {0};
+};
+
+/**
+   Array or map in an `OffsetIndex`
+ */
+struct IndexedContainer {
+  IndexPath path;
+  /// offset of the head of the container, after any tags
+  std::uint64_t offset;
+  bool map;
+  /// offsets of the elements, or of the keys of a map
+  std::vector<std::uint64_t> elements;
+};
+
+/**
+   Sidecar index of a large document, e.g. an array of millions of
+   records: the offsets of the elements of the arrays and maps at
+   chosen depths, so that a single element can be decoded without
+   decoding what comes before it.
+
+   Building the index walks the document once, skipping everything
+   below the deepest chosen depth with the allocation-free skipper.
+   The index can be saved next to the document and loaded again.
+
+       auto document = MappedDocument::open(path, MapAdvice::Random);
+       auto index = OffsetIndex::build(document->bytes());
+       for (auto i = page * 50; i < (page + 1) * 50; ++i)
+         ... index->element_at(document->bytes(), {}, i) ...
+ */
+class OffsetIndex {
+  std::uint64_t documentSize = 0;
+  /// by path, in document order
+  std::vector<IndexedContainer> containerList;
+
+  auto item_at(std::span<std::byte const> document, IndexPath const& path,
+               std::uint64_t i, bool key) const
+      -> std::optional<std::span<std::byte const>>;
+
+public:
+  /**
+     Indexes `document`, which must hold exactly one well-formed data
+     item. Returns `std::nullopt` otherwise.
+   */
+  static auto build(std::span<std::byte const> document,
+                    IndexOptions const& options = {})
+      -> std::optional<OffsetIndex>;
+
+  /**
+     Loads an index saved with `save` from the file at `path`.
+     Returns the error reported by the system, or
+     `std::errc::invalid_argument` if the file is not an index.
+   */
+  static auto load(char const* path)
+      -> std::expected<OffsetIndex, std::error_code>;
+
+  /**
+     Saves the index to the file at `path`, as CBOR with the offsets
+     in typed arrays (RFC 8746).
+   */
+  auto save(char const* path) const -> std::expected<void, std::error_code>;
+
+  /**
+     Returns the size of the document indexed; a document of another
+     size is not the one indexed.
+   */
+  auto document_size() const noexcept -> std::uint64_t {
+    return documentSize;
+  }
+
+  /**
+     Returns the containers indexed, in document order.
+   */
+  auto containers() const noexcept -> std::span<IndexedContainer const> {
+    return containerList;
+  }
+
+  /**
+     Returns the container at `path`, if indexed.
+   */
+  auto find(IndexPath const& path) const -> IndexedContainer const*;
+
+  /**
+     Decodes element `i` of the container at `path` in `document`,
+     the value of entry `i` of a map, rejecting values beyond
+     `limits`. Only the element is decoded. Returns
+     `parse_error::Incomplete` if the container is not indexed or has
+     no such element.
+   */
+  auto element_at(std::span<std::byte const> document, IndexPath const& path,
+                  std::uint64_t i, DecodeLimits const& limits = {}) const
+      -> std::expected<CBORValue, ParseError>;
+
+  /**
+     Decodes the key of entry `i` of the map at `path` in `document`,
+     as `element_at`.
+   */
+  auto key_at(std::span<std::byte const> document, IndexPath const& path,
+              std::uint64_t i, DecodeLimits const& limits = {}) const
+      -> std::expected<CBORValue, ParseError>;
+};
@@ -0,0 +1,136 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_index.h"
+#include <dejagnu.h>
+#include <source_location>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+  /// Name of a temporary file, removed on destruction
+  struct TempPath {
+    char path[32] = "/tmp/glvi_cbor_indexXXXXXX";
+    TempPath() { ::close(::mkstemp(path)); }
+    ~TempPath() { ::unlink(path); }
+  };
+
+  auto bytes_of(std::initializer_list<int> list) -> std::vector<std::byte> {
+    std::vector<std::byte> bytes;
+    for (auto const byte : list) bytes.push_back(std::byte(byte));
+    return bytes;
+  }
+
+  /// Whether `value` encodes as `expected`
+  auto encodes_as(std::expected<CBORValue, ParseError> const& value,
+                  std::vector<std::byte> const& expected) -> bool {
+    return value and encode(*value) == expected;
+  }
+} // namespace
+
+class CBORIndexTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(index_chosen_depths)
+  {
+    // [{"a": [1, 2]}, 1([10, 20, 30]), "x"]
+    auto const document = bytes_of({0x83, 0xa1, 0x61, 0x61, 0x82, 0x01, 0x02,
+                                    0xc1, 0x83, 0x0a, 0x14, 0x18, 0x1e, 0x61,
+                                    0x78});
+    auto const index = OffsetIndex::build(document, {.depths = {0, 1}});
+    // the array in the map is at depth 2
+    auto const indexed =
+        index and index->containers().size() == 3 and
+        index->containers()[0].elements ==
+            std::vector<std::uint64_t>{1, 7, 13} and
+        index->containers()[1].map and index->containers()[2].offset == 8 and
+        index->find({0, 0}) == nullptr;
+    auto const decoded =
+        encodes_as(index->element_at(document, {1}, 2),
+                   bytes_of({0x18, 0x1e})) and
+        encodes_as(index->element_at(document, {}, 2),
+                   bytes_of({0x61, 0x78})) and
+        encodes_as(index->key_at(document, {0}, 0), bytes_of({0x61, 0x61})) and
+        encodes_as(index->element_at(document, {0}, 0),
+                   bytes_of({0x82, 0x01, 0x02})) and
+        not index->element_at(document, {1}, 3) and
+        not index->key_at(document, {1}, 0) and
+        not index->element_at(document, {0, 0}, 0);
+    if (indexed and decoded and
+        not OffsetIndex::build(std::span(document).first(10)) and
+        not OffsetIndex::build(bytes_of({0x01, 0x02}))) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(save_and_load)
+  {
+    // indefinite-length array of 1000 records [i, "payload"]
+    std::vector<std::byte> document{std::byte{0x9f}};
+    std::vector<std::vector<std::byte>> records;
+    for (unsigned i = 0; i < 1000; ++i) {
+      CBORArray record;
+      record.push_back(CBORUint(CBOR_U64(i)));
+      record.push_back(u8"payload"_cbor_tstr);
+      records.push_back(encode(record));
+      document.insert(document.end(), records[i].begin(), records[i].end());
+    }
+    document.push_back(std::byte{0xff});
+    auto const index = OffsetIndex::build(document);
+    TempPath file;
+    auto const saved = index and index->save(file.path);
+    auto const loaded = OffsetIndex::load(file.path);
+    auto const same = loaded and loaded->document_size() == document.size() and
+                      loaded->containers().size() == 1 and
+                      loaded->containers()[0].elements ==
+                          index->containers()[0].elements;
+    // a page of 50 records
+    auto page = true;
+    for (unsigned i = 500; i < 550; ++i)
+      page = page and encodes_as(loaded->element_at(document, {}, i),
+                                 records[i]);
+    auto const missing = OffsetIndex::load("/nonexistent/index.cbor");
+    if (saved and same and page and not missing and
+        missing.error() == std::errc::no_such_file_or_directory) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORIndexTests testSuite{};
+  testSuite.test_index_chosen_depths();
+  testSuite.test_save_and_load();
+  return testSuite.failure();
+}
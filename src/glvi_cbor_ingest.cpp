@@ -0,0 +1,544 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_ingest.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <sys/stat.h>
+#if HAVE_LINUX_IO_URING_H
+#include <csignal>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#if HAVE_LINUX_IO_URING_H && defined(__NR_io_uring_setup)
+#define GLVI_CBOR_IO_URING 1
+#endif
+
+namespace {
+  auto errno_code() -> std::error_code {
+    return std::error_code(errno, std::system_category());
+  }
+
+  /**
+     Reads each file with blocking reads, on `options.threads` threads
+     taking the files in turn.
+   */
+  void ingest_threads(std::span<std::string const> paths,
+                      ChunkSink const& sink, IngestOptions const& options) {
+    std::atomic<std::size_t> next = 0;
+    auto const worker = [&] {
+      std::vector<std::byte> buffer(options.chunk_size);
+      for (std::size_t file; (file = next++) < paths.size();) {
+        auto const fd = ::open(paths[file].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+          sink({file, {}, true, errno_code()});
+          continue;
+        }
+        FdSource source(fd);
+        for (;;) {
+          auto const n = source.read(buffer);
+          if (not n) {
+            sink({file, {}, true, n.error()});
+            break;
+          }
+          sink({file, std::span(buffer).first(*n), *n == 0, {}});
+          if (*n == 0) break;
+        }
+        ::close(fd);
+      }
+    };
+    auto threads = options.threads;
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, paths.size());
+    std::vector<std::jthread> pool;
+    for (std::size_t i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+  }
+
+#if GLVI_CBOR_IO_URING
+
+  /**
+     Submission and completion queues of an io_uring instance, set up
+     with the system calls directly, so there is no dependency on
+     liburing.
+   */
+  class Ring {
+    int fd = -1;
+    io_uring_params params{};
+    void* sq_ring = MAP_FAILED;
+    std::size_t sq_ring_size = 0;
+    void* cq_ring = MAP_FAILED;
+    std::size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    unsigned queued = 0;
+    /// Failure to submit a full queue from `read`
+    std::error_code failed;
+
+    template <typename T> auto at(void* ring, unsigned offset) -> T* {
+      return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+    }
+    static auto load(unsigned* p) -> unsigned {
+      return std::atomic_ref(*p).load(std::memory_order_acquire);
+    }
+    static void store(unsigned* p, unsigned v) {
+      std::atomic_ref(*p).store(v, std::memory_order_release);
+    }
+
+  public:
+    Ring() = default;
+    Ring(Ring const&) = delete;
+    Ring& operator=(Ring const&) = delete;
+
+    ~Ring() {
+      if (sqes != MAP_FAILED)
+        ::munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+      if (cq_ring != MAP_FAILED and cq_ring != sq_ring)
+        ::munmap(cq_ring, cq_ring_size);
+      if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_size);
+      if (fd >= 0) ::close(fd);
+    }
+
+    /**
+       Sets up a ring of at least `entries` submission entries, and
+       room for `in_flight` completions. Kernels without
+       `IORING_OP_READ` (before Linux 5.6) count as not supported.
+     */
+    auto setup(unsigned entries, unsigned in_flight)
+        -> std::expected<void, std::error_code> {
+      params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+      params.cq_entries = std::max(in_flight, 2 * entries);
+      fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+      if (fd < 0) return std::unexpected(errno_code());
+      if (not (params.features & IORING_FEAT_RW_CUR_POS))
+        return std::unexpected(std::make_error_code(std::errc::not_supported));
+      sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cq_ring_size =
+          params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      auto const single = params.features & IORING_FEAT_SINGLE_MMAP;
+      if (single)
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+      sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+      if (sq_ring == MAP_FAILED) return std::unexpected(errno_code());
+      cq_ring = single ? sq_ring
+                       : ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, fd,
+                                IORING_OFF_CQ_RING);
+      if (cq_ring == MAP_FAILED) return std::unexpected(errno_code());
+      auto* const mapped =
+          ::mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe),
+                 PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                 IORING_OFF_SQES);
+      if (mapped == MAP_FAILED) return std::unexpected(errno_code());
+      sqes = static_cast<io_uring_sqe*>(mapped);
+      return {};
+    }
+
+    /**
+       Returns the number of completions the ring has room for.
+     */
+    auto completions() const noexcept -> std::size_t {
+      return params.cq_entries;
+    }
+
+    /**
+       Submits the queued reads, without waiting.
+     */
+    auto submit() -> std::expected<void, std::error_code> {
+      for (;;) {
+        auto const n =
+            ::syscall(__NR_io_uring_enter, fd, queued, 0, 0, nullptr, 0);
+        if (n >= 0) {
+          queued -= static_cast<unsigned>(n);
+          return {};
+        }
+        if (errno != EINTR) return std::unexpected(errno_code());
+      }
+    }
+
+    /**
+       Queues a read of `length` bytes at `offset` of `file` into
+       `buffer`, tagged with `tag`, submitting the queue first if it
+       is full. The caller keeps no more reads in flight than the
+       ring has room for completions.
+     */
+    void read(int file, std::byte* buffer, std::size_t length,
+              std::uint64_t offset, std::uint64_t tag) {
+      auto* const tail = at<unsigned>(sq_ring, params.sq_off.tail);
+      auto const mask = *at<unsigned>(sq_ring, params.sq_off.ring_mask);
+      auto* const head = at<unsigned>(sq_ring, params.sq_off.head);
+      if (*tail - load(head) == params.sq_entries) {
+        if (auto submitted = submit(); not submitted) {
+          failed = submitted.error();
+          return;
+        }
+        if (*tail - load(head) == params.sq_entries) {
+          failed = std::make_error_code(std::errc::device_or_resource_busy);
+          return;
+        }
+      }
+      auto const t = *tail;
+      auto const index = t & mask;
+      auto& sqe = sqes[index];
+      sqe = io_uring_sqe{};
+      sqe.opcode = IORING_OP_READ;
+      sqe.fd = file;
+      sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+      sqe.len = static_cast<unsigned>(length);
+      sqe.off = offset;
+      sqe.user_data = tag;
+      at<unsigned>(sq_ring, params.sq_off.array)[index] = index;
+      store(tail, t + 1);
+      ++queued;
+    }
+
+    /**
+       Submits the queued reads, and waits for at least one completion.
+     */
+    auto submit_and_wait() -> std::expected<void, std::error_code> {
+      if (failed) return std::unexpected(failed);
+      for (;;) {
+        auto const n = ::syscall(__NR_io_uring_enter, fd, queued, 1,
+                                 IORING_ENTER_GETEVENTS, nullptr, _NSIG / 8);
+        if (n >= 0) {
+          queued -= static_cast<unsigned>(n);
+          return {};
+        }
+        if (errno != EINTR) return std::unexpected(errno_code());
+      }
+    }
+
+    /**
+       Calls `f(tag, result)` for each completion.
+     */
+    template <typename F> void complete(F&& f) {
+      auto* const head = at<unsigned>(cq_ring, params.cq_off.head);
+      auto const tail = load(at<unsigned>(cq_ring, params.cq_off.tail));
+      auto const mask = *at<unsigned>(cq_ring, params.cq_off.ring_mask);
+      auto* const cqes = at<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+      auto h = *head;
+      for (; h != tail; ++h) {
+        auto const& cqe = cqes[h & mask];
+        f(cqe.user_data, cqe.res);
+      }
+      store(head, h);
+    }
+  };
+
+  /**
+     Reads files through an io_uring: each of `options.files_in_flight`
+     lanes reads one file at a time, with `options.reads_in_flight`
+     slots of `options.chunk_size` bytes. A slot is handed out when
+     the slots before it are, so chunks stay in file order.
+   */
+  class UringIngest {
+    struct Slot {
+      std::vector<std::byte> buffer;
+      std::uint64_t offset = 0;
+      std::size_t length = 0;
+      std::size_t filled = 0;
+      bool done = false;
+      int error = 0;
+    };
+    struct Lane {
+      std::size_t file = 0;
+      int fd = -1;
+      std::uint64_t size = 0;
+      std::uint64_t submitted = 0;
+      std::size_t deliver = 0;
+      std::size_t in_flight = 0;
+      bool ended = true;
+      std::vector<Slot> slots;
+    };
+
+    std::span<std::string const> paths;
+    ChunkSink const& sink;
+    IngestOptions const& options;
+    std::size_t next_file = 0;
+    std::vector<Lane> lanes;
+    /// Closed before the buffers in `lanes` are freed
+    Ring ring;
+
+    auto tag(std::size_t lane, std::size_t slot) const -> std::uint64_t {
+      return lane * lanes[0].slots.size() + slot;
+    }
+
+    void issue(std::size_t l, std::size_t s) {
+      auto& lane = lanes[l];
+      auto& slot = lane.slots[s];
+      ring.read(lane.fd, slot.buffer.data() + slot.filled,
+                slot.length - slot.filled, slot.offset + slot.filled,
+                tag(l, s));
+      ++lane.in_flight;
+    }
+
+    void submit(std::size_t l, std::size_t s) {
+      auto& lane = lanes[l];
+      auto& slot = lane.slots[s];
+      slot.offset = lane.submitted;
+      slot.length = static_cast<std::size_t>(
+          std::min<std::uint64_t>(slot.buffer.size(), lane.size - slot.offset));
+      slot.filled = 0;
+      slot.done = false;
+      slot.error = 0;
+      lane.submitted += slot.length;
+      issue(l, s);
+    }
+
+    /**
+       Starts reading the next file that is not empty in lane `l`.
+     */
+    void start(std::size_t l) {
+      auto& lane = lanes[l];
+      while (next_file < paths.size()) {
+        auto const file = next_file++;
+        auto const fd = ::open(paths[file].c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 or ::fstat(fd, &st) != 0) {
+          sink({file, {}, true, errno_code()});
+          if (fd >= 0) ::close(fd);
+          continue;
+        }
+        if (st.st_size == 0) {
+          ::close(fd);
+          sink({file, {}, true, {}});
+          continue;
+        }
+        for (auto& slot : lane.slots) slot.done = false;
+        lane.file = file;
+        lane.fd = fd;
+        lane.size = static_cast<std::uint64_t>(st.st_size);
+        lane.submitted = 0;
+        lane.deliver = 0;
+        lane.ended = false;
+        for (std::size_t s = 0;
+             s < lane.slots.size() and lane.submitted < lane.size; ++s)
+          submit(l, s);
+        return;
+      }
+    }
+
+    /**
+       Hands out the completed slots of lane `l` in order, and reuses
+       them for the rest of the file.
+     */
+    void deliver(std::size_t l) {
+      auto& lane = lanes[l];
+      while (not lane.ended) {
+        auto const s = lane.deliver;
+        auto& slot = lane.slots[s];
+        if (not slot.done) break;
+        if (slot.error != 0) {
+          lane.ended = true;
+          sink({lane.file, {}, true,
+                std::error_code(slot.error, std::system_category())});
+          break;
+        }
+        // a file that shrank ends early
+        auto const last = slot.offset + slot.length >= lane.size or
+                          slot.filled < slot.length;
+        slot.done = false;
+        sink({lane.file, std::span(slot.buffer).first(slot.filled), last, {}});
+        if (last) {
+          lane.ended = true;
+          break;
+        }
+        lane.deliver = (s + 1) % lane.slots.size();
+        if (lane.submitted < lane.size) submit(l, s);
+      }
+    }
+
+    void complete(std::uint64_t tag, int result) {
+      auto const l = tag / lanes[0].slots.size();
+      auto const s = tag % lanes[0].slots.size();
+      auto& lane = lanes[l];
+      auto& slot = lane.slots[s];
+      --lane.in_flight;
+      if (lane.ended) {
+        // reads of an ended file may still be in flight
+      } else if (result == -EINTR or result == -EAGAIN) {
+        issue(l, s);
+        return;
+      } else if (result < 0) {
+        slot.error = -result;
+        slot.done = true;
+      } else if (result == 0) {
+        slot.done = true;
+      } else {
+        slot.filled += static_cast<std::size_t>(result);
+        if (slot.filled < slot.length)
+          issue(l, s);
+        else
+          slot.done = true;
+      }
+      deliver(l);
+      if (lane.ended and lane.in_flight == 0 and lane.fd >= 0) {
+        ::close(lane.fd);
+        lane.fd = -1;
+        start(l);
+      }
+    }
+
+  public:
+    UringIngest(std::span<std::string const> paths, ChunkSink const& sink,
+                IngestOptions const& options)
+        : paths{paths}, sink{sink}, options{options} {}
+
+    ~UringIngest() {
+      for (auto& lane : lanes)
+        if (lane.fd >= 0) ::close(lane.fd);
+    }
+
+    auto setup() -> std::expected<void, std::error_code> {
+      // reads beyond the submission queue are submitted as it fills,
+      // but each read in flight needs room for its completion
+      std::size_t const limit = 1u << 30;
+      auto const files = std::max<std::size_t>(
+          std::min(options.files_in_flight, paths.size()), 1);
+      auto const in_flight = options.reads_in_flight > limit / files
+                                 ? limit
+                                 : files * options.reads_in_flight;
+      auto const entries = std::min<std::size_t>(in_flight, 4096);
+      if (auto ready = ring.setup(static_cast<unsigned>(entries),
+                                  static_cast<unsigned>(in_flight));
+          not ready)
+        return ready;
+      if (ring.completions() < in_flight)
+        return std::unexpected(
+            std::make_error_code(std::errc::invalid_argument));
+      return {};
+    }
+
+    auto run() -> std::expected<void, std::error_code> {
+      lanes.resize(std::min(options.files_in_flight, paths.size()));
+      if (lanes.empty()) return {};
+      for (auto& lane : lanes) {
+        lane.slots.resize(options.reads_in_flight);
+        for (auto& slot : lane.slots) slot.buffer.resize(options.chunk_size);
+      }
+      for (std::size_t l = 0; l < lanes.size(); ++l) start(l);
+      auto const busy = [&] {
+        return std::ranges::any_of(
+            lanes, [](Lane const& lane) { return lane.in_flight > 0; });
+      };
+      while (busy()) {
+        if (auto waited = ring.submit_and_wait(); not waited)
+          return waited;
+        ring.complete([&](std::uint64_t tag, int result) {
+          complete(tag, result);
+        });
+      }
+      return {};
+    }
+  };
+
+#endif
+
+  auto check(IngestOptions const& options)
+      -> std::expected<void, std::error_code> {
+    if (options.chunk_size == 0 or options.reads_in_flight == 0 or
+        options.files_in_flight == 0 or options.chunk_size > 1u << 30)
+      return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    return {};
+  }
+} // namespace
+
+auto ingest_files(std::span<std::string const> paths, ChunkSink const& sink,
+                  IngestOptions const& options)
+    -> std::expected<IngestBackend, std::error_code> {
+  if (auto checked = check(options); not checked)
+    return std::unexpected(checked.error());
+  if (options.backend != IngestBackend::Threads) {
+#if GLVI_CBOR_IO_URING
+    UringIngest ingest(paths, sink, options);
+    if (auto ready = ingest.setup()) {
+      if (auto done = ingest.run(); not done)
+        return std::unexpected(done.error());
+      return IngestBackend::IoUring;
+    } else if (options.backend == IngestBackend::IoUring) {
+      return std::unexpected(ready.error());
+    }
+#else
+    if (options.backend == IngestBackend::IoUring)
+      return std::unexpected(std::make_error_code(std::errc::not_supported));
+#endif
+  }
+  ingest_threads(paths, sink, options);
+  return IngestBackend::Threads;
+}
+
+auto decode_files(std::span<std::string const> paths, ItemSink const& sink,
+                  IngestOptions const& options, DecodeLimits const& limits)
+    -> std::expected<IngestBackend, std::error_code> {
+  struct FileDecoder {
+    Parser parser;
+    bool within_item = false;
+    bool done = false;
+  };
+  std::vector<std::unique_ptr<FileDecoder>> decoders(paths.size());
+  return ingest_files(
+      paths,
+      [&](IngestChunk const& chunk) {
+        auto& decoder = decoders[chunk.file];
+        if (not decoder)
+          decoder = std::make_unique<FileDecoder>(Parser{limits});
+        if (decoder->done) {
+          if (chunk.last) decoder.reset();
+          return;
+        }
+        if (chunk.error) {
+          decoder->done = true;
+          sink(chunk.file, std::unexpected(input_error::Read{chunk.error}));
+          return;
+        }
+        for (auto bytes = chunk.bytes; not bytes.empty();) {
+          auto result = decoder->parser.consume(bytes);
+          if (result.is_incomplete()) {
+            decoder->within_item = true;
+          } else if (result.is_complete()) {
+            decoder->within_item = false;
+            sink(chunk.file, std::move(result.as_complete().value));
+          } else {
+            decoder->done = true;
+            sink(chunk.file,
+                 std::unexpected(input_error::Decode{result.as_error()}));
+            return;
+          }
+        }
+        if (chunk.last) {
+          if (decoder->within_item)
+            sink(chunk.file, std::unexpected(input_error::Decode{
+                                 parse_error::Incomplete{}}));
+          decoder.reset();
+        }
+      },
+      options);
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_ingest() {
+  return "GLVI CBOR INGEST";
+}
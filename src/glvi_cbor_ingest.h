@@ -0,0 +1,96 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_input.h"
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <span>
+#include <string>
+#include <system_error>
+
+/**
+   How `ingest_files` reads files
+ */
+enum class IngestBackend {
+  /// io_uring where the kernel supports it, threads otherwise
+  Auto,
+  /// Linux io_uring: all reads in flight from one thread
+  IoUring,
+  /// blocking reads on a pool of threads
+  Threads,
+};
+
+/**
+   Options of `ingest_files`
+ */
+struct IngestOptions {
+  /// bytes per read
+  std::size_t chunk_size = input_buffer_size_default;
+  /// reads in flight per file (io_uring)
+  std::size_t reads_in_flight = 4;
+  /// files open at a time (io_uring)
+  std::size_t files_in_flight = 8;
+  /// reader threads, or 0 for one per hardware thread (threads)
+  std::size_t threads = 0;
+  IngestBackend backend = IngestBackend::Auto;
+};
+
+/**
+   Bytes of a file, handed out in file order. The last chunk of a
+   file has `last` set; it may be empty. A failure to open or read the
+   file is reported in `error`, and ends the file.
+ */
+struct IngestChunk {
+  /// index of the file in the list of paths
+  std::size_t file;
+  /// bytes read, valid during the call only
+  std::span<std::byte const> bytes;
+  bool last;
+  std::error_code error;
+};
+
+/// Receives the chunks of the files being ingested
+using ChunkSink = std::function<void(IngestChunk const&)>;
+
+/// Receives the items decoded from file `file`
+using ItemSink = std::function<void(std::size_t file, InputItem&& item)>;
+
+/**
+   Reads the files at `paths`, several at a time and with several
+   large reads in flight per file, and hands their chunks to `sink` as
+   they complete, in order per file.
+
+   The sink may be called concurrently for different files, but not
+   for the same file. Returns the backend used, or the error that
+   prevented setting it up; `std::errc::not_supported` when
+   `IngestBackend::IoUring` is not available.
+ */
+auto ingest_files(std::span<std::string const> paths, ChunkSink const& sink,
+                  IngestOptions const& options = {})
+    -> std::expected<IngestBackend, std::error_code>;
+
+/**
+   Decodes the files at `paths` as CBOR sequences (RFC 8742), read as
+   with `ingest_files`, rejecting items beyond `limits`. The items of
+   each file reach `sink` in order, under the same conditions as the
+   chunks with `ingest_files`; an error ends the items of its file.
+ */
+auto decode_files(std::span<std::string const> paths, ItemSink const& sink,
+                  IngestOptions const& options = {},
+                  DecodeLimits const& limits = {})
+    -> std::expected<IngestBackend, std::error_code>;
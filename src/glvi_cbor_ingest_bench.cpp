@@ -0,0 +1,119 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_ingest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+   Compares decoding many CBOR sequence files with synchronous reads,
+   one file after the other, with `decode_files` on a pool of threads
+   and on io_uring. Build with `make glvi_cbor_ingest_bench`.
+
+   The files are written first, so they are read from the page cache;
+   drop the caches in between (`echo 3 > /proc/sys/vm/drop_caches`)
+   to measure reads from the device.
+ */
+
+using namespace std::chrono;
+
+namespace {
+
+  constexpr std::size_t file_count = 64;
+  constexpr std::size_t items_per_file = 40'000;
+
+  auto write_files(std::string const& dir) -> std::vector<std::string> {
+    std::vector<std::byte> sequence;
+    for (std::size_t i = 0; i < items_per_file; ++i) {
+      CBORArray item;
+      item.push_back(CBORUint(CBOR_U64(i)));
+      item.push_back(u8"a text string that is a bit longer"_cbor_tstr);
+      auto const bytes = encode(item);
+      sequence.insert(sequence.end(), bytes.begin(), bytes.end());
+    }
+    std::vector<std::string> paths;
+    for (std::size_t f = 0; f < file_count; ++f) {
+      paths.push_back(dir + "/" + std::to_string(f) + ".cbor");
+      auto* file = std::fopen(paths.back().c_str(), "wb");
+      std::fwrite(sequence.data(), 1, sequence.size(), file);
+      std::fclose(file);
+    }
+    return paths;
+  }
+
+  template <typename F>
+  auto measure(char const* name, std::size_t size, F&& f) -> double {
+    auto const start = steady_clock::now();
+    auto const items = f();
+    auto const elapsed = duration<double>(steady_clock::now() - start);
+    auto const rate = size / elapsed.count() / (1 << 20);
+    std::printf("%-20s %8.1f MiB/s  (%zu items)\n", name, rate, items);
+    return rate;
+  }
+
+} // namespace
+
+int main() {
+  char dir[] = "/tmp/glvi_cbor_ingest_benchXXXXXX";
+  if (not ::mkdtemp(dir)) return EXIT_FAILURE;
+  auto const paths = write_files(dir);
+  std::size_t size = 0;
+  for (auto const& path : paths) {
+    auto const fd = ::open(path.c_str(), O_RDONLY);
+    size += ::lseek(fd, 0, SEEK_END);
+    ::close(fd);
+  }
+
+  auto const sync = measure("synchronous", size, [&] {
+    std::size_t items = 0;
+    for (auto const& path : paths) {
+      auto const fd = ::open(path.c_str(), O_RDONLY);
+      FdSource source(fd);
+      SequenceReader reader(source);
+      while (auto item = reader.next())
+        items += item->has_value();
+      ::close(fd);
+    }
+    return items;
+  });
+  auto const run = [&](IngestBackend backend) {
+    IngestOptions options;
+    options.backend = backend;
+    std::atomic<std::size_t> items = 0;
+    auto const used = decode_files(paths, [&](std::size_t, InputItem&& item) {
+      items += item.has_value();
+    }, options);
+    return used ? items.load() : 0;
+  };
+  auto const threads = measure("threads", size, [&] {
+    return run(IngestBackend::Threads);
+  });
+  auto const uring = measure("io_uring", size, [&] {
+    return run(IngestBackend::IoUring);
+  });
+  std::printf("speed-up %.1fx (threads), %.1fx (io_uring)\n", threads / sync,
+              uring / sync);
+  for (auto const& path : paths) ::unlink(path.c_str());
+  ::rmdir(dir);
+  return 0;
+}
@@ -0,0 +1,182 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_ingest.h"
+#include <cstdio>
+#include <dejagnu.h>
+#include <source_location>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+  /// Encoding of item `i` of a sequence: [i, "payload"]
+  auto make_item(unsigned i) {
+    CBORArray item;
+    item.push_back(CBORUint(CBOR_U64(i)));
+    item.push_back(u8"payload"_cbor_tstr);
+    return encode(item);
+  }
+
+  /// Temporary file holding `count` items made by `make_item`, less
+  /// `cut` bytes at the end; removed on destruction
+  struct SequenceFile {
+    std::string path = "/tmp/glvi_cbor_ingestXXXXXX";
+    SequenceFile(unsigned count, std::size_t cut = 0) {
+      std::vector<std::byte> sequence;
+      for (unsigned i = 0; i < count; ++i) {
+        auto const bytes = make_item(i);
+        sequence.insert(sequence.end(), bytes.begin(), bytes.end());
+      }
+      sequence.resize(sequence.size() - cut);
+      auto const fd = ::mkstemp(path.data());
+      (void)::write(fd, sequence.data(), sequence.size());
+      ::close(fd);
+    }
+    ~SequenceFile() { ::unlink(path.c_str()); }
+  };
+
+  /// Checks that `items` are the first `count` items of a sequence
+  auto in_order(std::vector<InputItem> const& items, unsigned count) {
+    if (items.size() < count) return false;
+    for (unsigned i = 0; i < count; ++i)
+      if (not items[i] or encode(*items[i]) != make_item(i)) return false;
+    return true;
+  }
+} // namespace
+
+class CBORIngestTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(decode_files_in_order)
+  {
+    SequenceFile large(500), small(3), empty(0), cut(10, 1);
+    std::vector<std::string> const paths{large.path, small.path, empty.path,
+                                         "/nonexistent/file.cbor", cut.path};
+    // small chunks, so that items span chunks, with reads and files
+    // waiting for one another
+    IngestOptions options;
+    options.chunk_size = 64;
+    options.reads_in_flight = 3;
+    options.files_in_flight = 2;
+    options.threads = 3;
+    for (auto backend : {IngestBackend::Threads, IngestBackend::IoUring,
+                         IngestBackend::Auto}) {
+      options.backend = backend;
+      std::vector<std::vector<InputItem>> items(paths.size());
+      auto const used = decode_files(
+          paths,
+          [&](std::size_t file, InputItem&& item) {
+            items[file].push_back(std::move(item));
+          },
+          options);
+      if (not used and backend == IngestBackend::IoUring and
+          used.error() == std::errc::not_supported) {
+        note("io_uring not supported");
+        continue;
+      }
+      auto const read_error = [](std::vector<InputItem> const& items) {
+        return items.size() == 1 and not items[0] and
+               std::holds_alternative<input_error::Read>(items[0].error());
+      };
+      auto const incomplete = [](InputItem const& item) {
+        return not item and
+               std::holds_alternative<input_error::Decode>(item.error()) and
+               std::get<input_error::Decode>(item.error())
+                   .error.is_incomplete();
+      };
+      if (not used or
+          (backend != IngestBackend::Auto and *used != backend) or
+          not in_order(items[0], 500) or items[0].size() != 500 or
+          not in_order(items[1], 3) or items[1].size() != 3 or
+          not items[2].empty() or not read_error(items[3]) or
+          not in_order(items[4], 9) or items[4].size() != 10 or
+          not incomplete(items[4][9]))
+        return fail(std::source_location::current().function_name());
+    }
+    return pass(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(decode_more_reads_than_submission_entries)
+  {
+    // 2 x 3000 one-byte reads in flight, more than the 4096 entries
+    // of a submission queue
+    SequenceFile first(300), second(300);
+    std::vector<std::string> const paths{first.path, second.path};
+    IngestOptions options;
+    options.chunk_size = 1;
+    options.reads_in_flight = 3000;
+    options.files_in_flight = 2;
+    for (auto backend : {IngestBackend::IoUring, IngestBackend::Auto}) {
+      options.backend = backend;
+      std::vector<std::vector<InputItem>> items(paths.size());
+      auto const used = decode_files(
+          paths,
+          [&](std::size_t file, InputItem&& item) {
+            items[file].push_back(std::move(item));
+          },
+          options);
+      if (not used and backend == IngestBackend::IoUring and
+          used.error() == std::errc::not_supported) {
+        note("io_uring not supported");
+        continue;
+      }
+      if (not used or not in_order(items[0], 300) or
+          items[0].size() != 300 or not in_order(items[1], 300) or
+          items[1].size() != 300)
+        return fail(std::source_location::current().function_name());
+    }
+    return pass(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(ingest_rejects_bad_options)
+  {
+    IngestOptions options;
+    options.reads_in_flight = 0;
+    auto const rejected =
+        ingest_files({}, [](IngestChunk const&) {}, options);
+    if (not rejected and rejected.error() == std::errc::invalid_argument and
+        ingest_files({}, [](IngestChunk const&) {})) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORIngestTests testSuite{};
+  testSuite.test_decode_files_in_order();
+  testSuite.test_decode_more_reads_than_submission_entries();
+  testSuite.test_ingest_rejects_bad_options();
+  return testSuite.failure();
+}
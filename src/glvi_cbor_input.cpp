@@ -0,0 +1,104 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_input.h"
+#include <cerrno>
+#include <unistd.h>
+
+namespace {
+  auto system_error() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::error_code(errno, std::system_category()));
+  }
+} // namespace
+
+auto StreamSource::read(std::span<std::byte> buffer)
+    -> std::expected<std::size_t, std::error_code> {
+  in.read(reinterpret_cast<char*>(buffer.data()),
+          static_cast<std::streamsize>(buffer.size()));
+  if (in.bad())
+    return std::unexpected(std::make_error_code(std::io_errc::stream));
+  return static_cast<std::size_t>(in.gcount());
+}
+
+auto FileSource::read(std::span<std::byte> buffer)
+    -> std::expected<std::size_t, std::error_code> {
+  errno = 0;
+  auto const n = std::fread(buffer.data(), 1, buffer.size(), file);
+  if (n == 0 and std::ferror(file)) {
+    if (errno != 0) return system_error();
+    return std::unexpected(std::make_error_code(std::io_errc::stream));
+  }
+  return n;
+}
+
+auto FdSource::read(std::span<std::byte> buffer)
+    -> std::expected<std::size_t, std::error_code> {
+  for (;;) {
+    auto const n = ::read(fd, buffer.data(), buffer.size());
+    if (n >= 0) return static_cast<std::size_t>(n);
+    if (errno != EINTR) return system_error();
+  }
+}
+
+BufferedInput::BufferedInput(InputSource& source, std::size_t capacity)
+    : source{source},
+      storage{new (std::align_val_t{input_buffer_alignment})
+                  std::byte[capacity]},
+      capacity{capacity} {
+}
+
+auto BufferedInput::refill()
+    -> std::expected<std::span<std::byte const>, std::error_code> {
+  auto const n = source.read({storage.get(), capacity});
+  if (not n) return std::unexpected(n.error());
+  return std::span<std::byte const>(storage.get(), *n);
+}
+
+auto SequenceReader::next() -> std::optional<InputItem> {
+  while (not done) {
+    if (pending.empty()) {
+      auto const bytes = input.refill();
+      if (not bytes) {
+        done = true;
+        return std::unexpected(input_error::Read{bytes.error()});
+      }
+      if (bytes->empty()) {
+        done = true;
+        if (within_item)
+          return std::unexpected(
+              input_error::Decode{parse_error::Incomplete{}});
+        return std::nullopt;
+      }
+      pending = *bytes;
+    }
+    auto result = parser.consume(pending);
+    if (result.is_incomplete()) {
+      within_item = true;
+      continue;
+    }
+    within_item = false;
+    if (result.is_complete())
+      return std::move(result.as_complete().value);
+    done = true;
+    return std::unexpected(input_error::Decode{result.as_error()});
+  }
+  return std::nullopt;
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_input() {
+  return "GLVI CBOR INPUT";
+}
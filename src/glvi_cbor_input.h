@@ -0,0 +1,194 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_parser.h"
+#include <cstddef>
+#include <cstdio>
+#include <expected>
+#include <istream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <variant>
+
+/**
+   Size of the buffer that `BufferedInput` refills, unless specified
+   otherwise; large enough that a refill costs one system call per
+   megabyte.
+ */
+constexpr std::size_t input_buffer_size_default = 1 << 20;
+
+/**
+   Alignment of the buffer that `BufferedInput` refills: a page, so
+   the buffer also suits direct I/O.
+ */
+constexpr std::size_t input_buffer_alignment = 4096;
+
+/**
+   Source of bytes, read in bulk: one virtual call per refill, rather
+   than per byte as with `std::istreambuf_iterator`.
+ */
+class InputSource {
+public:
+  virtual ~InputSource() = default;
+
+  /**
+     Reads up to `buffer.size()` bytes into `buffer`. Returns the
+     number of bytes read, 0 at the end of the input, or the error
+     reported by the system.
+   */
+  virtual auto read(std::span<std::byte> buffer)
+      -> std::expected<std::size_t, std::error_code> = 0;
+};
+
+/**
+   Reads from an `std::istream` with `read`, i.e. from its stream
+   buffer in bulk.
+ */
+class StreamSource : public InputSource {
+  std::istream& in;
+
+public:
+  explicit StreamSource(std::istream& in) : in{in} {}
+  auto read(std::span<std::byte> buffer)
+      -> std::expected<std::size_t, std::error_code> override;
+};
+
+/**
+   Reads from a C stream with `fread`; the stream stays open.
+ */
+class FileSource : public InputSource {
+  std::FILE* file;
+
+public:
+  explicit FileSource(std::FILE* file) : file{file} {}
+  auto read(std::span<std::byte> buffer)
+      -> std::expected<std::size_t, std::error_code> override;
+};
+
+/**
+   Reads from a file descriptor with `read(2)`, resuming after
+   interruptions; the descriptor stays open. Suits pipes and sockets
+   as well as files.
+ */
+class FdSource : public InputSource {
+  int fd;
+
+public:
+  explicit FdSource(int fd) : fd{fd} {}
+  auto read(std::span<std::byte> buffer)
+      -> std::expected<std::size_t, std::error_code> override;
+};
+
+/**
+   Buffer of `input_buffer_alignment`, refilled from an `InputSource`.
+ */
+class BufferedInput {
+  struct Free {
+    void operator()(std::byte* p) const noexcept {
+      ::operator delete[](p, std::align_val_t{input_buffer_alignment});
+    }
+  };
+  InputSource& source;
+  std::unique_ptr<std::byte[], Free> storage;
+  std::size_t capacity;
+
+public:
+  /**
+     Constructs a buffer of `capacity` bytes for reading from
+     `source`, which must outlive the buffer.
+   */
+  explicit BufferedInput(InputSource& source,
+                         std::size_t capacity = input_buffer_size_default);
+
+  /**
+     Refills the buffer with one read from the source. Returns the
+     bytes read, which stay valid until the next refill, an empty span
+     at the end of the input, or the error reported by the system.
+   */
+  auto refill() -> std::expected<std::span<std::byte const>, std::error_code>;
+};
+
+/**
+   Things that may go wrong when decoding from an input source
+ */
+namespace input_error {
+
+  /**
+     Reading from the source failed.
+   */
+  struct Read {
+    std::error_code code;
+  };
+
+  /**
+     The bytes read are not a well-formed CBOR sequence; an input that
+     ends within an item yields `parse_error::Incomplete`.
+   */
+  struct Decode {
+    ParseError error;
+  };
+
+  using InputError = std::variant<Read, Decode>;
+
+} // namespace input_error
+
+using input_error::InputError;
+
+/// Item of a CBOR sequence read from an input source
+using InputItem = std::expected<CBORValue, InputError>;
+
+/**
+   Decodes a CBOR sequence (RFC 8742) from an input source, e.g. a
+   pipe, refilling a `BufferedInput` as needed. Items may span
+   refills; the parser keeps its state across them.
+
+       FdSource source(STDIN_FILENO);
+       SequenceReader reader(source);
+       while (auto item = reader.next()) ...
+ */
+class SequenceReader {
+  BufferedInput input;
+  Parser parser;
+  std::span<std::byte const> pending;
+  bool within_item = false;
+  bool done = false;
+
+public:
+  /**
+     Constructs a reader of `source`, which must outlive the reader,
+     with a buffer of `capacity` bytes.
+   */
+  explicit SequenceReader(InputSource& source,
+                          std::size_t capacity = input_buffer_size_default)
+      : input(source, capacity) {}
+
+  /**
+     As above, rejecting items beyond `limits`.
+   */
+  SequenceReader(InputSource& source, DecodeLimits const& limits,
+                 std::size_t capacity = input_buffer_size_default)
+      : input(source, capacity), parser(limits) {}
+
+  /**
+     Returns the next item, `std::nullopt` at the end of the input, or
+     the error that ended decoding; there are no items after an error.
+   */
+  auto next() -> std::optional<InputItem>;
+};
@@ -0,0 +1,106 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_input.h"
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <vector>
+
+/**
+   Compares decoding a CBOR sequence from a file through
+   `std::istreambuf_iterator` with decoding it through `SequenceReader`
+   from an `std::istream` and from a file descriptor. Build with
+   `make glvi_cbor_input_bench`.
+ */
+
+using namespace std::chrono;
+
+namespace {
+
+  constexpr std::size_t count = 500'000;
+
+  auto write_sequence(char const* path) -> std::size_t {
+    std::vector<std::byte> sequence;
+    for (std::size_t i = 0; i < count; ++i) {
+      CBORArray item;
+      item.push_back(CBORUint(CBOR_U64(i)));
+      item.push_back(u8"a text string that is a bit longer"_cbor_tstr);
+      auto const bytes = encode(item);
+      sequence.insert(sequence.end(), bytes.begin(), bytes.end());
+    }
+    auto* file = std::fopen(path, "wb");
+    std::fwrite(sequence.data(), 1, sequence.size(), file);
+    std::fclose(file);
+    return sequence.size();
+  }
+
+  template <typename F>
+  auto measure(char const* name, std::size_t size, F&& f) -> double {
+    auto const start = steady_clock::now();
+    auto const items = f();
+    auto const elapsed = duration<double>(steady_clock::now() - start);
+    auto const rate = size / elapsed.count() / (1 << 20);
+    std::printf("%-28s %8.1f MiB/s  (%zu items)\n", name, rate, items);
+    return rate;
+  }
+
+} // namespace
+
+int main() {
+  char path[] = "/tmp/glvi_cbor_input_benchXXXXXX";
+  auto const fd = ::mkstemp(path);
+  ::close(fd);
+  auto const size = write_sequence(path);
+
+  auto const iterator = measure("istreambuf_iterator", size, [&] {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> bytes{std::istreambuf_iterator<char>(in),
+                                    std::istreambuf_iterator<char>()};
+    Parser parser;
+    std::size_t items = 0;
+    for (auto b : bytes)
+      items += parser.consume(b).is_complete();
+    return items;
+  });
+  auto const stream = measure("SequenceReader (istream)", size, [&] {
+    std::ifstream in(path, std::ios::binary);
+    StreamSource source(in);
+    SequenceReader reader(source);
+    std::size_t items = 0;
+    while (auto item = reader.next())
+      items += item->has_value();
+    return items;
+  });
+  auto const fdesc = measure("SequenceReader (fd)", size, [&] {
+    auto const in = ::open(path, O_RDONLY);
+    FdSource source(in);
+    SequenceReader reader(source);
+    std::size_t items = 0;
+    while (auto item = reader.next())
+      items += item->has_value();
+    ::close(in);
+    return items;
+  });
+  std::printf("speed-up %.1fx (istream), %.1fx (fd)\n", stream / iterator,
+              fdesc / iterator);
+  ::unlink(path);
+  return 0;
+}
@@ -0,0 +1,143 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_input.h"
+#include <cstdio>
+#include <dejagnu.h>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+  /// Encoding of item `i` of a sequence: [i, "payload"]
+  auto make_item(unsigned i) {
+    CBORArray item;
+    item.push_back(CBORUint(CBOR_U64(i)));
+    item.push_back(u8"payload"_cbor_tstr);
+    return encode(item);
+  }
+
+  /// Sequence of `count` items made by `make_item`
+  auto make_sequence(unsigned count) -> std::vector<std::byte> {
+    std::vector<std::byte> sequence;
+    for (unsigned i = 0; i < count; ++i) {
+      auto const bytes = make_item(i);
+      sequence.insert(sequence.end(), bytes.begin(), bytes.end());
+    }
+    return sequence;
+  }
+
+  /// Reads all items, and checks they are those of `make_sequence`
+  auto read_all(SequenceReader& reader, unsigned count) -> bool {
+    unsigned read = 0;
+    while (auto item = reader.next()) {
+      if (not *item or encode(**item) != make_item(read)) return false;
+      ++read;
+    }
+    return read == count and not reader.next();
+  }
+} // namespace
+
+class CBORInputTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(read_from_stream_and_file)
+  {
+    auto const sequence = make_sequence(100);
+    // a buffer of 7 bytes, so that items span refills
+    std::istringstream in(
+        std::string(reinterpret_cast<char const*>(sequence.data()),
+                    sequence.size()));
+    StreamSource stream(in);
+    SequenceReader from_stream(stream, 7);
+    auto const streamed = read_all(from_stream, 100);
+
+    auto* file = std::tmpfile();
+    std::fwrite(sequence.data(), 1, sequence.size(), file);
+    std::rewind(file);
+    FileSource source(file);
+    SequenceReader from_file(source);
+    auto const filed = read_all(from_file, 100);
+    std::fclose(file);
+    if (streamed and filed) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(read_from_pipe)
+  {
+    auto sequence = make_sequence(50);
+    int fds[2];
+    if (::pipe(fds) != 0)
+      return fail(std::source_location::current().function_name());
+    // the last item is cut short
+    sequence.pop_back();
+    auto const written = ::write(fds[1], sequence.data(), sequence.size());
+    ::close(fds[1]);
+    FdSource source(fds[0]);
+    SequenceReader reader(source, 64);
+    unsigned read = 0;
+    std::optional<InputItem> last;
+    while (auto item = reader.next()) {
+      if (*item) ++read;
+      last = std::move(item);
+    }
+    ::close(fds[0]);
+    auto const incomplete =
+        last and not *last and
+        std::holds_alternative<input_error::Decode>(last->error()) and
+        std::get<input_error::Decode>(last->error()).error.is_incomplete();
+    // reading from a closed descriptor fails
+    FdSource closed(fds[0]);
+    SequenceReader failing(closed);
+    auto const error = failing.next();
+    auto const read_error =
+        error and not *error and
+        std::holds_alternative<input_error::Read>(error->error()) and
+        std::get<input_error::Read>(error->error()).code.value() == EBADF;
+    if (written == static_cast<ssize_t>(sequence.size()) and read == 49 and
+        incomplete and read_error and not failing.next()) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORInputTests testSuite{};
+  testSuite.test_read_from_stream_and_file();
+  testSuite.test_read_from_pipe();
+  return testSuite.failure();
+}
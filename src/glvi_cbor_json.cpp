@@ -0,0 +1,866 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "config.h"
+#include "glvi_cbor_json.h"
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_float.h"
+#include "glvi_cbor_head.h"
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if HAVE_IMMINTRIN_H && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define GLVI_CBOR_JSON_X86 1
+#include <immintrin.h>
+#elif HAVE_ARM_NEON_H && defined(__aarch64__)
+#define GLVI_CBOR_JSON_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+  constexpr auto needs_escape(char8_t c) noexcept -> bool {
+    return c < 0x20 or c == u8'"' or c == u8'\\';
+  }
+
+  auto plain_prefix_scalar(char8_t const* p, std::size_t n) noexcept
+      -> std::size_t {
+    std::size_t i = 0;
+    while (i < n and not needs_escape(p[i]))
+      ++i;
+    return i;
+  }
+
+  /**
+     Returns the number of characters at the start of `p` that need
+     no escaping.
+   */
+  auto plain_prefix(char8_t const* p, std::size_t n) noexcept -> std::size_t {
+    std::size_t i = 0;
+#if GLVI_CBOR_JSON_X86 && defined(__SSE2__)
+    auto const quote = _mm_set1_epi8('"');
+    auto const backslash = _mm_set1_epi8('\\');
+    auto const control_max = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= n; i += 16) {
+      auto const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+      // unsigned x <= 0x1f iff max(x, 0x1f) == 0x1f
+      auto const control =
+          _mm_cmpeq_epi8(_mm_max_epu8(x, control_max), control_max);
+      auto const special = _mm_or_si128(
+          control, _mm_or_si128(_mm_cmpeq_epi8(x, quote),
+                                _mm_cmpeq_epi8(x, backslash)));
+      if (auto const mask = _mm_movemask_epi8(special))
+        return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+#elif GLVI_CBOR_JSON_NEON
+    auto const quote = vdupq_n_u8('"');
+    auto const backslash = vdupq_n_u8('\\');
+    auto const control_end = vdupq_n_u8(0x20);
+    for (; i + 16 <= n; i += 16) {
+      auto const x = vld1q_u8(reinterpret_cast<std::uint8_t const*>(p + i));
+      auto const special =
+          vorrq_u8(vcltq_u8(x, control_end),
+                   vorrq_u8(vceqq_u8(x, quote), vceqq_u8(x, backslash)));
+      if (vmaxvq_u8(special))
+        return i + plain_prefix_scalar(p + i, 16);
+    }
+#endif
+    return i + plain_prefix_scalar(p + i, n - i);
+  }
+
+  void append_escape(char8_t c, std::u8string& out) {
+    constexpr char8_t hex[] = u8"0123456789abcdef";
+    switch (c) {
+    case u8'"': out += u8"\\\""; return;
+    case u8'\\': out += u8"\\\\"; return;
+    case u8'\b': out += u8"\\b"; return;
+    case u8'\f': out += u8"\\f"; return;
+    case u8'\n': out += u8"\\n"; return;
+    case u8'\r': out += u8"\\r"; return;
+    case u8'\t': out += u8"\\t"; return;
+    default:
+      out += u8"\\u00";
+      out += hex[c >> 4];
+      out += hex[c & 0xf];
+    }
+  }
+
+  constexpr char8_t base64url_alphabet[] =
+      u8"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+  constexpr char8_t base64_alphabet[] =
+      u8"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  /**
+     Encodes `in` with `alphabet` into `out`, which must accept the
+     complete encoding; writes padding if `pad`. Returns the end of
+     the output.
+   */
+  auto base64_scalar(std::byte const* in, std::size_t n,
+                     char8_t const* alphabet, bool pad, char8_t* out) noexcept
+      -> char8_t* {
+    auto const at = [in](std::size_t i) {
+      return std::to_integer<std::uint32_t>(in[i]);
+    };
+    std::size_t i = 0;
+    for (; i + 3 <= n; i += 3) {
+      auto const group = at(i) << 16 | at(i + 1) << 8 | at(i + 2);
+      *out++ = alphabet[group >> 18];
+      *out++ = alphabet[(group >> 12) & 0x3f];
+      *out++ = alphabet[(group >> 6) & 0x3f];
+      *out++ = alphabet[group & 0x3f];
+    }
+    if (n - i == 1) {
+      auto const group = at(i) << 16;
+      *out++ = alphabet[group >> 18];
+      *out++ = alphabet[(group >> 12) & 0x3f];
+      if (pad) {
+        *out++ = u8'=';
+        *out++ = u8'=';
+      }
+    } else if (n - i == 2) {
+      auto const group = at(i) << 16 | at(i + 1) << 8;
+      *out++ = alphabet[group >> 18];
+      *out++ = alphabet[(group >> 12) & 0x3f];
+      *out++ = alphabet[(group >> 6) & 0x3f];
+      if (pad) *out++ = u8'=';
+    }
+    return out;
+  }
+
+#if GLVI_CBOR_JSON_X86
+
+  // 12 input bytes become 16 characters per step: the bytes are
+  // spread so that each 32-bit lane holds one group of 3, the four
+  // 6-bit indices are moved into separate bytes with multiplications,
+  // and the indices are mapped to characters by adding an offset
+  // looked up per range (A-Z, a-z, 0-9, and the last two).
+  // Reads 16 bytes per step, so the last 4 input bytes are left to
+  // the caller. Returns the number of input bytes consumed.
+  __attribute__((target("ssse3"))) auto
+  base64_ssse3(std::byte const* in, std::size_t n, bool url,
+               char8_t* out) noexcept -> std::size_t {
+    auto const spread =
+        _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    auto const offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        (url ? '-' : '+') - 62, (url ? '_' : '/') - 63, 'A', 0, 0);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 12, out += 16) {
+      auto x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+      x = _mm_shuffle_epi8(x, spread);
+      auto const high = _mm_mulhi_epu16(
+          _mm_and_si128(x, _mm_set1_epi32(0x0fc0fc00)),
+          _mm_set1_epi32(0x04000040));
+      auto const low = _mm_mullo_epi16(
+          _mm_and_si128(x, _mm_set1_epi32(0x003f03f0)),
+          _mm_set1_epi32(0x01000010));
+      auto const indices = _mm_or_si128(high, low);
+      // 0 for a-z, 1..10 for 0-9, 11 and 12 for the last two, and 13
+      // for A-Z
+      auto range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      auto const upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+      auto const chars =
+          _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+    }
+    return i;
+  }
+
+  auto has_ssse3() noexcept -> bool {
+    static bool const supported = __builtin_cpu_supports("ssse3");
+    return supported;
+  }
+
+#endif
+
+  void append_base64(std::span<std::byte const> bytes, bool url,
+                     std::u8string& out) {
+    auto const n = bytes.size();
+    auto const tail = n % 3;
+    auto const size = n / 3 * 4 + (tail == 0 ? 0 : url ? tail + 1 : 4);
+    auto const first = out.size();
+    out.resize(first + size);
+    auto p = out.data() + first;
+    std::size_t i = 0;
+#if GLVI_CBOR_JSON_X86
+    if (has_ssse3()) {
+      i = base64_ssse3(bytes.data(), n, url, p);
+      p += i / 3 * 4;
+    }
+#endif
+    base64_scalar(bytes.data() + i, n - i,
+                  url ? base64url_alphabet : base64_alphabet, not url, p);
+  }
+
+  void append_base16(std::span<std::byte const> bytes, std::u8string& out) {
+    constexpr char8_t hex[] = u8"0123456789ABCDEF";
+    for (auto b : bytes) {
+      auto const octet = std::to_integer<std::uint8_t>(b);
+      out += hex[octet >> 4];
+      out += hex[octet & 0xf];
+    }
+  }
+
+  template <typename Number>
+  void append_number(Number x, std::u8string& out) {
+    char buffer[32];
+    auto const result = std::to_chars(buffer, buffer + sizeof buffer, x);
+    out.append(reinterpret_cast<char8_t const*>(buffer), result.ptr - buffer);
+  }
+
+  /// Conversion of byte strings, see RFC 8949 §3.4.5.2
+  enum class BytesAs { Base64url, Base64, Base16 };
+
+  /**
+     Transcodes items read in place from `bytes`, starting at `pos`.
+   */
+  struct JsonTranscoder {
+    std::span<std::byte const> bytes;
+    std::size_t pos;
+    std::u8string& out;
+    std::size_t error_offset = 0;
+
+    auto malformed(std::size_t offset) noexcept -> bool {
+      error_offset = offset;
+      return false;
+    }
+
+    /// Consumes a break stop code, if it is next
+    auto at_break() noexcept -> bool {
+      if (pos < bytes.size() and bytes[pos] == std::byte{0xff}) {
+        pos += 1;
+        return true;
+      }
+      return false;
+    }
+
+    /// Reads the payload of a definite-length string
+    auto payload(std::uint64_t n, std::span<std::byte const>& result) noexcept
+        -> bool {
+      if (n > bytes.size() - pos) return false;
+      result = bytes.subspan(pos, n);
+      pos += n;
+      return true;
+    }
+
+    /**
+       Reads the chunks of an indefinite-length string of major type
+       `major` into `result`.
+     */
+    auto chunks(MajorType major, std::vector<std::byte>& result) -> bool {
+      while (not at_break()) {
+        auto const offset = pos;
+        auto const head = read_head(bytes.subspan(pos));
+        std::span<std::byte const> chunk;
+        if (not head or head->major != major or head->is_indefinite())
+          return malformed(offset);
+        pos += head->size;
+        if (not payload(head->arg, chunk)) return malformed(offset);
+        result.insert(result.end(), chunk.begin(), chunk.end());
+      }
+      return true;
+    }
+
+    void byte_string(std::span<std::byte const> payload, BytesAs conversion) {
+      out += u8'"';
+      switch (conversion) {
+      case BytesAs::Base64url: append_base64(payload, true, out); break;
+      case BytesAs::Base64: append_base64(payload, false, out); break;
+      case BytesAs::Base16: append_base16(payload, out); break;
+      }
+      out += u8'"';
+    }
+
+    void text_string(std::span<std::byte const> payload) {
+      out += u8'"';
+      append_json_escaped(
+          {reinterpret_cast<char8_t const*>(payload.data()), payload.size()},
+          out);
+      out += u8'"';
+    }
+
+    /**
+       Transcodes a map key, which JSON requires to be a string.
+     */
+    auto key(unsigned depth, BytesAs conversion) -> bool {
+      auto const first = out.size();
+      if (not item(depth, conversion)) return false;
+      if (out[first] == u8'"') return true;
+      std::u8string const text(out, first);
+      out.resize(first);
+      out += u8'"';
+      append_json_escaped(text, out);
+      out += u8'"';
+      return true;
+    }
+
+    /**
+       Transcodes the content of a bignum, tag 2 or 3, to base64url
+       without padding, prefixed with "~" if `negative`, see RFC 8949
+       §6.1. Content other than a byte string is transcoded as is.
+     */
+    auto bignum(unsigned depth, BytesAs conversion, bool negative) -> bool {
+      auto const offset = pos;
+      auto const head = read_head(bytes.subspan(pos));
+      if (not head or head->major != MajorType::Bstr)
+        return item(depth, conversion);
+      pos += head->size;
+      std::span<std::byte const> content;
+      std::vector<std::byte> joined;
+      if (head->is_indefinite()) {
+        if (not chunks(MajorType::Bstr, joined)) return false;
+        content = joined;
+      } else if (not payload(head->arg, content)) {
+        return malformed(offset);
+      }
+      out += negative ? u8"\"~" : u8"\"";
+      append_base64(content, true, out);
+      out += u8'"';
+      return true;
+    }
+
+    auto item(unsigned depth, BytesAs conversion) -> bool {
+      auto const offset = pos;
+      if (depth > deterministic_depth_max) return malformed(offset);
+      auto const opt_head = read_head(bytes.subspan(pos));
+      if (not opt_head) return malformed(offset);
+      auto const head = *opt_head;
+      pos += head.size;
+      switch (head.major) {
+      case MajorType::Uint:
+        if (head.is_indefinite()) return malformed(offset);
+        append_number(head.arg, out);
+        return true;
+      case MajorType::Nint:
+        if (head.is_indefinite()) return malformed(offset);
+        // -1 - arg, which may be below the range of std::int64_t
+        if (head.arg == std::numeric_limits<std::uint64_t>::max()) {
+          out += u8"-18446744073709551616";
+        } else {
+          out += u8'-';
+          append_number(head.arg + 1, out);
+        }
+        return true;
+      case MajorType::Bstr:
+      case MajorType::Tstr: {
+        std::span<std::byte const> content;
+        std::vector<std::byte> joined;
+        if (head.is_indefinite()) {
+          if (not chunks(head.major, joined)) return false;
+          content = joined;
+        } else if (not payload(head.arg, content)) {
+          return malformed(offset);
+        }
+        if (head.major == MajorType::Bstr)
+          byte_string(content, conversion);
+        else
+          text_string(content);
+        return true;
+      }
+      case MajorType::Array: {
+        out += u8'[';
+        for (std::uint64_t i = 0;
+             head.is_indefinite() ? not at_break() : i < head.arg; ++i) {
+          if (pos == bytes.size()) return malformed(offset);
+          if (i > 0) out += u8',';
+          if (not item(depth + 1, conversion)) return false;
+        }
+        out += u8']';
+        return true;
+      }
+      case MajorType::Map: {
+        out += u8'{';
+        for (std::uint64_t i = 0;
+             head.is_indefinite() ? not at_break() : i < head.arg; ++i) {
+          if (pos == bytes.size()) return malformed(offset);
+          if (i > 0) out += u8',';
+          if (not key(depth + 1, conversion)) return false;
+          out += u8':';
+          if (not item(depth + 1, conversion)) return false;
+        }
+        out += u8'}';
+        return true;
+      }
+      case MajorType::Tag:
+        if (head.is_indefinite()) return malformed(offset);
+        if (head.arg == 2 or head.arg == 3)
+          return bignum(depth + 1, conversion, head.arg == 3);
+        switch (head.arg) {
+        case 21: conversion = BytesAs::Base64url; break;
+        case 22: conversion = BytesAs::Base64; break;
+        case 23: conversion = BytesAs::Base16; break;
+        }
+        return item(depth + 1, conversion);
+      case MajorType::Simple:
+        switch (head.info) {
+        case 20: out += u8"false"; return true;
+        case 21: out += u8"true"; return true;
+        case 24:
+          if (head.arg < 32) return malformed(offset);
+          out += u8"null";
+          return true;
+        case 25:
+        case 26:
+        case 27: {
+          auto const width = static_cast<std::uint8_t>(1 << (head.info - 24));
+          auto const value = from_bits(head.arg, width);
+          if (std::isfinite(value))
+            append_number(value, out);
+          else
+            out += u8"null";
+          return true;
+        }
+        case CBOR_INDEFINITE: return malformed(offset); // stray "break"
+        default: out += u8"null"; return true;
+        }
+      }
+      return malformed(offset);
+    }
+  };
+
+} // namespace
+
+void append_base64url(std::span<std::byte const> bytes, std::u8string& out) {
+  append_base64(bytes, true, out);
+}
+
+void append_json_escaped(std::u8string_view text, std::u8string& out) {
+  while (not text.empty()) {
+    auto const plain = plain_prefix(text.data(), text.size());
+    out.append(text.data(), plain);
+    if (plain == text.size()) return;
+    append_escape(text[plain], out);
+    text.remove_prefix(plain + 1);
+  }
+}
+
+auto transcode_json(std::span<std::byte const> bytes, std::u8string& out)
+    -> std::expected<std::size_t, JsonError> {
+  JsonTranscoder transcoder{bytes, 0, out};
+  if (not transcoder.item(0, BytesAs::Base64url))
+    return std::unexpected(json_error::Malformed{transcoder.error_offset});
+  return transcoder.pos;
+}
+
+auto transcode_json_lines(std::span<std::byte const> sequence,
+                          JsonSink const& sink, std::size_t chunk_size)
+    -> std::expected<std::size_t, JsonError> {
+  std::u8string buffer;
+  buffer.reserve(chunk_size + chunk_size / 4);
+  JsonTranscoder transcoder{sequence, 0, buffer};
+  std::size_t count = 0;
+  while (transcoder.pos < sequence.size()) {
+    auto const line = buffer.size();
+    if (not transcoder.item(0, BytesAs::Base64url)) {
+      buffer.resize(line);
+      if (not buffer.empty()) sink(buffer);
+      return std::unexpected(json_error::Malformed{transcoder.error_offset});
+    }
+    buffer += u8'\n';
+    count += 1;
+    if (buffer.size() >= chunk_size) {
+      sink(buffer);
+      buffer.clear();
+    }
+  }
+  if (not buffer.empty()) sink(buffer);
+  return count;
+}
+
+namespace {
+
+  constexpr auto is_space(char8_t c) noexcept -> bool {
+    return c == u8' ' or c == u8'\t' or c == u8'\n' or c == u8'\r';
+  }
+
+  constexpr auto is_digit(char8_t c) noexcept -> bool {
+    return c >= u8'0' and c <= u8'9';
+  }
+
+  auto hex_value(char8_t c) noexcept -> int {
+    if (is_digit(c)) return c - u8'0';
+    if (c >= u8'a' and c <= u8'f') return c - u8'a' + 10;
+    if (c >= u8'A' and c <= u8'F') return c - u8'A' + 10;
+    return -1;
+  }
+
+  void append_utf8(char32_t c, std::u8string& out) {
+    if (c < 0x80) {
+      out += static_cast<char8_t>(c);
+    } else if (c < 0x800) {
+      out += static_cast<char8_t>(0xc0 | c >> 6);
+      out += static_cast<char8_t>(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) {
+      out += static_cast<char8_t>(0xe0 | c >> 12);
+      out += static_cast<char8_t>(0x80 | (c >> 6 & 0x3f));
+      out += static_cast<char8_t>(0x80 | (c & 0x3f));
+    } else {
+      out += static_cast<char8_t>(0xf0 | c >> 18);
+      out += static_cast<char8_t>(0x80 | (c >> 12 & 0x3f));
+      out += static_cast<char8_t>(0x80 | (c >> 6 & 0x3f));
+      out += static_cast<char8_t>(0x80 | (c & 0x3f));
+    }
+  }
+
+  /**
+     Recursive-descent JSON parser writing CBOR to `out` as it goes.
+   */
+  struct JsonParser {
+    std::u8string_view text;
+    std::size_t pos;
+    std::vector<std::byte>& out;
+    JsonContainers containers;
+    std::size_t error_offset = 0;
+    /// unescaped content of strings with escapes
+    std::u8string scratch = {};
+
+    auto syntax(std::size_t offset) noexcept -> bool {
+      error_offset = offset;
+      return false;
+    }
+
+    void skip_space() noexcept {
+      while (pos < text.size() and is_space(text[pos]))
+        ++pos;
+    }
+
+    void head(MajorType major, std::uint64_t arg) {
+      std::byte buffer[9];
+      auto const end = write_head(buffer, major, arg);
+      out.insert(out.end(), buffer, end);
+    }
+
+    void initial(std::uint8_t byte) { out.push_back(std::byte{byte}); }
+
+    auto literal(std::u8string_view word, std::uint8_t byte) -> bool {
+      if (text.substr(pos, word.size()) != word) return syntax(pos);
+      pos += word.size();
+      initial(byte);
+      return true;
+    }
+
+    void text_string(std::u8string_view content) {
+      head(MajorType::Tstr, content.size());
+      auto const first = reinterpret_cast<std::byte const*>(content.data());
+      out.insert(out.end(), first, first + content.size());
+    }
+
+    auto hex4(std::size_t at, char32_t& result) noexcept -> bool {
+      if (text.size() - at < 4) return false;
+      result = 0;
+      for (std::size_t i = 0; i < 4; ++i) {
+        auto const digit = hex_value(text[at + i]);
+        if (digit < 0) return false;
+        result = result << 4 | static_cast<char32_t>(digit);
+      }
+      return true;
+    }
+
+    /**
+       Parses the string starting after the opening quotation mark.
+     */
+    auto string() -> bool {
+      auto const start = pos;
+      auto run = plain_prefix(text.data() + pos, text.size() - pos);
+      pos += run;
+      if (pos == text.size()) return syntax(pos);
+      if (text[pos] == u8'"') {
+        // the common case: no escapes, copied as is
+        text_string(text.substr(start, run));
+        pos += 1;
+        return true;
+      }
+      scratch.assign(text.substr(start, run));
+      while (text[pos] != u8'"') {
+        if (text[pos] != u8'\\') return syntax(pos);
+        auto const escape = pos;
+        if (++pos == text.size()) return syntax(escape);
+        switch (text[pos++]) {
+        case u8'"': scratch += u8'"'; break;
+        case u8'\\': scratch += u8'\\'; break;
+        case u8'/': scratch += u8'/'; break;
+        case u8'b': scratch += u8'\b'; break;
+        case u8'f': scratch += u8'\f'; break;
+        case u8'n': scratch += u8'\n'; break;
+        case u8'r': scratch += u8'\r'; break;
+        case u8't': scratch += u8'\t'; break;
+        case u8'u': {
+          char32_t c;
+          if (not hex4(pos, c)) return syntax(escape);
+          pos += 4;
+          if (c >= 0xd800 and c < 0xdc00) {
+            // a high surrogate must be followed by a low one
+            char32_t low;
+            if (text.substr(pos, 2) != u8"\\u" or not hex4(pos + 2, low) or
+                low < 0xdc00 or low >= 0xe000)
+              return syntax(escape);
+            pos += 6;
+            c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+          } else if (c >= 0xdc00 and c < 0xe000) {
+            return syntax(escape);
+          }
+          append_utf8(c, scratch);
+          break;
+        }
+        default: return syntax(escape);
+        }
+        run = plain_prefix(text.data() + pos, text.size() - pos);
+        scratch.append(text.substr(pos, run));
+        pos += run;
+        if (pos == text.size()) return syntax(pos);
+      }
+      pos += 1;
+      text_string(scratch);
+      return true;
+    }
+
+    /**
+       Returns roughly the decimal exponent of the number with integer
+       digits from `digits` to `integer_end`, and the exponent from
+       `exponent` to `pos`, if any: the exponent of its first nonzero
+       digit, plus one, saturating far beyond the range of a double.
+     */
+    auto decimal_exponent(std::size_t digits, std::size_t integer_end,
+                          std::size_t exponent) const noexcept
+        -> std::int64_t {
+      constexpr std::int64_t far = std::int64_t{1} << 40;
+      std::int64_t scale = 0;
+      if (text[digits] != u8'0') {
+        scale = static_cast<std::int64_t>(integer_end - digits);
+      } else {
+        // 0.000ddd: skip the point and count the zeros
+        for (auto i = integer_end + 1; i < exponent and text[i] == u8'0'; ++i)
+          --scale;
+      }
+      if (exponent == pos) return scale;
+      auto const sign = exponent;
+      if (text[exponent] == u8'+' or text[exponent] == u8'-') ++exponent;
+      auto const first = reinterpret_cast<char const*>(text.data());
+      std::int64_t e;
+      auto const [end, ec] =
+          std::from_chars(first + exponent, first + pos, e);
+      if (ec != std::errc{} or e > far) e = far;
+      return text[sign] == u8'-' ? scale - e : scale + e;
+    }
+
+    auto number() -> bool {
+      auto const start = pos;
+      auto const negative = text[pos] == u8'-';
+      if (negative) ++pos;
+      auto const digits = pos;
+      if (pos < text.size() and text[pos] == u8'0') {
+        ++pos;
+      } else {
+        if (pos == text.size() or not is_digit(text[pos]))
+          return syntax(start);
+        while (pos < text.size() and is_digit(text[pos]))
+          ++pos;
+      }
+      auto const integer_end = pos;
+      auto integral = true;
+      if (pos < text.size() and text[pos] == u8'.') {
+        integral = false;
+        if (++pos == text.size() or not is_digit(text[pos]))
+          return syntax(start);
+        while (pos < text.size() and is_digit(text[pos]))
+          ++pos;
+      }
+      auto exponent = pos;
+      if (pos < text.size() and (text[pos] == u8'e' or text[pos] == u8'E')) {
+        integral = false;
+        exponent = ++pos;
+        if (pos < text.size() and (text[pos] == u8'+' or text[pos] == u8'-'))
+          ++pos;
+        if (pos == text.size() or not is_digit(text[pos]))
+          return syntax(start);
+        while (pos < text.size() and is_digit(text[pos]))
+          ++pos;
+      }
+      auto const first = reinterpret_cast<char const*>(text.data());
+      if (integral) {
+        std::uint64_t n;
+        auto const [end, ec] = std::from_chars(first + digits, first + pos, n);
+        if (ec == std::errc{}) {
+          if (not negative or n == 0)
+            head(MajorType::Uint, n);
+          else
+            head(MajorType::Nint, n - 1);
+          return true;
+        }
+        // -2^64 is the least negative integer
+        if (negative and text.substr(digits, pos - digits) ==
+                             u8"18446744073709551616") {
+          head(MajorType::Nint, std::numeric_limits<std::uint64_t>::max());
+          return true;
+        }
+        // beyond 64 bits: written as a float
+      }
+      double value;
+      auto const [end, ec] = std::from_chars(first + start, first + pos, value);
+      if (ec == std::errc::result_out_of_range) {
+        // from_chars leaves `value` alone: the number is either beyond
+        // the largest double, or below the least, and the sign of its
+        // decimal exponent tells which
+        auto const magnitude = decimal_exponent(digits, integer_end, exponent);
+        value = magnitude > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+        if (negative) value = -value;
+      }
+      std::byte buffer[9];
+      auto const last =
+          write_float(buffer, CBORFloat{value}, EncodeMode::Preferred);
+      out.insert(out.end(), buffer, last);
+      return true;
+    }
+
+    /**
+       Writes the head of a container that started at `start` in
+       `out` and has `count` elements or entries.
+     */
+    void close(MajorType major, std::size_t start, std::uint64_t count) {
+      if (containers == JsonContainers::Indefinite) {
+        initial(0xff);
+        return;
+      }
+      std::byte buffer[9];
+      auto const end = write_head(buffer, major, count);
+      out.insert(out.begin() + start, buffer, end);
+    }
+
+    void open(MajorType major) {
+      if (containers == JsonContainers::Indefinite)
+        initial(static_cast<std::uint8_t>(major) << 5 | CBOR_INDEFINITE);
+    }
+
+    auto array(unsigned depth) -> bool {
+      auto const start = out.size();
+      open(MajorType::Array);
+      std::uint64_t count = 0;
+      skip_space();
+      if (pos < text.size() and text[pos] == u8']') {
+        ++pos;
+      } else {
+        for (;;) {
+          if (not value(depth + 1)) return false;
+          ++count;
+          skip_space();
+          if (pos == text.size()) return syntax(pos);
+          auto const c = text[pos++];
+          if (c == u8']') break;
+          if (c != u8',') return syntax(pos - 1);
+        }
+      }
+      close(MajorType::Array, start, count);
+      return true;
+    }
+
+    auto object(unsigned depth) -> bool {
+      auto const start = out.size();
+      open(MajorType::Map);
+      std::uint64_t count = 0;
+      skip_space();
+      if (pos < text.size() and text[pos] == u8'}') {
+        ++pos;
+      } else {
+        for (;;) {
+          skip_space();
+          if (pos == text.size() or text[pos] != u8'"') return syntax(pos);
+          ++pos;
+          if (not string()) return false;
+          skip_space();
+          if (pos == text.size() or text[pos] != u8':') return syntax(pos);
+          ++pos;
+          if (not value(depth + 1)) return false;
+          ++count;
+          skip_space();
+          if (pos == text.size()) return syntax(pos);
+          auto const c = text[pos++];
+          if (c == u8'}') break;
+          if (c != u8',') return syntax(pos - 1);
+        }
+      }
+      close(MajorType::Map, start, count);
+      return true;
+    }
+
+    auto value(unsigned depth) -> bool {
+      skip_space();
+      if (depth > deterministic_depth_max) return syntax(pos);
+      if (pos == text.size()) return syntax(pos);
+      switch (text[pos]) {
+      case u8'{': ++pos; return object(depth);
+      case u8'[': ++pos; return array(depth);
+      case u8'"': ++pos; return string();
+      case u8't': return literal(u8"true", 0xf5);
+      case u8'f': return literal(u8"false", 0xf4);
+      case u8'n': return literal(u8"null", 0xf6);
+      default:
+        if (text[pos] == u8'-' or is_digit(text[pos])) return number();
+        return syntax(pos);
+      }
+    }
+  };
+
+} // namespace
+
+auto parse_json(std::u8string_view text, std::vector<std::byte>& out,
+                JsonContainers containers) -> std::expected<void, JsonError> {
+  auto const first = out.size();
+  JsonParser parser{text, 0, out, containers};
+  if (parser.value(0)) {
+    parser.skip_space();
+    if (parser.pos == text.size()) return {};
+    parser.error_offset = parser.pos;
+  }
+  out.resize(first);
+  return std::unexpected(json_error::Syntax{parser.error_offset});
+}
+
+auto parse_json_lines(std::u8string_view text, std::vector<std::byte>& out,
+                      JsonContainers containers)
+    -> std::expected<std::size_t, JsonError> {
+  JsonParser parser{text, 0, out, containers};
+  std::size_t count = 0;
+  for (;;) {
+    parser.skip_space();
+    if (parser.pos == text.size()) return count;
+    auto const item = out.size();
+    if (not parser.value(0)) {
+      out.resize(item);
+      return std::unexpected(json_error::Syntax{parser.error_offset});
+    }
+    // the rest of the line may only hold white space
+    while (parser.pos < text.size() and text[parser.pos] != u8'\n') {
+      if (not is_space(text[parser.pos])) {
+        out.resize(item);
+        return std::unexpected(json_error::Syntax{parser.pos});
+      }
+      ++parser.pos;
+    }
+    count += 1;
+  }
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_json() {
+  return "GLVI CBOR JSON";
+}
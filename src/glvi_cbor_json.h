@@ -0,0 +1,161 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/**
+   Errors specific to transcoding between CBOR and JSON
+ */
+namespace json_error {
+
+  /**
+     This error indicates that the input is not well-formed CBOR, is
+     truncated, or nests items deeper than `deterministic_depth_max`.
+   */
+  struct Malformed {
+    /// offset of the offending head
+    std::size_t offset;
+  };
+
+  /**
+     This error indicates that the input is not valid JSON, or nests
+     values deeper than `deterministic_depth_max`.
+   */
+  struct Syntax {
+    /// offset of the first character that does not fit
+    std::size_t offset;
+  };
+
+  /**
+     Errors that can occur when transcoding
+   */
+  using JsonError = std::variant<Malformed, Syntax>;
+
+} // namespace json_error
+
+/// @copydoc json_error::JsonError
+using json_error::JsonError;
+
+/**
+   Receives JSON text in chunks; each chunk ends at a line boundary.
+ */
+using JsonSink = std::function<void(std::u8string_view chunk)>;
+
+/**
+   Transcodes the CBOR item at the start of `bytes` to JSON, appending
+   to `out`, and returns the number of bytes read.
+
+   The item is read in place, without building a `CBORValue`, and
+   converted as RFC 8949 §6.1 recommends:
+
+   - integers and finite floats become numbers, formatted with
+     `std::to_chars` (shortest round-trip form for floats); infinities
+     and NaN become `null`;
+   - byte strings become base64url strings without padding, or base64
+     with padding, or base16 within tags 22 and 23 respectively;
+   - text strings are escaped as JSON requires;
+   - bignums (tags 2 and 3) become base64url strings of their bytes,
+     prefixed with `~` if negative;
+   - map keys that do not convert to JSON strings are converted to
+     strings holding their JSON text, e.g. `1` becomes `"1"`;
+   - `false`, `true` and `null` stay as they are; all other simple
+     values become `null`;
+   - other tags are dropped, keeping their content.
+
+   On error, `out` may hold part of the item.
+ */
+auto transcode_json(std::span<std::byte const> bytes, std::u8string& out)
+    -> std::expected<std::size_t, JsonError>;
+
+/**
+   Transcodes the CBOR sequence (RFC 8742) `sequence` to JSON Lines,
+   one line per item, and returns the number of items.
+
+   Output is collected in a buffer, and passed to `sink` whenever the
+   buffer exceeds `chunk_size` bytes and at the end. On error, `sink`
+   has received the lines of all items before the malformed one.
+ */
+auto transcode_json_lines(std::span<std::byte const> sequence,
+                          JsonSink const& sink,
+                          std::size_t chunk_size = 64 * 1024)
+    -> std::expected<std::size_t, JsonError>;
+
+/**
+   Appends the base64url encoding of `bytes` to `out`, without
+   padding, see RFC 4648 §5. Uses SSSE3 where available.
+ */
+void append_base64url(std::span<std::byte const> bytes, std::u8string& out);
+
+/**
+   Appends `text` to `out` as the content of a JSON string, i.e.
+   escaping quotation marks, reverse solidi, and control characters.
+   Runs of characters that need no escaping are found 16 bytes at a
+   time with SSE2 or NEON.
+ */
+void append_json_escaped(std::u8string_view text, std::u8string& out);
+
+/**
+   Length encoding of the arrays and maps written by `parse_json`
+ */
+enum class JsonContainers {
+  /**
+     Indefinite lengths: each container is written as soon as it is
+     parsed, and closed with a "break".
+   */
+  Indefinite,
+  /**
+     Definite lengths, for decoders that lack support for indefinite
+     lengths: each head is inserted in front of its content once the
+     container is complete, moving the content.
+   */
+  Definite,
+};
+
+/**
+   Parses the JSON text `text`, which must hold exactly one value,
+   and appends its CBOR encoding to `out`, without building a DOM.
+
+   Integers become major type 0 or 1 where they fit, and floats
+   otherwise; floats use the shortest width that preserves the value,
+   down to half precision. Strings are scanned 16 bytes at a time for
+   the closing quotation mark, and copied with a single head when they
+   contain no escapes. Strings are not checked to be valid UTF-8.
+
+   On error, `out` is left as it was.
+ */
+auto parse_json(std::u8string_view text, std::vector<std::byte>& out,
+                JsonContainers containers = JsonContainers::Indefinite)
+    -> std::expected<void, JsonError>;
+
+/**
+   Parses JSON Lines, one value per line, and appends them to `out`
+   as a CBOR sequence (RFC 8742). Returns the number of values; blank
+   lines are skipped.
+
+   On error, `out` holds the items of all lines before the invalid
+   one.
+ */
+auto parse_json_lines(std::u8string_view text, std::vector<std::byte>& out,
+                      JsonContainers containers = JsonContainers::Indefinite)
+    -> std::expected<std::size_t, JsonError>;
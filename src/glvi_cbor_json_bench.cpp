@@ -0,0 +1,97 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_json.h"
+#include "glvi_cbor_parser.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+   Measures the throughput of `transcode_json_lines` on a sequence of
+   telemetry records, of `decode` on the same records for comparison,
+   and of `parse_json_lines` on the resulting JSON Lines. Build with `make glvi_cbor_json_bench`.
+ */
+
+using namespace std::chrono;
+
+namespace {
+
+  constexpr std::size_t count = 200'000;
+
+  auto records() -> std::vector<std::vector<std::byte>> {
+    std::vector<std::vector<std::byte>> items;
+    items.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      CBORMap record;
+      record.insert(u8"seq"_cbor_tstr, CBORUint(CBOR_U64(i)));
+      record.insert(u8"source"_cbor_tstr,
+                    u8"sensor/front-left \"primary\""_cbor_tstr);
+      record.insert(u8"value"_cbor_tstr, CBORFloat{0.1 * static_cast<double>(i)});
+      std::vector<std::byte> raw(24 + i % 16);
+      for (std::size_t j = 0; j < raw.size(); ++j)
+        raw[j] = static_cast<std::byte>(i * 31 + j);
+      record.insert(u8"raw"_cbor_tstr, CBORBstr(std::move(raw)));
+      items.push_back(encode(record));
+    }
+    return items;
+  }
+
+  template <typename F>
+  void measure(char const* name, std::size_t bytes, F&& f) {
+    auto const start = steady_clock::now();
+    auto const checksum = f();
+    auto const elapsed = duration<double>(steady_clock::now() - start);
+    std::printf("%-24s %8.1f MB/s  (checksum %zu)\n", name,
+                bytes / elapsed.count() / 1e6, checksum);
+  }
+
+} // namespace
+
+int main() {
+  auto const items = records();
+  std::vector<std::byte> sequence;
+  for (auto const& item : items)
+    sequence.insert(sequence.end(), item.begin(), item.end());
+
+  measure("transcode_json_lines", sequence.size(), [&] {
+    std::size_t sum = 0;
+    (void)transcode_json_lines(
+        sequence, [&](std::u8string_view chunk) { sum += chunk.size(); });
+    return sum;
+  });
+  measure("decode", sequence.size(), [&] {
+    std::size_t sum = 0;
+    for (auto const& item : items) {
+      auto const octets = std::span(
+          reinterpret_cast<std::uint8_t const*>(item.data()), item.size());
+      sum += decode(octets).has_value();
+    }
+    return sum;
+  });
+
+  std::u8string lines;
+  (void)transcode_json_lines(
+      sequence, [&](std::u8string_view chunk) { lines += chunk; });
+  measure("parse_json_lines", lines.size(), [&] {
+    std::vector<std::byte> out;
+    out.reserve(sequence.size());
+    return parse_json_lines(lines, out).value_or(0);
+  });
+  return 0;
+}
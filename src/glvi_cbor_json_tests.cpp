@@ -0,0 +1,253 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_json.h"
+#include <dejagnu.h>
+#include <source_location>
+#include <string>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+
+  auto bytes(std::initializer_list<int> octets) -> std::vector<std::byte> {
+    std::vector<std::byte> result;
+    for (auto octet : octets) result.push_back(static_cast<std::byte>(octet));
+    return result;
+  }
+
+  auto to_json(std::vector<std::byte> const& input) -> std::u8string {
+    std::u8string out;
+    if (transcode_json(input, out) != input.size()) return u8"<error>";
+    return out;
+  }
+
+} // namespace
+
+class CBORJsonTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(transcode_items)
+  {
+    // {"a": [1, -1, -18446744073709551616, 1.5, Infinity, true, false,
+    //        null, undefined], 1: h'fbff', "s": "q\"\\\n\u0001é"}
+    auto const input = bytes({
+        0xa3, 0x61, 'a', 0x89, 0x01, 0x20, 0x3b, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xf9, 0x3e, 0x00, 0xf9, 0x7c, 0x00, 0xf5,
+        0xf4, 0xf6, 0xf7, 0x01, 0x42, 0xfb, 0xff, 0x61, 's', 0x67, 'q',
+        '"', '\\', '\n', 0x01, 0xc3, 0xa9,
+    });
+    if (to_json(input) ==
+        u8"{\"a\":[1,-1,-18446744073709551616,1.5,null,true,false,null,null],"
+        u8"\"1\":\"-_8\",\"s\":\"q\\\"\\\\\\n\\u0001é\"}") {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(transcode_tags_and_indefinite)
+  {
+    // 22([h'fbff', 21(h'fbff'), 23(h'01ab')]), 0("x"), (_ h'fb', h'ff'),
+    // [_ 1], {[1]: 2}; bignums as in RFC 8949 §6.1
+    if (to_json(bytes({0xd6, 0x83, 0x42, 0xfb, 0xff, 0xd5, 0x42, 0xfb,
+                       0xff, 0xd7, 0x42, 0x01, 0xab})) ==
+            u8"[\"+/8=\",\"-_8\",\"01AB\"]" and
+        to_json(bytes({0xc0, 0x61, 'x'})) == u8"\"x\"" and
+        to_json(bytes({0x5f, 0x41, 0xfb, 0x41, 0xff, 0xff})) ==
+            u8"\"-_8\"" and
+        to_json(bytes({0x9f, 0x01, 0xff})) == u8"[1]" and
+        to_json(bytes({0xa1, 0x81, 0x01, 0x02})) == u8"{\"[1]\":2}" and
+        // 2(h'fbff'), 3(h'fbff'), 3((_ h'fb', h'ff')) and 3(1)
+        to_json(bytes({0xc2, 0x42, 0xfb, 0xff})) == u8"\"-_8\"" and
+        to_json(bytes({0xc3, 0x42, 0xfb, 0xff})) == u8"\"~-_8\"" and
+        to_json(bytes({0xc3, 0x5f, 0x41, 0xfb, 0x41, 0xff, 0xff})) ==
+            u8"\"~-_8\"" and
+        to_json(bytes({0xc3, 0x01})) == u8"1") {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(base64url_and_escape_match_scalar)
+  {
+    constexpr char8_t alphabet[] =
+        u8"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::vector<std::byte> data;
+    std::uint32_t state = 1;
+    for (std::size_t n = 0; n < 100; ++n) {
+      std::u8string expected;
+      for (std::size_t i = 0; i < n; i += 3) {
+        std::uint32_t group = 0;
+        for (std::size_t j = 0; j < 3; ++j)
+          group = group << 8 |
+                  (i + j < n ? std::to_integer<std::uint32_t>(data[i + j])
+                             : 0);
+        auto const chars = std::min<std::size_t>(4, (n - i) * 4 / 3 + 1);
+        for (std::size_t j = 0; j < chars; ++j)
+          expected += alphabet[(group >> (18 - 6 * j)) & 0x3f];
+      }
+      std::u8string actual;
+      append_base64url(data, actual);
+      if (actual != expected)
+        return fail(std::source_location::current().function_name());
+      state = state * 1103515245 + 12345;
+      data.push_back(static_cast<std::byte>(state >> 16));
+    }
+    // a special character at every position of a long string
+    for (std::size_t at = 0; at < 40; ++at) {
+      std::u8string text(40, u8'x');
+      text[at] = at % 2 ? u8'"' : u8'\x1f';
+      std::u8string expected(40, u8'x');
+      expected.replace(at, 1, at % 2 ? u8"\\\"" : u8"\\u001f");
+      std::u8string actual;
+      append_json_escaped(text, actual);
+      if (actual != expected)
+        return fail(std::source_location::current().function_name());
+    }
+    return pass(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(transcode_sequence_to_lines)
+  {
+    std::u8string lines;
+    std::size_t chunks = 0;
+    auto const sink = [&](std::u8string_view chunk) {
+      lines += chunk;
+      chunks += 1;
+    };
+    auto const count =
+        transcode_json_lines(bytes({0x01, 0x82, 0x02, 0x03, 0x61, 'x'}),
+                             sink, 1);
+    auto const good_lines = lines == u8"1\n[2,3]\n\"x\"\n" and chunks == 3;
+    lines.clear();
+    // the break is not an item; the lines before it are delivered
+    auto const bad = transcode_json_lines(bytes({0x01, 0x02, 0xff}), sink);
+    std::u8string out;
+    auto const truncated = transcode_json(bytes({0x82, 0x01}), out);
+    if (count == 3 and good_lines and not bad and
+        std::get<json_error::Malformed>(bad.error()).offset == 2 and
+        lines == u8"1\n2\n" and not truncated) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(parse_json_to_cbor)
+  {
+    std::u8string_view const text =
+        u8" {\"a\": [1, -1, 1.5, 100000.0, 1e400, -0, true, null],\n"
+        u8"  \"s\": \"x\\\"\\u00e9\\ud83d\\ude00\"} ";
+    auto const content = bytes({
+        0x61, 'a', 0x01, 0x20, 0xf9, 0x3e, 0x00, 0xfa, 0x47, 0xc3, 0x50,
+        0x00, 0xf9, 0x7c, 0x00, 0x00, 0xf5, 0xf6,
+    });
+    auto const string = bytes({0x61, 's', 0x68, 'x', '"', 0xc3, 0xa9, 0xf0,
+                               0x9f, 0x98, 0x80});
+    auto indefinite = bytes({0xbf});
+    indefinite.insert(indefinite.end(), content.begin(), content.begin() + 2);
+    indefinite.push_back(std::byte{0x9f});
+    indefinite.insert(indefinite.end(), content.begin() + 2, content.end());
+    indefinite.push_back(std::byte{0xff});
+    indefinite.insert(indefinite.end(), string.begin(), string.end());
+    indefinite.push_back(std::byte{0xff});
+    auto definite = bytes({0xa2});
+    definite.insert(definite.end(), content.begin(), content.begin() + 2);
+    definite.push_back(std::byte{0x88});
+    definite.insert(definite.end(), content.begin() + 2, content.end());
+    definite.insert(definite.end(), string.begin(), string.end());
+    auto const number = [](std::u8string_view text) {
+      std::vector<std::byte> out;
+      return parse_json(text, out) ? out : bytes({});
+    };
+    // integers beyond 64 bits, and doubles beyond either end
+    auto const extremes =
+        number(u8"-18446744073709551616") ==
+            bytes({0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}) and
+        number(u8"18446744073709551616") == bytes({0xfa, 0x5f, 0x80, 0, 0}) and
+        number(u8"-1e400") == bytes({0xf9, 0xfc, 0x00}) and
+        number(u8"0.0001e-400") == bytes({0xf9, 0x00, 0x00}) and
+        number(u8"-1E-99999999999999999999") == bytes({0xf9, 0x80, 0x00}) and
+        number(u8"100e+99999999999999999999") == bytes({0xf9, 0x7c, 0x00});
+    std::vector<std::byte> out, out_definite, round_trip;
+    auto const compact = std::u8string_view(u8"{\"k\":[\"v\",{},[],0.5,-7]}");
+    std::u8string json;
+    if (extremes and parse_json(text, out) and out == indefinite and
+        parse_json(text, out_definite, JsonContainers::Definite) and
+        out_definite == definite and parse_json(compact, round_trip) and
+        transcode_json(round_trip, json) and json == compact) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(parse_json_rejects)
+  {
+    auto const offset = [](std::u8string_view text) -> std::size_t {
+      std::vector<std::byte> out;
+      auto const result = parse_json(text, out);
+      if (result or not out.empty()) return 1000;
+      return std::get<json_error::Syntax>(result.error()).offset;
+    };
+    std::vector<std::byte> out;
+    auto const lines =
+        parse_json_lines(u8"1\n[2]\n\n {\"a\":3} \n[", out);
+    auto const good = parse_json_lines(u8"1\r\n\"x\"\n", out);
+    if (offset(u8"[1,]") == 3 and offset(u8"{\"a\" 1}") == 5 and
+        offset(u8"\"abc") == 4 and offset(u8"01") == 1 and
+        offset(u8"\"\\ud800\"") == 1 and offset(u8"nul") == 0 and
+        not lines and
+        std::get<json_error::Syntax>(lines.error()).offset == 18 and
+        good == 2 and
+        out == bytes({0x01, 0x9f, 0x02, 0xff, 0xbf, 0x61, 'a', 0x03, 0xff,
+                      0x01, 0x61, 'x'})) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORJsonTests testSuite{};
+  testSuite.test_transcode_items();
+  testSuite.test_transcode_tags_and_indefinite();
+  testSuite.test_base64url_and_escape_match_scalar();
+  testSuite.test_transcode_sequence_to_lines();
+  testSuite.test_parse_json_to_cbor();
+  testSuite.test_parse_json_rejects();
+  return testSuite.failure();
+}
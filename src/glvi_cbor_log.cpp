@@ -0,0 +1,480 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "config.h"
+#include "glvi_cbor_log.h"
+#include "glvi_cbor_constant.h"
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_head.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+
+#if HAVE_IMMINTRIN_H && defined(__x86_64__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define GLVI_CBOR_CRC32C_SSE42 1
+#include <immintrin.h>
+#endif
+
+using namespace log_format;
+
+namespace {
+  auto system_error() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::error_code(errno, std::system_category()));
+  }
+
+  auto not_a_log() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+  }
+
+  auto closed_log() -> std::unexpected<std::error_code> {
+    return std::unexpected(
+        std::make_error_code(std::errc::bad_file_descriptor));
+  }
+
+  // 55799("GLVI CBOR LOG 1")
+  constexpr std::string_view magic = "\xd9\xd9\xf7\x6fGLVI CBOR LOG 1";
+
+  auto header() noexcept -> std::span<std::byte const> {
+    return std::as_bytes(std::span(magic));
+  }
+
+  // CRC32C (Castagnoli, reflected polynomial 0x82f63b78), eight bytes
+  // per step with eight tables
+  constexpr auto crc32c_tables = [] {
+    std::array<std::array<std::uint32_t, 256>, 8> tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+      auto c = i;
+      for (int k = 0; k < 8; ++k) c = c & 1 ? (c >> 1) ^ 0x82f63b78 : c >> 1;
+      tables[0][i] = c;
+    }
+    for (std::size_t k = 1; k < 8; ++k)
+      for (std::size_t i = 0; i < 256; ++i)
+        tables[k][i] = (tables[k - 1][i] >> 8) ^
+                       tables[0][tables[k - 1][i] & 0xff];
+    return tables;
+  }();
+
+  auto crc32c_tables_update(std::uint32_t c, std::byte const* p,
+                            std::size_t n) noexcept -> std::uint32_t {
+    auto const& t = crc32c_tables;
+    auto const at = [&p](std::size_t i) {
+      return std::to_integer<std::uint32_t>(p[i]);
+    };
+    for (; n >= 8; n -= 8, p += 8) {
+      c ^= at(0) | at(1) << 8 | at(2) << 16 | at(3) << 24;
+      c = t[7][c & 0xff] ^ t[6][(c >> 8) & 0xff] ^ t[5][(c >> 16) & 0xff] ^
+          t[4][c >> 24] ^ t[3][at(4)] ^ t[2][at(5)] ^ t[1][at(6)] ^
+          t[0][at(7)];
+    }
+    for (; n > 0; --n, ++p)
+      c = (c >> 8) ^ t[0][(c ^ std::to_integer<std::uint32_t>(*p)) & 0xff];
+    return c;
+  }
+
+#if GLVI_CBOR_CRC32C_SSE42
+
+  __attribute__((target("sse4.2"))) auto
+  crc32c_sse42_update(std::uint32_t c, std::byte const* p,
+                      std::size_t n) noexcept -> std::uint32_t {
+    std::uint64_t c64 = c;
+    for (; n >= 8; n -= 8, p += 8) {
+      std::uint64_t word;
+      std::memcpy(&word, p, 8);
+      c64 = _mm_crc32_u64(c64, word);
+    }
+    c = static_cast<std::uint32_t>(c64);
+    for (; n > 0; --n, ++p)
+      c = _mm_crc32_u8(c, std::to_integer<std::uint8_t>(*p));
+    return c;
+  }
+
+  auto has_sse42() noexcept -> bool {
+    static bool const supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+  }
+
+#endif
+
+  /**
+     Extends the CRC32C `crc` of some bytes by `bytes`; 0 for none.
+   */
+  auto crc32c(std::uint32_t crc, std::span<std::byte const> bytes) noexcept
+      -> std::uint32_t {
+#if GLVI_CBOR_CRC32C_SSE42
+    if (has_sse42())
+      return ~crc32c_sse42_update(~crc, bytes.data(), bytes.size());
+#endif
+    return ~crc32c_tables_update(~crc, bytes.data(), bytes.size());
+  }
+
+  auto load_be(std::byte const* p) noexcept -> std::uint64_t {
+    std::uint64_t n = 0;
+    for (std::size_t i = 0; i < 8; ++i)
+      n = (n << 8) | std::to_integer<std::uint64_t>(p[i]);
+    return n;
+  }
+
+  void append_uint(std::vector<std::byte>& out, std::uint64_t n,
+                   std::size_t width) {
+    out.push_back(std::byte(width == 8 ? 27 : 26));
+    for (auto shift = 8 * width; shift > 0; shift -= 8)
+      out.push_back(std::byte(n >> (shift - 8)));
+  }
+
+  void append_head(std::vector<std::byte>& out, MajorType major,
+                   std::uint64_t arg) {
+    std::byte head[9];
+    auto const end = write_head(head, major, arg);
+    out.insert(out.end(), head, end);
+  }
+
+  /**
+     Reader of the fixed layout of index items, footer and trailer
+   */
+  struct Cursor {
+    std::span<std::byte const> bytes;
+    std::size_t pos;
+
+    auto head(MajorType major) -> std::optional<ItemHead> {
+      if (pos > bytes.size()) return std::nullopt;
+      auto const head = read_head(bytes.subspan(pos));
+      if (not head or head->major != major or head->is_indefinite())
+        return std::nullopt;
+      pos += head->size;
+      return head;
+    }
+
+    auto tag(std::uint64_t tag) -> bool {
+      auto const head = this->head(MajorType::Tag);
+      return head and head->arg == tag;
+    }
+
+    auto array() -> std::optional<std::uint64_t> {
+      auto const head = this->head(MajorType::Array);
+      if (not head) return std::nullopt;
+      return head->arg;
+    }
+
+    auto uint(std::size_t width) -> std::optional<std::uint64_t> {
+      auto const head = this->head(MajorType::Uint);
+      if (not head or head->size != 1 + width) return std::nullopt;
+      return head->arg;
+    }
+  };
+
+  /**
+     Index item at `offset`: the number of its first record, its
+     offsets at `entries`, and its end.
+   */
+  struct Index {
+    std::uint64_t first;
+    std::uint64_t size;
+    std::size_t entries;
+    std::size_t end;
+  };
+
+  /**
+     Reads the index item at `offset` of a block starting at `start`,
+     and checks its crc.
+   */
+  auto read_index(std::span<std::byte const> bytes, std::size_t start,
+                  std::size_t offset) -> std::optional<Index> {
+    Cursor in{bytes, offset};
+    if (not in.tag(log_index_tag) or in.array() != 3) return std::nullopt;
+    auto const first = in.uint(8);
+    auto const size = in.array();
+    if (not first or not size or *size > (bytes.size() - in.pos) / 9)
+      return std::nullopt;
+    auto const entries = in.pos;
+    in.pos += *size * 9;
+    auto const crc_pos = in.pos;
+    auto const crc = in.uint(4);
+    if (not crc or
+        *crc != crc32c(0, bytes.subspan(start, crc_pos - start)))
+      return std::nullopt;
+    return Index{*first, *size, entries, in.pos};
+  }
+
+  /**
+     Reads the footer ending before the trailer, and returns the
+     record count.
+   */
+  auto read_footer(std::span<std::byte const> bytes,
+                   std::vector<LogBlock>& blocks)
+      -> std::optional<std::uint64_t> {
+    if (bytes.size() < trailer_size) return std::nullopt;
+    auto const trailer = bytes.size() - trailer_size;
+    Cursor in{bytes, trailer};
+    if (not in.tag(log_trailer_tag)) return std::nullopt;
+    auto const footer = in.uint(8);
+    if (not footer or in.pos != bytes.size() or *footer >= trailer)
+      return std::nullopt;
+    in.pos = *footer;
+    auto const count = in.tag(log_footer_tag) and in.array() == 3
+                           ? in.uint(8)
+                           : std::nullopt;
+    auto const size = in.array();
+    if (not count or not size or *size % 2 != 0 or
+        *size > (trailer - in.pos) / 9)
+      return std::nullopt;
+    for (std::uint64_t i = 0; i < *size; i += 2) {
+      auto const first = in.uint(8);
+      auto const index = in.uint(8);
+      if (not first or not index) return std::nullopt;
+      blocks.push_back({*first, *index});
+    }
+    auto const crc_pos = in.pos;
+    auto const crc = in.uint(4);
+    if (not crc or in.pos != trailer or
+        *crc != crc32c(0, bytes.subspan(*footer, crc_pos - *footer)))
+      return std::nullopt;
+    return count;
+  }
+} // namespace
+
+auto LogReader::open(char const* path)
+    -> std::expected<LogReader, std::error_code> {
+  auto document = MappedDocument::open(path, MapAdvice::Random);
+  if (not document) return std::unexpected(document.error());
+  LogReader log(*std::move(document));
+  auto const bytes = log.document.bytes();
+  auto const magic = header();
+  if (bytes.size() < magic.size()) {
+    // torn while being created
+    if (std::ranges::equal(bytes, magic.first(bytes.size()))) return log;
+    return not_a_log();
+  }
+  if (not std::ranges::equal(bytes.first(magic.size()), magic))
+    return not_a_log();
+  if (auto const count = read_footer(bytes, log.blockList)) {
+    log.count = *count;
+    log.validSize = Cursor{bytes, bytes.size() - trailer_size + 3}
+                        .uint(8)
+                        .value();
+    log.closed = true;
+    return log;
+  }
+  log.blockList.clear();
+  log.recover(magic.size());
+  return log;
+}
+
+void LogReader::recover(std::size_t start) {
+  auto const bytes = document.bytes();
+  std::vector<std::uint64_t> offsets;
+  validSize = start;
+  for (auto pos = start; pos < bytes.size();) {
+    auto end = pos;
+    if (not constant_encoding::well_formed(bytes, end, 0)) break;
+    auto const head = read_head(bytes.subspan(pos));
+    if (head->major == MajorType::Tag and head->arg == log_index_tag) {
+      auto const index = read_index(bytes, validSize, pos);
+      if (not index or index->first != count or index->size != offsets.size())
+        break;
+      for (std::size_t i = 0; i < offsets.size(); ++i)
+        if (load_be(bytes.data() + index->entries + 9 * i + 1) != offsets[i])
+          return;
+      blockList.push_back({count, pos});
+      count += offsets.size();
+      offsets.clear();
+      validSize = end;
+    } else if (head->major == MajorType::Tag and
+               (head->arg == log_footer_tag or head->arg == log_trailer_tag)) {
+      break;
+    } else {
+      offsets.push_back(pos);
+    }
+    pos = end;
+  }
+}
+
+auto LogReader::record(std::uint64_t n) const
+    -> std::optional<std::span<std::byte const>> {
+  if (n >= count) return std::nullopt;
+  auto const block =
+      std::ranges::upper_bound(blockList, n, {}, &LogBlock::first) - 1;
+  auto const bytes = document.bytes();
+  if (block->index >= bytes.size()) return std::nullopt;
+  // tag head, array head, first record number
+  Cursor in{bytes, static_cast<std::size_t>(block->index)};
+  in.tag(log_index_tag);
+  in.array();
+  in.uint(8);
+  auto const size = in.array();
+  auto const i = n - block->first;
+  if (not size or i >= *size or in.pos + 9 * *size > bytes.size())
+    return std::nullopt;
+  auto const* const entry = bytes.data() + in.pos + 9 * i;
+  auto const start = load_be(entry + 1);
+  auto const end = i + 1 < *size ? load_be(entry + 10) : block->index;
+  if (start >= end or end > block->index) return std::nullopt;
+  return bytes.subspan(start, end - start);
+}
+
+auto LogReader::value(std::uint64_t n) const
+    -> std::expected<CBORValue, ParseError> {
+  auto const item = record(n);
+  if (not item) return std::unexpected(parse_error::Incomplete{});
+  return document.value_at(
+      static_cast<std::size_t>(item->data() - document.bytes().data()));
+}
+
+auto LogWriter::open(char const* path, LogOptions const& options)
+    -> std::expected<LogWriter, std::error_code> {
+  auto const fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+  if (fd < 0) return system_error();
+  auto const existing = LogReader::open(path);
+  if (not existing or
+      ::ftruncate(fd, static_cast<off_t>(existing->valid_size())) != 0) {
+    auto const error = existing ? system_error().error() : existing.error();
+    ::close(fd);
+    return std::unexpected(error);
+  }
+  LogWriter log(fd, options);
+  log.written = existing->valid_size();
+  log.count = existing->size();
+  log.blockList.assign(existing->blocks().begin(), existing->blocks().end());
+  if (log.written == 0) {
+    auto const magic = header();
+    log.buffer.assign(magic.begin(), magic.end());
+  }
+  log.buffer.reserve(options.buffer_size);
+  return log;
+}
+
+LogWriter::LogWriter(LogWriter&& other) noexcept
+    : fd{std::exchange(other.fd, -1)}, options{other.options},
+      blockList{std::move(other.blockList)},
+      offsets{std::move(other.offsets)}, buffer{std::move(other.buffer)},
+      count{other.count}, written{other.written}, crc{other.crc} {}
+
+auto LogWriter::operator=(LogWriter&& other) noexcept -> LogWriter& {
+  if (this != &other) {
+    if (fd >= 0) (void)close();
+    fd = std::exchange(other.fd, -1);
+    options = other.options;
+    blockList = std::move(other.blockList);
+    offsets = std::move(other.offsets);
+    buffer = std::move(other.buffer);
+    count = other.count;
+    written = other.written;
+    crc = other.crc;
+  }
+  return *this;
+}
+
+LogWriter::~LogWriter() {
+  if (fd >= 0) (void)close();
+}
+
+auto LogWriter::append(CBORValue const& value)
+    -> std::expected<std::uint64_t, std::error_code> {
+  return append(encode(value));
+}
+
+auto LogWriter::append(std::span<std::byte const> item)
+    -> std::expected<std::uint64_t, std::error_code> {
+  if (fd < 0) return closed_log();
+  if (not is_well_formed(item)) return not_a_log();
+  if (auto const head = read_head(item);
+      head->major == MajorType::Tag and
+      (head->arg == log_index_tag or head->arg == log_footer_tag or
+       head->arg == log_trailer_tag))
+    return not_a_log();
+  offsets.push_back(end());
+  buffer.insert(buffer.end(), item.begin(), item.end());
+  crc = crc32c(crc, item);
+  auto const number = count++;
+  if (offsets.size() >= options.block_records) end_block();
+  if (buffer.size() >= options.buffer_size) {
+    if (auto flushed = flush(); not flushed)
+      return std::unexpected(flushed.error());
+  }
+  return number;
+}
+
+void LogWriter::end_block() {
+  if (offsets.empty()) return;
+  auto const index = end();
+  auto const start = buffer.size();
+  append_head(buffer, MajorType::Tag, log_index_tag);
+  append_head(buffer, MajorType::Array, 3);
+  append_uint(buffer, count - offsets.size(), 8);
+  append_head(buffer, MajorType::Array, offsets.size());
+  for (auto const offset : offsets) append_uint(buffer, offset, 8);
+  crc = crc32c(crc, std::span(buffer).subspan(start));
+  append_uint(buffer, crc, 4);
+  blockList.push_back({count - offsets.size(), index});
+  offsets.clear();
+  crc = 0;
+}
+
+auto LogWriter::flush() -> std::expected<void, std::error_code> {
+  std::size_t done = 0;
+  while (done < buffer.size()) {
+    auto const n = ::pwrite(fd, buffer.data() + done, buffer.size() - done,
+                            static_cast<off_t>(written + done));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return system_error();
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  written += buffer.size();
+  buffer.clear();
+  return {};
+}
+
+auto LogWriter::commit() -> std::expected<void, std::error_code> {
+  if (fd < 0) return closed_log();
+  end_block();
+  if (auto flushed = flush(); not flushed) return flushed;
+  if (::fdatasync(fd) != 0) return system_error();
+  return {};
+}
+
+auto LogWriter::close() -> std::expected<void, std::error_code> {
+  if (fd < 0) return closed_log();
+  end_block();
+  auto const footer = end();
+  auto const start = buffer.size();
+  append_head(buffer, MajorType::Tag, log_footer_tag);
+  append_head(buffer, MajorType::Array, 3);
+  append_uint(buffer, count, 8);
+  append_head(buffer, MajorType::Array, 2 * blockList.size());
+  for (auto const& block : blockList) {
+    append_uint(buffer, block.first, 8);
+    append_uint(buffer, block.index, 8);
+  }
+  append_uint(buffer, crc32c(0, std::span(buffer).subspan(start)), 4);
+  append_head(buffer, MajorType::Tag, log_trailer_tag);
+  append_uint(buffer, footer, 8);
+  auto result = flush();
+  if (result and ::fdatasync(fd) != 0) result = system_error();
+  if (::close(std::exchange(fd, -1)) != 0 and result) result = system_error();
+  return result;
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_log() {
+  return "GLVI CBOR LOG";
+}
@@ -0,0 +1,230 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_input.h"
+#include "glvi_cbor_mapped.h"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+/**
+   Record log: an append-only file of CBOR records that can be read
+   from any record number without scanning from the start.
+
+   The file is a CBOR sequence (RFC 8742). It starts with
+   55799("GLVI CBOR LOG 1") and holds the records, each a data item,
+   in blocks. Each block ends in an index item
+
+       log_index_tag([first record number, [offset, ...], crc])
+
+   giving the file offset of every record in the block. The CRC32C
+   covers the block from its first record up to the crc itself, so a
+   torn write is detected. A closed log ends in a footer
+
+       log_footer_tag([record count, [first, index offset, ...], crc])
+
+   listing the blocks, followed by the 12-byte trailer
+   `log_trailer_tag(footer offset)`. Numbers in index items, footer
+   and trailer are encoded as uints of fixed width (8 bytes, 4 for
+   crcs), so entries are found by position.
+ */
+namespace log_format {
+  /// tag of an index item, in the first-come-first-served range
+  constexpr std::uint64_t log_index_tag = 0xcb10;
+  /// tag of the footer
+  constexpr std::uint64_t log_footer_tag = 0xcb11;
+  /// tag of the trailer
+  constexpr std::uint64_t log_trailer_tag = 0xcb12;
+  /// size of the trailer: tag head, and a uint of 8 bytes
+  constexpr std::size_t trailer_size = 12;
+} // namespace log_format
+
+/**
+   Block of a record log: the number of its first record, and the
+   offset of its index item.
+ */
+struct LogBlock {
+  std::uint64_t first;
+  std::uint64_t index;
+};
+
+/**
+   Reader of a record log, mapped read-only into memory.
+
+   Opening a closed log reads its footer; a log that was not closed,
+   e.g. after a crash, is scanned block by block with the skipper,
+   up to the last block whose crc matches. Records after it are
+   ignored. Looking up a record takes a binary search over the
+   blocks.
+
+       auto log = LogReader::open(path);
+       for (auto n = from; n < log->size(); ++n) ... log->value(n) ...
+ */
+class LogReader {
+  MappedDocument document;
+  std::vector<LogBlock> blockList;
+  std::uint64_t count = 0;
+  std::size_t validSize = 0;
+  bool closed = false;
+
+  explicit LogReader(MappedDocument document)
+      : document{std::move(document)} {}
+
+  void recover(std::size_t start);
+
+public:
+  /**
+     Opens the log at `path`. An empty file is an empty log. Returns
+     the error reported by the system, or `std::errc::invalid_argument`
+     if the file is not a record log.
+   */
+  static auto open(char const* path)
+      -> std::expected<LogReader, std::error_code>;
+
+  /**
+     Returns the number of records.
+   */
+  auto size() const noexcept -> std::uint64_t { return count; }
+
+  /**
+     Returns the blocks, in file order.
+   */
+  auto blocks() const noexcept -> std::span<LogBlock const> {
+    return blockList;
+  }
+
+  /**
+     Returns whether the log ends in a valid footer.
+   */
+  auto is_closed() const noexcept -> bool { return closed; }
+
+  /**
+     Returns the size of the valid part of the file: up to the footer
+     of a closed log, otherwise up to the end of the last valid block.
+   */
+  auto valid_size() const noexcept -> std::size_t { return validSize; }
+
+  /**
+     Returns the encoded record number `n`, borrowed from the mapping;
+     `std::nullopt` if there is no such record.
+   */
+  auto record(std::uint64_t n) const
+      -> std::optional<std::span<std::byte const>>;
+
+  /**
+     Decodes record number `n`.
+   */
+  auto value(std::uint64_t n) const -> std::expected<CBORValue, ParseError>;
+};
+
+/**
+   Options of `LogWriter`
+ */
+struct LogOptions {
+  /// records per block, at most; `commit` also ends a block
+  std::size_t block_records = 1024;
+  /// bytes buffered before they are written, without syncing
+  std::size_t buffer_size = input_buffer_size_default;
+};
+
+/**
+   Appends records to a record log.
+
+   Records are buffered, and written once the buffer is full. They
+   become durable with `commit`, which ends the block, writes it, and
+   syncs the file once for all records appended since the last
+   commit. `close`, also called on destruction, adds the footer.
+
+       auto log = LogWriter::open(path);
+       for (auto const& event : batch) log->append(event);
+       log->commit();
+
+   After an error, the state of the file is unknown; open it again to
+   recover.
+ */
+class LogWriter {
+  int fd = -1;
+  LogOptions options;
+  std::vector<LogBlock> blockList;
+  /// offsets of the records in the open block
+  std::vector<std::uint64_t> offsets;
+  std::vector<std::byte> buffer;
+  std::uint64_t count = 0;
+  /// file offset of the start of the buffer
+  std::uint64_t written = 0;
+  /// crc of the open block so far
+  std::uint32_t crc = 0;
+
+  LogWriter(int fd, LogOptions const& options) : fd{fd}, options{options} {}
+
+  auto end() const noexcept -> std::uint64_t {
+    return written + buffer.size();
+  }
+  void end_block();
+  auto flush() -> std::expected<void, std::error_code>;
+
+public:
+  /**
+     Opens the log at `path` for appending, creating it if need be.
+     An existing log is recovered as with `LogReader`, and truncated
+     to its valid part, dropping its footer and any torn block.
+     Returns the error reported by the system, or
+     `std::errc::invalid_argument` if the file is not a record log.
+   */
+  static auto open(char const* path, LogOptions const& options = {})
+      -> std::expected<LogWriter, std::error_code>;
+
+  LogWriter(LogWriter&& other) noexcept;
+  auto operator=(LogWriter&& other) noexcept -> LogWriter&;
+  ~LogWriter();
+
+  /**
+     Returns the number of records, including the ones not yet
+     committed.
+   */
+  auto size() const noexcept -> std::uint64_t { return count; }
+
+  /**
+     Appends `value`, and returns its record number.
+   */
+  auto append(CBORValue const& value)
+      -> std::expected<std::uint64_t, std::error_code>;
+
+  /**
+     Appends the encoded record `item`, and returns its record number.
+     Returns `std::errc::invalid_argument` if `item` is not exactly
+     one well-formed data item, or is tagged with one of the tags of
+     `log_format`.
+   */
+  auto append(std::span<std::byte const> item)
+      -> std::expected<std::uint64_t, std::error_code>;
+
+  /**
+     Ends the open block, writes the buffer, and syncs the file.
+   */
+  auto commit() -> std::expected<void, std::error_code>;
+
+  /**
+     Commits, adds the footer, and closes the file. Nothing can be
+     appended afterwards.
+   */
+  auto close() -> std::expected<void, std::error_code>;
+};
@@ -0,0 +1,194 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_log.h"
+#include <cstdio>
+#include <dejagnu.h>
+#include <fcntl.h>
+#include <source_location>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+  /// Name of a temporary file, removed on destruction
+  struct TempPath {
+    char path[32] = "/tmp/glvi_cbor_logXXXXXX";
+    TempPath() { ::close(::mkstemp(path)); }
+    ~TempPath() { ::unlink(path); }
+  };
+
+  /// Record number `i`: [i, "payload"]
+  auto make_record(unsigned i) {
+    CBORArray record;
+    record.push_back(CBORUint(CBOR_U64(i)));
+    record.push_back(u8"payload"_cbor_tstr);
+    return encode(record);
+  }
+
+  /// Whether `log` holds the records made by `make_record` up to `count`
+  auto holds_records(LogReader const& log, unsigned count) -> bool {
+    if (log.size() != count) return false;
+    for (unsigned i = 0; i < count; ++i) {
+      auto const record = log.record(i);
+      auto const value = log.value(i);
+      if (not record or not value or
+          not std::ranges::equal(*record, make_record(i)) or
+          encode(*value) != make_record(i))
+        return false;
+    }
+    return not log.record(count);
+  }
+
+  auto read_file(char const* path) -> std::vector<std::byte> {
+    std::vector<std::byte> bytes(1 << 16);
+    auto const fd = ::open(path, O_RDONLY);
+    bytes.resize(static_cast<std::size_t>(
+        ::read(fd, bytes.data(), bytes.size())));
+    ::close(fd);
+    return bytes;
+  }
+
+  void write_file(char const* path, std::span<std::byte const> bytes) {
+    auto const fd = ::open(path, O_WRONLY | O_TRUNC);
+    (void)::write(fd, bytes.data(), bytes.size());
+    ::close(fd);
+  }
+} // namespace
+
+class CBORLogTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(append_and_seek)
+  {
+    TempPath file;
+    {
+      auto log = LogWriter::open(file.path, {.block_records = 100,
+                                             .buffer_size = 1000});
+      for (unsigned i = 0; i < 250; ++i) log->append(make_record(i));
+      log->commit();
+      for (unsigned i = 250; i < 300; ++i) log->append(make_record(i));
+    }
+    auto const closed = LogReader::open(file.path);
+    // blocks of 100, 100, 50 (committed), 50 (closed)
+    auto const written = closed and closed->is_closed() and
+                         closed->blocks().size() == 4 and
+                         closed->blocks()[3].first == 250 and
+                         holds_records(*closed, 300);
+    {
+      // reopening drops the footer
+      auto log = LogWriter::open(file.path);
+      auto const number = log->append(make_record(300));
+      if (not number or *number != 300 or not log->close())
+        return fail(std::source_location::current().function_name());
+    }
+    auto const appended = LogReader::open(file.path);
+    if (written and appended and appended->is_closed() and
+        holds_records(*appended, 301)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(recover_torn_block)
+  {
+    TempPath file;
+    std::vector<std::byte> crashed;
+    std::size_t first_block = 0;
+    {
+      auto log = LogWriter::open(file.path);
+      for (unsigned i = 0; i < 10; ++i) log->append(make_record(i));
+      log->commit();
+      first_block = read_file(file.path).size();
+      for (unsigned i = 10; i < 20; ++i) log->append(make_record(i));
+      log->commit();
+      // as left by a crash: no footer
+      crashed = read_file(file.path);
+    }
+    // a torn second block is dropped
+    write_file(file.path, std::span(crashed).first(crashed.size() - 3));
+    auto const torn = LogReader::open(file.path);
+    auto const recovered = torn and not torn->is_closed() and
+                           torn->valid_size() == first_block and
+                           holds_records(*torn, 10);
+    // so is one with a flipped bit
+    crashed[first_block + 5] ^= std::byte{0x01};
+    write_file(file.path, crashed);
+    auto const corrupt = LogReader::open(file.path);
+    auto const checked = corrupt and holds_records(*corrupt, 10);
+    // appending truncates to the last valid block
+    {
+      auto log = LogWriter::open(file.path);
+      log->append(make_record(10));
+    }
+    auto const resumed = LogReader::open(file.path);
+    if (recovered and checked and resumed and resumed->is_closed() and
+        holds_records(*resumed, 11)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(reject_foreign_data)
+  {
+    TempPath file;
+    auto log = LogWriter::open(file.path);
+    std::byte const malformed[] = {std::byte{0x82}, std::byte{0x01}};
+    // 0xcb10(0), a reserved tag
+    std::byte const index[] = {std::byte{0xd9}, std::byte{0xcb},
+                               std::byte{0x10}, std::byte{0x00}};
+    auto const rejected =
+        log and
+        log->append(malformed).error() == std::errc::invalid_argument and
+        log->append(index).error() == std::errc::invalid_argument and
+        log->size() == 0;
+    TempPath other;
+    write_file(other.path, make_record(0));
+    auto const reader = LogReader::open(other.path);
+    auto const writer = LogWriter::open(other.path);
+    if (rejected and not reader and
+        reader.error() == std::errc::invalid_argument and not writer and
+        read_file(other.path) == make_record(0)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORLogTests testSuite{};
+  testSuite.test_append_and_seek();
+  testSuite.test_recover_torn_block();
+  testSuite.test_reject_foreign_data();
+  return testSuite.failure();
+}
@@ -15,6 +15,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include "glvi_cbor_map.h"
+#include "glvi_cbor_value.h"
 
 char const * _glvi_cbor_map() {
   return "GLVI CBOR MAP";
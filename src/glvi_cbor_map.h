@@ -23,6 +23,11 @@ struct CBORValue;
 
 /**
    CBOR major type 5: Map of pairs of CBOR values.
+
+   Entries are kept in insertion order, with keys and values
+   alternating in storage. Keys are not checked for uniqueness.
+
+   Member functions are defined in glvi_cbor_value.h, see `CBORArray`.
  */
 class CBORMap {
   using Self = CBORMap;
@@ -38,6 +43,31 @@ public:
   CBORMap& operator=(CBORMap&&) = default;
   CBORMap& operator=(CBORMap const&) = default;
 
+  /**
+     Returns the number of entries, i.e. pairs of key and value.
+   */
+  constexpr size_type size() const noexcept;
+
+  /**
+     Returns the key of entry `i`
+   */
+  constexpr value_type const& key(size_type i) const noexcept;
+
+  /**
+     Returns the value of entry `i`
+   */
+  constexpr value_type const& value(size_type i) const noexcept;
+
+  /**
+     Appends an entry made of `key` and `value`.
+   */
+  constexpr void insert(value_type&& key, value_type&& value);
+
+  /**
+     Reserves storage for `n` entries.
+   */
+  constexpr void reserve(size_type n);
+
 private:
   storage_type entries;
 };
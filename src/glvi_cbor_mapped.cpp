@@ -0,0 +1,157 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_mapped.h"
+#include "glvi_cbor_constant.h"
+#include "glvi_cbor_head.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+  auto system_error() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::error_code(errno, std::system_category()));
+  }
+
+#if HAVE_SYS_MMAN_H
+  constexpr auto to_madvise(MapAdvice advice) noexcept -> int {
+    switch (advice) {
+    case MapAdvice::Sequential: return MADV_SEQUENTIAL;
+    case MapAdvice::Random    : return MADV_RANDOM;
+    case MapAdvice::WillNeed  : return MADV_WILLNEED;
+    default                   : return MADV_NORMAL;
+    }
+  }
+#endif
+} // namespace
+
+#if HAVE_SYS_MMAN_H
+
+auto MappedDocument::open(char const* path, MapAdvice advice)
+    -> std::expected<MappedDocument, std::error_code> {
+  auto const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return system_error();
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    auto error = system_error();
+    ::close(fd);
+    return error;
+  }
+  MappedDocument document;
+  document.length = static_cast<std::size_t>(st.st_size);
+  if (document.length == 0) {
+    // mmap(2) rejects empty mappings
+    ::close(fd);
+    return document;
+  }
+  auto* const address =
+      ::mmap(nullptr, document.length, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file open
+  ::close(fd);
+  if (address == MAP_FAILED) return system_error();
+  document.base = std::shared_ptr<std::byte const>(
+      static_cast<std::byte const*>(address),
+      [length = document.length](std::byte const* p) {
+        ::munmap(const_cast<std::byte*>(p), length);
+      });
+  if (advice != MapAdvice::Normal) {
+    if (auto advised = document.advise(0, document.length, advice);
+        not advised)
+      return std::unexpected(advised.error());
+  }
+  return document;
+}
+
+auto MappedDocument::advise(std::size_t offset, std::size_t length,
+                            MapAdvice advice) const
+    -> std::expected<void, std::error_code> {
+  if (offset >= this->length) return {};
+  // madvise(2) wants an address aligned to a page
+  auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto const first = offset / page * page;
+  length = std::min(length, this->length - offset) + (offset - first);
+  auto* const address = const_cast<std::byte*>(base.get()) + first;
+  if (::madvise(address, length, to_madvise(advice)) != 0)
+    return system_error();
+  return {};
+}
+
+#else
+
+auto MappedDocument::open(char const*, MapAdvice)
+    -> std::expected<MappedDocument, std::error_code> {
+  return std::unexpected(std::make_error_code(std::errc::not_supported));
+}
+
+auto MappedDocument::advise(std::size_t, std::size_t, MapAdvice) const
+    -> std::expected<void, std::error_code> {
+  return {};
+}
+
+#endif
+
+auto MappedDocument::next(std::size_t& pos) const
+    -> std::optional<std::span<std::byte const>> {
+  auto end = pos;
+  if (pos >= length or not constant_encoding::well_formed(bytes(), end, 0))
+    return std::nullopt;
+  auto const item = bytes().subspan(pos, end - pos);
+  pos = end;
+  return item;
+}
+
+auto MappedDocument::value_at(std::size_t offset) const
+    -> std::expected<CBORValue, ParseError> {
+  auto pos = offset;
+  auto const item = next(pos);
+  if (not item) return std::unexpected(parse_error::Incomplete{});
+  Parser parser;
+  auto rest = *item;
+  auto result = parser.consume(rest);
+  if (result.is_complete()) return std::move(result.as_complete().value);
+  if (result.is_error()) return std::unexpected(std::move(result.as_error()));
+  return std::unexpected(parse_error::Incomplete{});
+}
+
+auto MappedDocument::view_at(std::size_t offset) const
+    -> std::optional<EmbeddedCBOR> {
+  auto pos = offset;
+  if (auto const item = next(pos)) return EmbeddedCBOR(*item);
+  return std::nullopt;
+}
+
+auto MappedDocument::string_at(std::size_t offset) const
+    -> std::optional<MappedString> {
+  if (offset >= length) return std::nullopt;
+  auto const head = read_head(bytes().subspan(offset));
+  if (not head or head->is_indefinite() or
+      (head->major != MajorType::Bstr and head->major != MajorType::Tstr))
+    return std::nullopt;
+  auto const start = offset + head->size;
+  if (head->arg > length - start) return std::nullopt;
+  return MappedString(base, bytes().subspan(start, head->arg),
+                      head->major == MajorType::Tstr);
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_mapped() {
+  return "GLVI CBOR MAPPED";
+}
@@ -0,0 +1,144 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_embedded.h"
+#include "glvi_cbor_parser.h"
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+/**
+   How a mapping is going to be accessed, passed to `madvise(2)`.
+ */
+enum class MapAdvice {
+  /// no advice
+  Normal,
+  /// front to back, e.g. when scanning a whole archive
+  Sequential,
+  /// at random offsets, e.g. through an index
+  Random,
+  /// soon, so the kernel should read ahead now
+  WillNeed,
+};
+
+/**
+   Definite-length byte or text string in a `MappedDocument`, borrowed
+   from the mapping; the view keeps the mapping alive.
+ */
+class MappedString {
+  std::shared_ptr<std::byte const> owner;
+  std::span<std::byte const> payload;
+  bool text;
+
+public:
+  MappedString(std::shared_ptr<std::byte const> owner,
+               std::span<std::byte const> payload, bool text)
+      : owner{std::move(owner)}, payload{payload}, text{text} {}
+
+  /**
+     Returns whether the string is a text string.
+   */
+  auto is_text() const noexcept -> bool { return text; }
+
+  /**
+     Returns the payload of the string.
+   */
+  auto bytes() const noexcept -> std::span<std::byte const> {
+    return payload;
+  }
+
+  /**
+     Returns the payload as text; not validated as UTF-8.
+   */
+  auto view() const noexcept -> std::u8string_view {
+    return {reinterpret_cast<char8_t const*>(payload.data()),
+            payload.size()};
+  }
+};
+
+/**
+   File mapped read-only into memory, e.g. a multi-GB archive of a
+   CBOR sequence (RFC 8742), scanned and accessed in place rather than
+   read into heap buffers first.
+
+   `bytes()` gives the parser, the skipper (`next`) and lazy views
+   (`view_at`) direct access to the mapping. The mapping stays alive
+   as long as the document, its copies, or a `MappedString` do.
+
+       auto document = MappedDocument::open(path, MapAdvice::Sequential);
+       for (std::size_t pos = 0; auto item = document->next(pos);) ...
+ */
+class MappedDocument {
+  std::shared_ptr<std::byte const> base;
+  std::size_t length = 0;
+
+  MappedDocument() = default;
+
+public:
+  /**
+     Maps the file at `path` read-only, advising the kernel of the
+     expected access with `advice`. Returns the error reported by the
+     system, if any; `std::errc::not_supported` without `mmap(2)`.
+   */
+  static auto open(char const* path, MapAdvice advice = MapAdvice::Normal)
+      -> std::expected<MappedDocument, std::error_code>;
+
+  /**
+     Returns the contents of the file.
+   */
+  auto bytes() const noexcept -> std::span<std::byte const> {
+    return {base.get(), length};
+  }
+
+  /**
+     Advises the kernel of the expected access to `length` bytes at
+     `offset`, e.g. `MapAdvice::WillNeed` before reading a region.
+   */
+  auto advise(std::size_t offset, std::size_t length, MapAdvice advice) const
+      -> std::expected<void, std::error_code>;
+
+  /**
+     Returns the well-formed item at `pos` and advances `pos` past it,
+     without decoding it; `std::nullopt` at the end of the document or
+     at a malformed item, where `pos` is left unchanged.
+   */
+  auto next(std::size_t& pos) const
+      -> std::optional<std::span<std::byte const>>;
+
+  /**
+     Decodes the item at `offset`.
+   */
+  auto value_at(std::size_t offset) const
+      -> std::expected<CBORValue, ParseError>;
+
+  /**
+     Returns a lazy view of the item at `offset`, decoded on first
+     access. The view borrows the mapping, so the document must
+     outlive it.
+   */
+  auto view_at(std::size_t offset) const -> std::optional<EmbeddedCBOR>;
+
+  /**
+     Returns the definite-length string at `offset`, borrowed from the
+     mapping.
+   */
+  auto string_at(std::size_t offset) const -> std::optional<MappedString>;
+};
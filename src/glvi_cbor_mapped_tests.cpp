@@ -0,0 +1,116 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_mapped.h"
+#include <cstdio>
+#include <dejagnu.h>
+#include <source_location>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+  /// Temporary file, removed on destruction
+  struct TempFile {
+    char path[32] = "/tmp/glvi_cbor_mappedXXXXXX";
+    explicit TempFile(std::span<std::byte const> contents) {
+      auto const fd = ::mkstemp(path);
+      (void)::write(fd, contents.data(), contents.size());
+      ::close(fd);
+    }
+    ~TempFile() { ::unlink(path); }
+  };
+} // namespace
+
+class CBORMappedTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(scan_mapped_sequence)
+  {
+    // [1, "abc"], "hello", h'0102'
+    std::vector<std::byte> sequence;
+    for (int byte : {0x82, 0x01, 0x63, 0x61, 0x62, 0x63, 0x65, 0x68, 0x65,
+                     0x6c, 0x6c, 0x6f, 0x42, 0x01, 0x02})
+      sequence.push_back(std::byte(byte));
+    TempFile file(sequence);
+    auto document = MappedDocument::open(file.path, MapAdvice::Sequential);
+    if (not document)
+      return fail(std::source_location::current().function_name());
+    std::vector<std::size_t> offsets;
+    std::size_t pos = 0;
+    for (auto before = pos; document->next(pos); before = pos)
+      offsets.push_back(before);
+    auto const split = offsets == std::vector<std::size_t>{0, 6, 12} and
+                       pos == sequence.size();
+    auto const value = document->value_at(0);
+    auto const decoded = value and encode(*value) ==
+                                       std::vector(sequence.begin(),
+                                                   sequence.begin() + 6);
+    auto const view = document->view_at(12);
+    auto const lazy = view and not view->is_decoded() and
+                      view->bytes().data() == document->bytes().data() + 12 and
+                      view->value();
+    // strings borrow from the mapping, and keep it alive
+    std::optional<MappedString> text;
+    {
+      auto const scoped = MappedDocument::open(file.path);
+      text = scoped->string_at(6);
+    }
+    auto const borrowed = text and text->is_text() and
+                          text->view() == u8"hello";
+    if (split and decoded and lazy and borrowed and
+        not MappedDocument::open(file.path)->string_at(0)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(map_empty_and_missing)
+  {
+    TempFile file(std::span<std::byte const>{});
+    auto const empty = MappedDocument::open(file.path, MapAdvice::Random);
+    std::size_t pos = 0;
+    auto const missing = MappedDocument::open("/nonexistent/archive.cbor");
+    if (empty and empty->bytes().empty() and not empty->next(pos) and
+        empty->advise(0, 4096, MapAdvice::WillNeed) and not missing and
+        missing.error() == std::errc::no_such_file_or_directory) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORMappedTests testSuite{};
+  testSuite.test_scan_mapped_sequence();
+  testSuite.test_map_empty_and_missing();
+  return testSuite.failure();
+}
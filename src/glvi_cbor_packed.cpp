@@ -0,0 +1,518 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_packed.h"
+#include "glvi_cbor_encoder.h"
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+  template <typename... Ts> struct adhoc : Ts... {
+    using Ts::operator()...;
+  };
+  template <typename... Ts> adhoc(Ts...) -> adhoc<Ts...>;
+
+  /**
+     What an item in a packed rump or table refers to, if anything
+   */
+  struct Reference {
+    enum class Kind { None, Shared, Straight, Inverted };
+    Kind kind = Kind::None;
+    std::size_t index = 0;
+    /// content of argument references
+    CBORValue const* content = nullptr;
+  };
+
+  /**
+     Reference to shared item `first + 2k`; beyond any table if that
+     does not fit in `std::size_t`.
+   */
+  auto shared_reference(std::size_t first, std::uint64_t k) -> Reference {
+    constexpr auto none = std::numeric_limits<std::size_t>::max();
+    if (k > (none - 17) / 2) return {Reference::Kind::Shared, none};
+    return {Reference::Kind::Shared, first + 2 * static_cast<std::size_t>(k)};
+  }
+
+  auto classify(CBORValue const& item) -> Reference {
+    using Kind = Reference::Kind;
+    return item.visit(adhoc{
+        [](CBORSimple const& x) -> Reference {
+          auto const n = static_cast<std::uint8_t>(x);
+          if (n > packed_simple_max) return {};
+          return {Kind::Shared, n};
+        },
+        [](CBORTag const& x) -> Reference {
+          auto const n = static_cast<std::uint64_t>(x.tag());
+          auto const& content = x.value();
+          if (n == packed_reference_tag) {
+            if (auto const k = content.as_uint())
+              return shared_reference(16, static_cast<std::uint64_t>(*k));
+            if (auto const k = content.as_nint())
+              return shared_reference(17, static_cast<std::uint64_t>(*k));
+            return {Kind::Straight, 0, &content};
+          }
+          if (n >= 224 and n <= 255) return {Kind::Straight, n - 224, &content};
+          if (n >= 216 and n <= 223) return {Kind::Inverted, n - 216, &content};
+          return {};
+        },
+        [](auto const&) -> Reference { return {}; },
+    });
+  }
+
+  /**
+     Combines the argument `prefix` with the content `suffix` of an
+     argument reference.
+   */
+  auto combine(CBORValue&& prefix, CBORValue&& suffix)
+      -> std::expected<CBORValue, PackedError> {
+    auto const bad = std::unexpected(packed_error::BadReference{});
+    if (auto a = prefix.as_tstr_cref()) {
+      auto b = suffix.as_tstr_cref();
+      if (not b) return bad;
+      std::u8string text(a->get().data(), a->get().size());
+      text.append(b->get().data(), b->get().size());
+      return CBORTstr(std::move(text));
+    }
+    if (auto a = prefix.as_bstr_cref()) {
+      auto b = suffix.as_bstr_cref();
+      if (not b) return bad;
+      std::vector<std::byte> bytes(a->get().data(),
+                                   a->get().data() + a->get().size());
+      bytes.insert(bytes.end(), b->get().data(),
+                   b->get().data() + b->get().size());
+      return CBORBstr(std::move(bytes));
+    }
+    return std::move(prefix).visit(adhoc{
+        [&](CBORArray&& a) -> std::expected<CBORValue, PackedError> {
+          return std::move(suffix).visit(adhoc{
+              [&](CBORArray&& b) -> std::expected<CBORValue, PackedError> {
+                for (auto const& element : b)
+                  a.push_back(CBORValue(element));
+                return std::move(a);
+              },
+              [&](auto&&) -> std::expected<CBORValue, PackedError> {
+                return bad;
+              },
+          });
+        },
+        [&](CBORMap&& a) -> std::expected<CBORValue, PackedError> {
+          return std::move(suffix).visit(adhoc{
+              [&](CBORMap&& b) -> std::expected<CBORValue, PackedError> {
+                for (CBORMap::size_type i = 0; i < b.size(); ++i)
+                  a.insert(CBORValue(b.key(i)), CBORValue(b.value(i)));
+                return std::move(a);
+              },
+              [&](auto&&) -> std::expected<CBORValue, PackedError> {
+                return bad;
+              },
+          });
+        },
+        [&](auto&&) -> std::expected<CBORValue, PackedError> { return bad; },
+    });
+  }
+
+} // namespace
+
+auto PackedDocument::from(CBORValue&& value)
+    -> std::expected<PackedDocument, PackedError> {
+  auto const not_packed = std::unexpected(packed_error::NotPacked{});
+  auto const tag = value.as_tag_cref();
+  if (not tag or static_cast<std::uint64_t>(tag->get().tag()) !=
+                     packed_setup_tag)
+    return not_packed;
+  PackedDocument document(std::move(value));
+  // the content of a tag is held on the heap, and stays in place when
+  // the document is moved
+  auto const& content = document.packed.as_tag_cref()->get().value();
+  auto const* setup = content.visit(adhoc{
+      [](CBORArray const& a) { return &a; },
+      [](auto const&) -> CBORArray const* { return nullptr; },
+  });
+  auto const as_array = [](CBORValue const& item) {
+    return item.visit(adhoc{
+        [](CBORArray const& a) { return &a; },
+        [](auto const&) -> CBORArray const* { return nullptr; },
+    });
+  };
+  if (not setup or setup->size() != 3) return not_packed;
+  document.shared = as_array((*setup)[0]);
+  document.arguments = as_array((*setup)[1]);
+  document.rump = &(*setup)[2];
+  if (not document.shared or not document.arguments) return not_packed;
+  return document;
+}
+
+auto PackedDocument::shared_item(std::size_t i) const -> CBORValue const* {
+  return i < shared->size() ? &(*shared)[i] : nullptr;
+}
+
+auto PackedDocument::argument_item(std::size_t i) const -> CBORValue const* {
+  return i < arguments->size() ? &(*arguments)[i] : nullptr;
+}
+
+auto PackedView::Budget::charge(std::size_t bytes) noexcept -> bool {
+  if (bytes > left) return false;
+  left -= bytes;
+  return true;
+}
+
+auto PackedView::resolve() const -> std::expected<PackedView, PackedError> {
+  Budget budget{std::numeric_limits<std::size_t>::max()};
+  return resolve(0, budget);
+}
+
+auto PackedView::resolve(unsigned depth, Budget& budget) const
+    -> std::expected<PackedView, PackedError> {
+  using Kind = Reference::Kind;
+  auto const bad = std::unexpected(packed_error::BadReference{});
+  auto view = *this;
+  // a longer chain of shared item references must contain a cycle
+  for (std::size_t steps = 0; steps <= document->shared->size(); ++steps) {
+    auto const reference = classify(*view.node);
+    switch (reference.kind) {
+    case Kind::None: return view;
+    case Kind::Shared: {
+      auto const item = document->shared_item(reference.index);
+      if (not item) return bad;
+      view = PackedView(document, item);
+      break;
+    }
+    case Kind::Straight:
+    case Kind::Inverted: {
+      auto const item = document->argument_item(reference.index);
+      if (not item) return bad;
+      auto argument = PackedView(document, item).unpack(depth + 1, budget);
+      if (not argument) return std::unexpected(argument.error());
+      auto content = view.child(*reference.content).unpack(depth + 1, budget);
+      if (not content) return std::unexpected(content.error());
+      auto result = reference.kind == Kind::Straight
+                        ? combine(*std::move(argument), *std::move(content))
+                        : combine(*std::move(content), *std::move(argument));
+      if (not result) return std::unexpected(result.error());
+      auto combined = std::make_shared<CBORValue const>(*std::move(result));
+      auto const node = combined.get();
+      return PackedView(document, node, std::move(combined));
+    }
+    }
+  }
+  return bad;
+}
+
+auto PackedView::size() const -> std::expected<std::size_t, PackedError> {
+  auto const view = resolve();
+  if (not view) return std::unexpected(view.error());
+  return view->node->visit(adhoc{
+      [](CBORArray const& a) -> std::size_t { return a.size(); },
+      [](CBORMap const& m) -> std::size_t { return m.size(); },
+      [](auto const&) -> std::size_t { return 0; },
+  });
+}
+
+auto PackedView::at(std::size_t i) const
+    -> std::expected<PackedView, PackedError> {
+  auto const view = resolve();
+  if (not view) return view;
+  auto const item = view->node->visit(adhoc{
+      [i](CBORArray const& a) -> CBORValue const* {
+        return i < a.size() ? &a[i] : nullptr;
+      },
+      [i](CBORMap const& m) -> CBORValue const* {
+        return i < m.size() ? &m.key(i) : nullptr;
+      },
+      [](auto const&) -> CBORValue const* { return nullptr; },
+  });
+  if (not item) return std::unexpected(packed_error::BadReference{});
+  return view->child(*item).resolve();
+}
+
+auto PackedView::value_at(std::size_t i) const
+    -> std::expected<PackedView, PackedError> {
+  auto const view = resolve();
+  if (not view) return view;
+  auto const item = view->node->visit(adhoc{
+      [i](CBORMap const& m) -> CBORValue const* {
+        return i < m.size() ? &m.value(i) : nullptr;
+      },
+      [](auto const&) -> CBORValue const* { return nullptr; },
+  });
+  if (not item) return std::unexpected(packed_error::BadReference{});
+  return view->child(*item).resolve();
+}
+
+auto PackedView::unpack(std::size_t bytes_max) const
+    -> std::expected<CBORValue, PackedError> {
+  Budget budget{bytes_max};
+  return unpack(0, budget);
+}
+
+auto PackedView::unpack(unsigned depth, Budget& budget) const
+    -> std::expected<CBORValue, PackedError> {
+  using Result = std::expected<CBORValue, PackedError>;
+  auto const over = std::unexpected(packed_error::OverBudget{});
+  if (depth > deterministic_depth_max)
+    return std::unexpected(packed_error::BadReference{});
+  if (not budget.charge(sizeof(CBORValue))) return over;
+  auto const view = resolve(depth, budget);
+  if (not view) return std::unexpected(view.error());
+  if (auto const text = view->node->as_tstr_cref();
+      text and not budget.charge(text->get().size()))
+    return over;
+  if (auto const bytes = view->node->as_bstr_cref();
+      bytes and not budget.charge(bytes->get().size()))
+    return over;
+  return view->node->visit(adhoc{
+      [&](CBORArray const& a) -> Result {
+        CBORArray array;
+        for (auto const& element : a) {
+          auto item = view->child(element).unpack(depth + 1, budget);
+          if (not item) return item;
+          array.push_back(*std::move(item));
+        }
+        return array;
+      },
+      [&](CBORMap const& m) -> Result {
+        CBORMap map;
+        for (CBORMap::size_type i = 0; i < m.size(); ++i) {
+          auto key = view->child(m.key(i)).unpack(depth + 1, budget);
+          if (not key) return key;
+          auto value = view->child(m.value(i)).unpack(depth + 1, budget);
+          if (not value) return value;
+          map.insert(*std::move(key), *std::move(value));
+        }
+        return map;
+      },
+      [&](CBORTag const& t) -> Result {
+        auto content = view->child(t.value()).unpack(depth + 1, budget);
+        if (not content) return content;
+        return CBORTag(t.tag(), *std::move(content));
+      },
+      [&](auto const& x) -> Result { return CBORValue(x); },
+  });
+}
+
+namespace {
+
+  /// Items longer than this are not considered for the shared table
+  constexpr std::size_t packed_item_size_max = 256;
+
+  /// Number of bytes of a reference to shared item `i`
+  auto reference_size(std::size_t i) noexcept -> std::size_t {
+    if (i <= packed_simple_max) return 1;
+    return 1 + head_size((i - 16) / 2);
+  }
+
+  void append_head(std::string& out, MajorType major, std::uint64_t arg) {
+    std::byte buffer[9];
+    auto const end = write_head(buffer, major, arg);
+    out.append(reinterpret_cast<char const*>(buffer), end - buffer);
+  }
+
+  /**
+     Frequency analysis: counts how often each encoded item occurs,
+     and remembers the encoding of every item that is a candidate.
+   */
+  struct Analysis {
+    struct Candidate {
+      std::size_t count = 0;
+      std::size_t index = 0;
+      bool shared = false;
+      /// Candidates nested in one occurrence, repeated as often as they occur
+      std::vector<Candidate*> nested;
+    };
+    std::unordered_map<std::string, Candidate> candidates;
+    std::unordered_map<CBORValue const*, std::string const*> encodings;
+
+    /**
+       Returns the encoding of `item`, or an empty optional if it is
+       too long to be a candidate. The candidates counted for `item`
+       and its elements are added to `outer`.
+     */
+    auto count(CBORValue const& item, std::vector<Candidate*>& outer)
+        -> std::optional<std::string> {
+      std::vector<Candidate*> nested;
+      auto encoded = item.visit(adhoc{
+          [&](CBORArray const& a) -> std::optional<std::string> {
+            std::string out;
+            append_head(out, MajorType::Array, a.size());
+            auto fits = true;
+            for (auto const& element : a)
+              fits = append(out, count(element, nested)) and fits;
+            return fits ? std::optional(out) : std::nullopt;
+          },
+          [&](CBORMap const& m) -> std::optional<std::string> {
+            std::string out;
+            append_head(out, MajorType::Map, m.size());
+            auto fits = true;
+            for (CBORMap::size_type i = 0; i < m.size(); ++i) {
+              fits = append(out, count(m.key(i), nested)) and fits;
+              fits = append(out, count(m.value(i), nested)) and fits;
+            }
+            return fits ? std::optional(out) : std::nullopt;
+          },
+          [&](CBORTag const& t) -> std::optional<std::string> {
+            std::string out;
+            append_head(out, MajorType::Tag,
+                        static_cast<std::uint64_t>(t.tag()));
+            if (not append(out, count(t.value(), nested))) return std::nullopt;
+            return out;
+          },
+          [&](auto const&) -> std::optional<std::string> {
+            auto const bytes = encode(item);
+            if (bytes.size() > packed_item_size_max) return std::nullopt;
+            return std::string(reinterpret_cast<char const*>(bytes.data()),
+                               bytes.size());
+          },
+      });
+      if (not encoded or encoded->size() > packed_item_size_max)
+        return std::nullopt;
+      if (encoded->size() >= 2) {
+        auto [it, inserted] = candidates.try_emplace(*encoded);
+        it->second.count += 1;
+        if (inserted) it->second.nested = nested;
+        encodings.emplace(&item, &it->first);
+        outer.push_back(&it->second);
+      }
+      outer.insert(outer.end(), nested.begin(), nested.end());
+      return encoded;
+    }
+
+    static auto append(std::string& out, std::optional<std::string> const& item)
+        -> bool {
+      if (not item) return false;
+      if (out.size() + item->size() > packed_item_size_max) return false;
+      out += *item;
+      return true;
+    }
+
+    /**
+       Chooses the shared items, and returns their encodings by index.
+     */
+    auto choose() -> std::vector<std::string const*> {
+      std::vector<std::pair<std::string const*, Candidate*>> ranked;
+      for (auto& [encoding, candidate] : candidates)
+        if (candidate.count > 1)
+          ranked.emplace_back(&encoding, &candidate);
+      auto const gain = [](auto const& entry) {
+        return entry.second->count * (entry.first->size() - 1);
+      };
+      std::sort(ranked.begin(), ranked.end(),
+                [&](auto const& a, auto const& b) {
+                  if (gain(a) != gain(b)) return gain(a) > gain(b);
+                  return *a.first < *b.first;
+                });
+      std::vector<std::string const*> table;
+      for (auto& [encoding, candidate] : ranked) {
+        // counts may have dropped since ranking, see below
+        if (candidate->count < 2) continue;
+        auto const size = encoding->size();
+        auto const reference = reference_size(table.size());
+        if (size <= reference) continue;
+        // the table entry itself costs `size` bytes
+        if (candidate->count * (size - reference) <= size) continue;
+        candidate->index = table.size();
+        candidate->shared = true;
+        table.push_back(encoding);
+        // occurrences inside a shared item are only left in its entry
+        for (auto const nested : candidate->nested)
+          nested->count -= std::min(nested->count, candidate->count);
+      }
+      return table;
+    }
+  };
+
+  /**
+     Writes the rump, replacing shared items by references.
+   */
+  struct PackedWriter {
+    Analysis const& analysis;
+    std::string& out;
+
+    void reference(std::size_t i) {
+      if (i <= packed_simple_max) {
+        append_head(out, MajorType::Simple, i);
+        return;
+      }
+      auto const k = i - 16;
+      append_head(out, MajorType::Tag, packed_reference_tag);
+      append_head(out, k % 2 ? MajorType::Nint : MajorType::Uint, k / 2);
+    }
+
+    void write(CBORValue const& item) {
+      if (auto it = analysis.encodings.find(&item);
+          it != analysis.encodings.end()) {
+        auto const& candidate = analysis.candidates.at(*it->second);
+        if (candidate.shared) return reference(candidate.index);
+      }
+      item.visit(adhoc{
+          [&](CBORArray const& a) {
+            append_head(out, MajorType::Array, a.size());
+            for (auto const& element : a)
+              write(element);
+          },
+          [&](CBORMap const& m) {
+            append_head(out, MajorType::Map, m.size());
+            for (CBORMap::size_type i = 0; i < m.size(); ++i) {
+              write(m.key(i));
+              write(m.value(i));
+            }
+          },
+          [&](CBORTag const& t) {
+            append_head(out, MajorType::Tag,
+                        static_cast<std::uint64_t>(t.tag()));
+            write(t.value());
+          },
+          [&](auto const&) {
+            auto const bytes = encode(item);
+            out.append(reinterpret_cast<char const*>(bytes.data()),
+                       bytes.size());
+          },
+      });
+    }
+  };
+
+} // namespace
+
+auto encode_packed(std::span<CBORValue const> batch)
+    -> std::vector<std::byte> {
+  Analysis analysis;
+  std::vector<Analysis::Candidate*> counted;
+  for (auto const& value : batch) {
+    analysis.count(value, counted);
+    counted.clear();
+  }
+  auto const table = analysis.choose();
+  std::string out;
+  append_head(out, MajorType::Tag, packed_setup_tag);
+  append_head(out, MajorType::Array, 3);
+  append_head(out, MajorType::Array, table.size());
+  for (auto const encoding : table)
+    out += *encoding;
+  append_head(out, MajorType::Array, 0);
+  append_head(out, MajorType::Array, batch.size());
+  PackedWriter writer{analysis, out};
+  for (auto const& value : batch)
+    writer.write(value);
+  auto const first = reinterpret_cast<std::byte const*>(out.data());
+  return std::vector<std::byte>(first, first + out.size());
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_packed() {
+  return "GLVI CBOR PACKED";
+}
@@ -0,0 +1,204 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_value.h"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <memory>
+#include <span>
+#include <variant>
+#include <vector>
+
+/**
+   Packed CBOR, see draft-ietf-cbor-packed: a table setup (tag 113)
+   holds a shared item table, an argument table, and the rump, in
+   which references stand for table items:
+
+   - shared item references: simple values 0..15 for items 0..15, and
+     tag 6 with an integer, `6(n)` for item `16 + 2n` and `6(-1 - n)`
+     for item `16 + 2n + 1`;
+   - straight argument references: tags 224..255 for arguments 0..31,
+     and tag 6 with any other content for argument 0, which are
+     followed by the content ("rump");
+   - inverted argument references: tags 216..223 for arguments 0..7,
+     which are preceded by the content.
+
+   Argument references concatenate strings and arrays, and merge maps.
+ */
+constexpr std::uint64_t packed_setup_tag = 113;
+constexpr std::uint64_t packed_reference_tag = 6;
+constexpr std::uint8_t packed_simple_max = 15;
+
+/**
+   Errors specific to packed CBOR
+ */
+namespace packed_error {
+
+  /**
+     This error indicates that the value is not a table setup, i.e.
+     tag 113 around an array of two tables and the rump.
+   */
+  struct NotPacked {};
+
+  /**
+     This error indicates a reference to a table item that does not
+     exist, a cycle of references, or an argument reference whose
+     argument and content cannot be combined.
+   */
+  struct BadReference {};
+
+  /**
+     Unpacking the item would take more memory than the budget passed
+     to `PackedView::unpack`, estimated as the parser does.
+   */
+  struct OverBudget {};
+
+  /**
+     Errors that can occur when unpacking
+   */
+  using PackedError = std::variant<NotPacked, BadReference, OverBudget>;
+
+} // namespace packed_error
+
+/// @copydoc packed_error::PackedError
+using packed_error::PackedError;
+
+class PackedDocument;
+
+/**
+   View of an item within a packed document.
+
+   Items reached through shared item references are viewed in the
+   table, without a copy. Only argument references, which combine two
+   items, produce a new item, and only when they are resolved.
+ */
+class PackedView {
+  PackedDocument const* document;
+  CBORValue const* node;
+  /// Result of an argument reference, if this view is one
+  std::shared_ptr<CBORValue const> combined;
+
+  friend class PackedDocument;
+
+  PackedView(PackedDocument const* document, CBORValue const* node,
+             std::shared_ptr<CBORValue const> combined = nullptr) noexcept
+      : document{document}, node{node}, combined{std::move(combined)} {}
+
+  /// View of `item`, which is part of the item viewed by this view
+  auto child(CBORValue const& item) const -> PackedView {
+    return {document, &item, combined};
+  }
+
+  /// Memory left for the result of `unpack`, as `DecodeLimits::bytes_max`
+  struct Budget {
+    std::size_t left;
+    auto charge(std::size_t bytes) noexcept -> bool;
+  };
+
+  auto resolve(unsigned depth, Budget& budget) const
+      -> std::expected<PackedView, PackedError>;
+  auto unpack(unsigned depth, Budget& budget) const
+      -> std::expected<CBORValue, PackedError>;
+
+public:
+  /**
+     Returns the item as is, which may be a reference.
+   */
+  auto value() const noexcept -> CBORValue const& { return *node; }
+
+  /**
+     Follows references until the item is not a reference.
+   */
+  auto resolve() const -> std::expected<PackedView, PackedError>;
+
+  /**
+     Returns the number of elements of an array, or entries of a map,
+     after resolving; 0 for other items.
+   */
+  auto size() const -> std::expected<std::size_t, PackedError>;
+
+  /**
+     Returns the resolved element `i` of an array, or key `i` of a map.
+   */
+  auto at(std::size_t i) const -> std::expected<PackedView, PackedError>;
+
+  /**
+     Returns the resolved value of entry `i` of a map.
+   */
+  auto value_at(std::size_t i) const
+      -> std::expected<PackedView, PackedError>;
+
+  /**
+     Returns the item with all references replaced, as a new value.
+     Shared items may be referenced any number of times, so that the
+     result can be much larger than the document: unpacking stops with
+     `packed_error::OverBudget` once it would take more than
+     `bytes_max` bytes, estimated as `Parser` does for `DecodeLimits`.
+   */
+  auto unpack(std::size_t bytes_max = std::numeric_limits<std::size_t>::max())
+      const -> std::expected<CBORValue, PackedError>;
+};
+
+/**
+   Decoded table setup, and the tables it defines. Views refer to the
+   document, which must outlive them.
+
+       auto document = PackedDocument::from(*decode(bytes));
+       auto value = document->root().unpack();
+ */
+class PackedDocument {
+  CBORValue packed;
+  CBORArray const* shared;
+  CBORArray const* arguments;
+  CBORValue const* rump;
+
+  friend class PackedView;
+
+  PackedDocument(CBORValue&& packed) noexcept : packed{std::move(packed)} {}
+
+  auto shared_item(std::size_t i) const -> CBORValue const*;
+  auto argument_item(std::size_t i) const -> CBORValue const*;
+
+public:
+  /**
+     Takes the decoded table setup `value`.
+   */
+  static auto from(CBORValue&& value)
+      -> std::expected<PackedDocument, PackedError>;
+
+  /**
+     Returns the rump, the item that the document represents.
+   */
+  auto root() const noexcept -> PackedView { return {this, rump}; }
+};
+
+/**
+   Encodes `batch` as one packed item, whose rump is an array of the
+   values in `batch`.
+
+   The shared item table is chosen from a frequency analysis of the
+   batch. Each item that is at least two bytes long and occurs more
+   than once is a candidate. The most frequent candidates get the
+   shortest references, and a candidate is kept only if its references
+   save more than its table entry costs. Argument tables are not used.
+
+   Simple values 0..15 and tags 6, 113, 216..255 in `batch` would be
+   taken for references when decoding.
+ */
+auto encode_packed(std::span<CBORValue const> batch) -> std::vector<std::byte>;
@@ -15,6 +15,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include "glvi_cbor_parser.h"
+#include <algorithm>
 
 namespace {
   template <typename... Ts> struct adhoc : Ts... {
@@ -50,6 +51,9 @@ auto to_u8string(ParseError const& e) -> std::u8string {
           [](parse_error::InsufficientStackSize const&) -> std::u8string {
             return u8"Insufficient stack size";
           },
+          [](parse_error::OverBudget const&) -> std::u8string {
+            return u8"Over budget";
+          },
           [](parse_error::Internal const&) -> std::u8string {
             return u8"Internal";
           },
@@ -58,125 +62,657 @@ auto to_u8string(ParseError const& e) -> std::u8string {
       e.e);
 }
 
-namespace parse_state {
-  static auto do_flush(ValueStack& valStack, ContextStack& cxtStack)
-      -> std::expected<void, ParseError>;
+auto ParseError::is_invalid() const noexcept -> bool {
+  return std::holds_alternative<parse_error::Invalid>(e);
+}
+
+auto ParseError::is_incomplete() const noexcept -> bool {
+  return std::holds_alternative<parse_error::Incomplete>(e);
+}
+
+auto ParseError::is_unexpected_t() const noexcept -> bool {
+  return std::holds_alternative<parse_error::UnexpectedT>(e);
+}
+
+auto ParseError::is_unexpected_nt() const noexcept -> bool {
+  return std::holds_alternative<parse_error::UnexpectedNT>(e);
+}
+
+auto ParseError::is_unexpected() const noexcept -> bool {
+  return std::holds_alternative<parse_error::Unexpected>(e);
+}
+
+auto ParseError::is_trailing_input() const noexcept -> bool {
+  return std::holds_alternative<parse_error::TrailingInput>(e);
+}
+
+auto ParseError::is_scanner() const noexcept -> bool {
+  return std::holds_alternative<parse_error::Scanner>(e);
+}
+
+auto ParseError::is_insufficient_stack_size() const noexcept -> bool {
+  return std::holds_alternative<parse_error::InsufficientStackSize>(e);
+}
+
+auto ParseError::is_over_budget() const noexcept -> bool {
+  return std::holds_alternative<parse_error::OverBudget>(e);
+}
+
+auto ParseError::is_internal() const noexcept -> bool {
+  return std::holds_alternative<parse_error::Internal>(e);
+}
+
+auto ParseError::is_todo() const noexcept -> bool {
+  return std::holds_alternative<parse_error::Todo>(e);
+}
+
+auto ParseResult::is_incomplete() const noexcept -> bool {
+  return std::holds_alternative<parse_result::Incomplete>(v);
+}
+
+auto ParseResult::is_complete() const noexcept -> bool {
+  return std::holds_alternative<parse_result::Complete>(v);
+}
+
+auto ParseResult::is_error() const noexcept -> bool {
+  return std::holds_alternative<ParseError>(v);
+}
+
+auto parse_state::Context::is_action() const noexcept -> bool {
+  return std::holds_alternative<context::Action>(c);
+}
 
+auto parse_state::Context::is_terminal_symbol() const noexcept -> bool {
+  return std::holds_alternative<context::TerminalSymbol>(c);
+}
+
+auto parse_state::Context::is_terminal_symbol(Kind kind) const noexcept
+    -> bool {
+  return is_terminal_symbol() and as_terminal_symbol().kind == kind;
+}
+
+auto parse_state::Context::is_non_terminal_symbol() const noexcept -> bool {
+  return std::holds_alternative<context::NonTerminalSymbol>(c);
+}
+
+auto parse_state::Context::is_non_terminal_symbol(NonTerm nonTerm)
+    const noexcept -> bool {
+  return is_non_terminal_symbol() and
+         as_non_terminal_symbol().nonTerm == nonTerm;
+}
+
+namespace parse_state {
   static auto do_flush(ValueStack& valStack, ContextStack& cxtStack,
-                       Context&& context) -> std::expected<void, ParseError>;
+                       DecodeLimits const& limits)
+      -> std::expected<void, ParseError>;
 
   static auto do_consume(ValueStack& valStack, ContextStack& cxtStack,
-                         Term&& input) -> std::expected<void, ParseError>;
+                         TagRegistry const* tags, DecodeLimits const& limits,
+                         Term&& input)
+      -> std::expected<void, ParseError>;
 
   static auto do_consume(ValueStack& valStack, ContextStack& cxtStack,
+                         TagRegistry const* tags, DecodeLimits const& limits,
                          Context&& context, Term&& input)
       -> std::expected<void, ParseError>;
+
+  static auto do_consume_value(ValueStack& valStack, ContextStack& cxtStack,
+                               TagRegistry const* tags,
+                               DecodeLimits const& limits, Term&& input)
+      -> std::expected<void, ParseError>;
+
+  static auto collect_array(std::size_t base, std::uint64_t count)
+      -> context::Action;
+
+  static auto collect_map(std::size_t base, std::uint64_t count)
+      -> context::Action;
+
+  static auto collect_tag(std::size_t base, std::uint64_t tag,
+                          TagRegistry const* tags) -> context::Action;
+
+  static auto collect_until_break(std::size_t base, NonTerm seq)
+      -> context::Action;
 } // namespace parse_state
 
 static auto make_value(Term&& term) -> std::optional<CBORValue>;
 
+static auto make_bignum(std::uint64_t tag, CBORValue const& content)
+    -> std::optional<CBORValue>;
+
+static auto string_size(CBORValue const& value) -> std::size_t;
+
 auto Parser::consume(Term&& term) -> ParseResult {
+  auto& [cxtStack, valStack, limits] = parseState;
+  if (cxtStack.size() == 0) {
+    cxtStack.push(parse_state::context::NonTerminalSymbol{NonTerm::Value});
+  }
   auto result =
-      do_consume(parseState.valStack, parseState.cxtStack, std::move(term));
+      do_consume(valStack, cxtStack, tagRegistry, limits, std::move(term));
   if (not result.has_value()) {
+    parseState.valStack.stringTables.clear();
+    parseState.valStack.overBudget = false;
     return result.error();
-  } else if (parseState.cxtStack.size() > 0) {
+  } else if (cxtStack.size() > 0) {
     return parse_result::Incomplete{};
-  } else if (parseState.valStack.size() > 1) {
+  } else if (valStack.size() > 1) {
     return parse_error::Internal{};
-  } else if (auto opt_value = parseState.valStack.pop()) {
+  } else if (auto opt_value = valStack.pop()) {
+    restart();
     return parse_result::Complete{*std::move(opt_value)};
   } else {
     return parse_error::Invalid{};
   }
 }
 
-static auto parse_state::do_flush(ValueStack& valStack, ContextStack& cxtStack)
-    -> std::expected<void, ParseError> {
-  if (auto opt_context = cxtStack.pop()) {
-    return do_flush(valStack, cxtStack, *std::move(opt_context));
-  } else {
-    return {};
+/**
+   Starts over with the full budget, for the next value.
+ */
+void Parser::restart() {
+  parseState.cxtStack.depthMax = parseState.limits.depth_max;
+  parseState.valStack.budget = parseState.limits.bytes_max;
+  parseState.valStack.estimate = 0;
+  parseState.valStack.overBudget = false;
+  parseState.valStack.stringTables.clear();
+}
+
+auto Parser::consume(std::uint8_t octet) -> ParseResult {
+  auto result = ::scan(std::move(scanState), octet, parseState.limits);
+  return visit(adhoc{
+                   [&](scan_result::Incomplete&& i) -> ParseResult {
+                     // A string starts: charge its payload before
+                     // gathering it.
+                     auto& valStack = parseState.valStack;
+                     if (auto pay = std::get_if<scan_state::Pay>(&i.state);
+                         pay and pay->bytes.empty()) {
+                       if (not valStack.charge(pay->pending, 1)) {
+                         scanState = scan_state::Head{};
+                         return parse_error::OverBudget{};
+                       }
+                       if (valStack.bounded())
+                         pay->bytes.reserve(pay->pending);
+                     }
+                     scanState = std::move(i.state);
+                     return parse_result::Incomplete{};
+                   },
+                   [&](scan_result::Complete&& c) -> ParseResult {
+                     scanState = std::move(c.state);
+                     return consume(std::move(c.token));
+                   },
+                   [&](ScanError&& e) -> ParseResult {
+                     scanState = scan_state::Head{};
+                     return parse_error::Scanner{std::move(e)};
+                   },
+               },
+               std::move(result));
+}
+
+auto Parser::consume(std::span<std::byte const>& bytes) -> ParseResult {
+  while (not bytes.empty()) {
+    // The scanner completes the token with the last byte.
+    if (auto pay = std::get_if<scan_state::Pay>(&scanState);
+        pay and pay->pending > 1) {
+      auto const n = std::min<std::size_t>(pay->pending - 1, bytes.size());
+      pay->bytes.insert(pay->bytes.end(), bytes.begin(), bytes.begin() + n);
+      pay->pending -= n;
+      bytes = bytes.subspan(n);
+      continue;
+    }
+    auto result = consume(std::to_integer<std::uint8_t>(bytes.front()));
+    bytes = bytes.subspan(1);
+    if (not result.is_incomplete())
+      return result;
+  }
+  return parse_result::Incomplete{};
+}
+
+static auto decode_with(Parser&& parser,
+                        std::span<std::uint8_t const> bytes)
+    -> std::expected<CBORValue, ParseError> {
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    auto result = parser.consume(bytes[i]);
+    if (result.is_error()) {
+      return std::unexpected(std::move(result.as_error()));
+    } else if (result.is_complete()) {
+      if (i + 1 < bytes.size())
+        return std::unexpected(parse_error::TrailingInput{});
+      return std::move(result.as_complete().value);
+    }
   }
+  return std::unexpected(parse_error::Incomplete{});
 }
 
+auto decode(std::span<std::uint8_t const> bytes)
+    -> std::expected<CBORValue, ParseError> {
+  return decode_with(Parser{}, bytes);
+}
+
+auto decode(std::span<std::uint8_t const> bytes, TagRegistry const& tags)
+    -> std::expected<CBORValue, ParseError> {
+  return decode_with(Parser{tags}, bytes);
+}
+
+auto decode(std::span<std::uint8_t const> bytes, DecodeLimits const& limits)
+    -> std::expected<CBORValue, ParseError> {
+  return decode_with(Parser{limits}, bytes);
+}
+
+auto decode(std::span<std::uint8_t const> bytes, TagRegistry const& tags,
+            DecodeLimits const& limits)
+    -> std::expected<CBORValue, ParseError> {
+  return decode_with(Parser{tags, limits}, bytes);
+}
+
+/**
+   Runs the actions on top of the context stack, until it is empty,
+   or a symbol is on top.
+ */
 static auto parse_state::do_flush(ValueStack& valStack, ContextStack& cxtStack,
-                                  Context&& context)
+                                  DecodeLimits const& limits)
     -> std::expected<void, ParseError> {
-  using namespace context;
-  return std::move(context).visit(adhoc{
-      [&](Action&& arg) -> std::expected<void, ParseError> {
-        auto&& [name, action] = std::move(arg);
-        std::invoke(std::move(action), valStack, cxtStack);
-        return do_flush(valStack, cxtStack);
-      },
-      [&](auto&& arg) -> std::expected<void, ParseError> {
-        cxtStack.push(std::move(arg));
-        return {};
-      },
-  });
+  while (auto opt_context = cxtStack.pop()) {
+    if (not opt_context->is_action()) {
+      cxtStack.push(*std::move(opt_context));
+      break;
+    }
+    auto [name, action] = std::move(opt_context->as_action());
+    std::invoke(std::move(action), valStack, cxtStack, limits);
+    if (valStack.overBudget)
+      return std::unexpected(parse_error::OverBudget{});
+  }
+  return {};
 }
 
 static auto parse_state::do_consume(ValueStack& valStack,
-                                    ContextStack& cxtStack, Term&& input)
+                                    ContextStack& cxtStack,
+                                    TagRegistry const* tags,
+                                    DecodeLimits const& limits, Term&& input)
     -> std::expected<void, ParseError> {
-  if (auto opt_context = cxtStack.pop()) {
-    return do_consume(valStack, cxtStack, *std::move(opt_context),
-                      std::move(input));
-  } else {
-    return std::unexpected(parse_error::TrailingInput{});
+  while (auto opt_context = cxtStack.pop()) {
+    if (opt_context->is_action()) {
+      auto [name, action] = std::move(opt_context->as_action());
+      std::invoke(std::move(action), valStack, cxtStack, limits);
+      if (valStack.overBudget)
+        return std::unexpected(parse_error::OverBudget{});
+      continue;
+    }
+    return do_consume(valStack, cxtStack, tags, limits,
+                      *std::move(opt_context), std::move(input));
   }
+  return std::unexpected(parse_error::TrailingInput{});
 }
 
 static auto parse_state::do_consume(ValueStack& valStack,
-                                    ContextStack& cxtStack, Context&& context,
-                                    Term&& input)
+                                    ContextStack& cxtStack,
+                                    TagRegistry const* tags,
+                                    DecodeLimits const& limits,
+                                    Context&& context, Term&& input)
     -> std::expected<void, ParseError> {
-  if (context.is_action()) {
-    auto [name, action] = std::move(context.as_action());
-    std::invoke(std::move(action), valStack, cxtStack);
-    return do_consume(valStack, cxtStack, std::move(input));
-  } else if (context.is_terminal_symbol(input.kind())) {
+  using context::NonTerminalSymbol;
+  if (context.is_terminal_symbol(input.kind())) {
     if (auto optValue = make_value(std::move(input))) {
       valStack.push(*std::move(optValue));
     }
-    return do_flush(valStack, cxtStack);
+    return do_flush(valStack, cxtStack, limits);
   } else if (context.is_terminal_symbol()) {
     auto [kind] = context.as_terminal_symbol();
     cxtStack.push(context::TerminalSymbol{kind});
     return std::unexpected(parse_error::UnexpectedT{{kind}, input});
   } else if (context.is_non_terminal_symbol(NonTerm::Value)) {
-    // TODO:
-  } else if (context.is_non_terminal_symbol(NonTerm::Array)) {
-    // TODO:
+    return do_consume_value(valStack, cxtStack, tags, limits,
+                            std::move(input));
+  } else if (input.kind() == Kind::Break and
+             (context.is_non_terminal_symbol(NonTerm::ArrayXSeq) or
+              context.is_non_terminal_symbol(NonTerm::MapXSeq) or
+              context.is_non_terminal_symbol(NonTerm::BstrXSeq) or
+              context.is_non_terminal_symbol(NonTerm::TstrXSeq))) {
+    // The sequence is over; the action below collects its items.
+    return do_flush(valStack, cxtStack, limits);
   } else if (context.is_non_terminal_symbol(NonTerm::ArrayXSeq)) {
-    // TODO:
-  } else if (context.is_non_terminal_symbol(NonTerm::Bstr)) {
-    // TODO:
-  } else if (context.is_non_terminal_symbol(NonTerm::BstrXSeq)) {
-    // TODO:
-  } else if (context.is_non_terminal_symbol(NonTerm::Map)) {
-    // TODO:
+    cxtStack.push(std::move(context));
+    if (not valStack.charge(1, sizeof(CBORValue)))
+      return std::unexpected(parse_error::OverBudget{});
+    return do_consume_value(valStack, cxtStack, tags, limits,
+                            std::move(input));
   } else if (context.is_non_terminal_symbol(NonTerm::MapXSeq)) {
-    // TODO:
-  } else if (context.is_non_terminal_symbol(NonTerm::Tag)) {
-    // TODO:
-  } else if (context.is_non_terminal_symbol(NonTerm::Tstr)) {
-    // TODO:e
-  } else if (context.is_non_terminal_symbol(NonTerm::TstrXSeq)) {
-    // TODO:
+    // Keys and values alternate, so "break" is accepted between pairs only.
+    cxtStack.push(std::move(context));
+    if (not valStack.charge(2, sizeof(CBORValue)))
+      return std::unexpected(parse_error::OverBudget{});
+    cxtStack.push(NonTerminalSymbol{NonTerm::Value});
+    return do_consume_value(valStack, cxtStack, tags, limits,
+                            std::move(input));
+  } else if (context.is_non_terminal_symbol(NonTerm::BstrXSeq) or
+             context.is_non_terminal_symbol(NonTerm::TstrXSeq)) {
+    auto const chunk = context.is_non_terminal_symbol(NonTerm::BstrXSeq)
+                           ? Kind::Bstr
+                           : Kind::Tstr;
+    cxtStack.push(std::move(context));
+    if (input.kind() != chunk) {
+      return std::unexpected(
+          parse_error::UnexpectedT{{chunk, Kind::Break}, input});
+    }
+    valStack.push(*make_value(std::move(input)));
+    return do_flush(valStack, cxtStack, limits);
   }
   return std::unexpected(parse_error::Internal{});
 }
 
+/**
+   Consumes `input` as the first token of a value.
+ */
+static auto parse_state::do_consume_value(ValueStack& valStack,
+                                          ContextStack& cxtStack,
+                                          TagRegistry const* tags,
+                                          DecodeLimits const& limits,
+                                          Term&& input)
+    -> std::expected<void, ParseError> {
+  using context::NonTerminalSymbol;
+  auto const base = valStack.size();
+  if (cxtStack.depth >= cxtStack.depthMax) {
+    switch (input.kind()) {
+    case Kind::Array:
+    case Kind::Map:
+    case Kind::Tag:
+    case Kind::ArrayX:
+    case Kind::MapX:
+    case Kind::BstrX:
+    case Kind::TstrX:
+      cxtStack.push(NonTerminalSymbol{NonTerm::Value});
+      return std::unexpected(parse_error::InsufficientStackSize{});
+    default:
+      break;
+    }
+  }
+  auto const indefinite = [&](NonTerm seq) -> std::expected<void, ParseError> {
+    cxtStack.push(collect_until_break(base, seq));
+    cxtStack.push(NonTerminalSymbol{seq});
+    return {};
+  };
+  // Charges `count` items of `nodes` values each, and reserves them on
+  // the value stack.
+  auto const container = [&](std::uint64_t count, std::size_t nodes) -> bool {
+    if (not valStack.charge(count, nodes * sizeof(CBORValue))) {
+      cxtStack.push(NonTerminalSymbol{NonTerm::Value});
+      return false;
+    }
+    if (valStack.bounded())
+      valStack.theStack.reserve(base + count * nodes);
+    return true;
+  };
+  switch (input.kind()) {
+  case Kind::Array: {
+    auto const count = *input.as_array();
+    if (not container(count, 1))
+      return std::unexpected(parse_error::OverBudget{});
+    cxtStack.push(collect_array(base, count));
+    return do_flush(valStack, cxtStack, limits);
+  }
+  case Kind::Map: {
+    auto const count = *input.as_map();
+    if (not container(count, 2))
+      return std::unexpected(parse_error::OverBudget{});
+    cxtStack.push(collect_map(base, count));
+    return do_flush(valStack, cxtStack, limits);
+  }
+  case Kind::Tag:
+    if (not container(1, 1))
+      return std::unexpected(parse_error::OverBudget{});
+    if (*input.as_tag() == stringref_namespace_tag)
+      valStack.stringTables.emplace_back();
+    cxtStack.push(collect_tag(base, *input.as_tag(), tags));
+    return do_flush(valStack, cxtStack, limits);
+  case Kind::ArrayX: return indefinite(NonTerm::ArrayXSeq);
+  case Kind::MapX  : return indefinite(NonTerm::MapXSeq);
+  case Kind::BstrX : return indefinite(NonTerm::BstrXSeq);
+  case Kind::TstrX : return indefinite(NonTerm::TstrXSeq);
+  case Kind::Break:
+    cxtStack.push(NonTerminalSymbol{NonTerm::Value});
+    return std::unexpected(parse_error::UnexpectedT{
+        {Kind::Uint, Kind::Nint, Kind::BstrX, Kind::Bstr, Kind::TstrX,
+         Kind::Tstr, Kind::ArrayX, Kind::Array, Kind::MapX, Kind::Map,
+         Kind::Tag, Kind::Simple, Kind::Float},
+        input});
+  case Kind::Bstr:
+  case Kind::Tstr: {
+    auto value = *make_value(std::move(input));
+    if (not valStack.enter_string(value)) {
+      cxtStack.push(NonTerminalSymbol{NonTerm::Value});
+      return std::unexpected(parse_error::OverBudget{});
+    }
+    valStack.push(std::move(value));
+    return do_flush(valStack, cxtStack, limits);
+  }
+  default:
+    valStack.push(*make_value(std::move(input)));
+    return do_flush(valStack, cxtStack, limits);
+  }
+}
+
+/**
+   Action that completes an array of `count` elements, whose first
+   element is at position `base` of the value stack. Until then, it
+   asks for one more value at a time, so that the context stack
+   does not grow with the element count.
+ */
+static auto parse_state::collect_array(std::size_t base, std::uint64_t count)
+    -> context::Action {
+  return {"array", [base, count](ValueStack& valStack, ContextStack& cxtStack,
+                                 DecodeLimits const&) {
+            if (valStack.size() - base < count) {
+              cxtStack.push(collect_array(base, count));
+              cxtStack.push(context::NonTerminalSymbol{NonTerm::Value});
+              return;
+            }
+            valStack.push(CBORArray(valStack.take(base)));
+          }};
+}
+
+/**
+   Action that completes a map of `count` entries, see `collect_array`.
+ */
+static auto parse_state::collect_map(std::size_t base, std::uint64_t count)
+    -> context::Action {
+  return {"map", [base, count](ValueStack& valStack, ContextStack& cxtStack,
+                               DecodeLimits const&) {
+            auto const n = valStack.size() - base;
+            if (n % 2 != 0 or n / 2 < count) {
+              cxtStack.push(collect_map(base, count));
+              cxtStack.push(context::NonTerminalSymbol{NonTerm::Value});
+              return;
+            }
+            auto items = valStack.take(base);
+            CBORMap map;
+            map.reserve(count);
+            for (std::size_t i = 0; i < items.size(); i += 2)
+              map.insert(std::move(items[i]), std::move(items[i + 1]));
+            valStack.push(std::move(map));
+          }};
+}
+
+/**
+   Action that completes a tagged value, see `collect_array`.
+   Stringrefs and bignums are converted natively, other tags with the
+   decoder registered in `tags`, if any.
+ */
+static auto parse_state::collect_tag(std::size_t base, std::uint64_t tag,
+                                     TagRegistry const* tags)
+    -> context::Action {
+  return {"tag", [base, tag, tags](ValueStack& valStack,
+                                   ContextStack& cxtStack,
+                                   DecodeLimits const& limits) {
+            if (valStack.size() == base) {
+              cxtStack.push(collect_tag(base, tag, tags));
+              cxtStack.push(context::NonTerminalSymbol{NonTerm::Value});
+              return;
+            }
+            auto content = *valStack.pop();
+            if (tag == stringref_namespace_tag) {
+              valStack.stringTables.pop_back();
+              valStack.push(std::move(content));
+              return;
+            }
+            if (tag == stringref_tag) {
+              if (auto string = valStack.resolve_stringref(content)) {
+                valStack.push(*std::move(string));
+                return;
+              }
+              if (valStack.overBudget) return;
+            }
+            if (auto bignum = make_bignum(tag, content)) {
+              valStack.push(*std::move(bignum));
+              return;
+            }
+            CBORTag tagged(CBOR_U64{tag}, std::move(content));
+            if (tags) {
+              // items embedded in the content get what is left of the
+              // limits: the tag is one level deeper than `depth`
+              auto left = limits;
+              if (left.depth_max != std::numeric_limits<std::size_t>::max())
+                left.depth_max -= std::min(left.depth_max, cxtStack.depth + 1);
+              if (valStack.bounded())
+                left.bytes_max = valStack.budget - valStack.estimate;
+              valStack.push(tags->decode(std::move(tagged), left));
+            } else {
+              valStack.push(std::move(tagged));
+            }
+          }};
+}
+
+/**
+   Action that completes an indefinite-length item of kind `seq`,
+   once its "break" has been consumed.
+ */
+static auto parse_state::collect_until_break(std::size_t base, NonTerm seq)
+    -> context::Action {
+  return {"break", [base, seq](ValueStack& valStack, ContextStack&,
+                                DecodeLimits const&) {
+            auto items = valStack.take(base);
+            // the chunks were charged as they came; their concatenation
+            // is a copy that takes as much again
+            if (seq == NonTerm::BstrXSeq or seq == NonTerm::TstrXSeq) {
+              std::size_t length = 0;
+              for (auto const& item : items) length += string_size(item);
+              if (not valStack.charge(length, 1)) {
+                valStack.overBudget = true;
+                return;
+              }
+            }
+            switch (seq) {
+            case NonTerm::ArrayXSeq:
+              valStack.push(CBORArray(std::move(items)));
+              break;
+            case NonTerm::MapXSeq: {
+              CBORMap map;
+              for (std::size_t i = 0; i + 1 < items.size(); i += 2)
+                map.insert(std::move(items[i]), std::move(items[i + 1]));
+              valStack.push(std::move(map));
+              break;
+            }
+            case NonTerm::BstrXSeq: {
+              std::vector<std::byte> bytes;
+              for (auto const& item : items) {
+                auto const& chunk = item.as_bstr_cref()->get();
+                bytes.insert(bytes.end(), chunk.data(),
+                             chunk.data() + chunk.size());
+              }
+              valStack.push(CBORBstr(std::move(bytes)));
+              break;
+            }
+            default: {
+              std::u8string text;
+              for (auto const& item : items) {
+                auto const& chunk = item.as_tstr_cref()->get();
+                text.append(chunk.data(), chunk.size());
+              }
+              valStack.push(CBORTstr(std::move(text)));
+              break;
+            }
+            }
+          }};
+}
+
 auto parse_state::ContextStack::pop() -> std::optional<Context> {
   if (theStack.empty())
     return {};
   Context cxt{std::move(theStack.back())};
   theStack.pop_back();
+  if (cxt.is_action())
+    --depth;
   return cxt;
 }
 
+void parse_state::ContextStack::push(Context&& context) {
+  if (context.is_action())
+    ++depth;
+  theStack.push_back(std::move(context));
+}
+
+auto parse_state::ValueStack::pop() -> std::optional<CBORValue> {
+  if (theStack.empty())
+    return {};
+  CBORValue value{std::move(theStack.back())};
+  theStack.pop_back();
+  return value;
+}
+
+void parse_state::ValueStack::push(CBORValue&& value) {
+  theStack.push_back(std::move(value));
+}
+
+auto parse_state::ValueStack::charge(std::uint64_t count, std::size_t size)
+    -> bool {
+  if (count > (budget - estimate) / size)
+    return false;
+  estimate += count * size;
+  return true;
+}
+
+auto parse_state::ValueStack::take(std::size_t base) -> container_type {
+  auto const first = theStack.begin() + base;
+  container_type values(std::make_move_iterator(first),
+                        std::make_move_iterator(theStack.end()));
+  theStack.erase(first, theStack.end());
+  return values;
+}
+
+/**
+   Returns the length of the string `value`.
+ */
+static auto string_size(CBORValue const& value) -> std::size_t {
+  auto const bstr = value.as_bstr_cref();
+  return bstr ? bstr->get().size() : value.as_tstr_cref()->get().size();
+}
+
+auto parse_state::ValueStack::enter_string(CBORValue const& value) -> bool {
+  if (stringTables.empty()) return true;
+  auto& table = stringTables.back();
+  auto const n = string_size(value);
+  if (n < stringref_length_min(table.size())) return true;
+  // the table keeps one copy, shared by all references to it
+  if (not charge(n, 1)) return false;
+  table.push_back(std::make_shared<CBORValue const>(value));
+  return true;
+}
+
+auto parse_state::ValueStack::resolve_stringref(CBORValue const& content)
+    -> std::optional<CBORValue> {
+  auto const index = content.as_uint();
+  if (stringTables.empty() or not index) return std::nullopt;
+  auto const& table = stringTables.back();
+  auto const i = static_cast<std::uint64_t>(*index);
+  if (i >= table.size()) return std::nullopt;
+  // each reference expands into a string of its own in the value
+  if (not charge(string_size(*table[i]), 1)) {
+    overBudget = true;
+    return std::nullopt;
+  }
+  return *table[i];
+}
+
+/**
+   Makes the value of a token that is a complete value on its own;
+   returns an empty optional for all other tokens.
+ */
 static auto make_value(Term&& term) -> std::optional<CBORValue> {
   return std::move(term).visit(adhoc{
       [](token::Uint&& uint) -> std::optional<CBORValue> {
@@ -185,31 +721,37 @@ static auto make_value(Term&& term) -> std::optional<CBORValue> {
       [](token::Nint&& nint) -> std::optional<CBORValue> {
 	return CBORNint { CBOR_U64 { nint.value } };
       },
-      [](token::BstrX&&) -> std::optional<CBORValue> {
-	return CBORBstr {};
-      },
       [](token::Bstr&& bstr) -> std::optional<CBORValue> {
-	return CBORBstr {bstr.value};
-      },
-      [](token::TstrX&&) -> std::optional<CBORValue> {
-	return CBORTstr {};
+	return CBORBstr { std::move(bstr.value) };
       },
       [](token::Tstr&& tstr) -> std::optional<CBORValue> {
-	return CBORTstr {tstr.value};
-      },
-      [](token::ArrayX&&) -> std::optional<CBORValue> {
-	return CBORArray {};
-      },
-      [](token::MapX&&) -> std::optional<CBORValue> {
-	return CBORMap {};
+	return CBORTstr { std::move(tstr.value) };
       },
       [](token::Simple&& simple) -> std::optional<CBORValue> {
 	return CBORSimple { simple.value };
       },
       [](token::Float&& f) -> std::optional<CBORValue> {
-	// TODO:
-	return CBORFloat { };
+	return CBORFloat { from_bits(f.value, f.width), f.width };
       },
       [](auto&&) -> std::optional<CBORValue> { return {}; },
   });
 }
+
+/**
+   Makes the value of a bignum, tag 2 or 3 with byte string `content`,
+   normalised to `CBORUint` or `CBORNint` where the argument fits;
+   returns an empty optional for all other tags.
+ */
+static auto make_bignum(std::uint64_t tag, CBORValue const& content)
+    -> std::optional<CBORValue> {
+  if (tag != 2 and tag != 3) return std::nullopt;
+  auto const opt_bstr = content.as_bstr_cref();
+  if (not opt_bstr) return std::nullopt;
+  auto const& bstr = opt_bstr->get();
+  auto bignum = CBORBignum::from_bytes(std::span(bstr.data(), bstr.size()),
+                                       tag == 3);
+  if (not bignum.fits_u64()) return bignum;
+  auto const arg = CBOR_U64{bignum.low_limb()};
+  if (tag == 3) return CBORNint{arg};
+  return CBORUint{arg};
+}
@@ -16,8 +16,15 @@
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 #include "glvi_cbor_scanner.h"
+#include "glvi_cbor_stringref.h"
+#include "glvi_cbor_tag_registry.h"
 #include "glvi_cbor_value.h"
+#include <cstdint>
+#include <expected>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <span>
 
 /**
    Terminal symbols
@@ -109,10 +116,18 @@ namespace parse_error {
   /**
      Parsing a token would require more stack size than is available;
      refers to context stack size for an LL parser, or state stack
-     size for an LR parser.
+     size for an LR parser. The LL parser reports this when a value
+     nests deeper than `DecodeLimits::depth_max`.
    */
   struct InsufficientStackSize {};
 
+  /**
+     Decoding the value would take more memory than
+     `DecodeLimits::bytes_max`, as estimated from the counts declared
+     so far; reported before the memory is allocated.
+   */
+  struct OverBudget {};
+
   /**
      Internal error
   */
@@ -128,7 +143,8 @@ namespace parse_error {
    */
   using ParseError =
       std::variant<Invalid, Incomplete, UnexpectedT, UnexpectedNT, Unexpected,
-                   TrailingInput, Scanner, InsufficientStackSize, Internal, Todo>;
+                   TrailingInput, Scanner, InsufficientStackSize, OverBudget,
+                   Internal, Todo>;
 } // namespace parse_error
 
 /**
@@ -164,6 +180,7 @@ public:
   auto is_trailing_input          () const noexcept -> bool;
   auto is_scanner                 () const noexcept -> bool;
   auto is_insufficient_stack_size () const noexcept -> bool;
+  auto is_over_budget             () const noexcept -> bool;
   auto is_internal                () const noexcept -> bool;
   auto is_todo                    () const noexcept -> bool;
 
@@ -194,8 +211,13 @@ namespace parse_state {
   namespace context {
     struct Action {
       std::string name;
-      std::function<void(ValueStack&, ContextStack&)> fun;
+      std::function<void(ValueStack&, ContextStack&, DecodeLimits const&)>
+          fun;
       Action() = delete;
+      Action(std::string name,
+             std::function<void(ValueStack&, ContextStack&,
+                                DecodeLimits const&)> fun)
+          : name{std::move(name)}, fun{std::move(fun)} {}
     };
     struct TerminalSymbol{
       Kind kind;
@@ -249,6 +271,10 @@ namespace parse_state {
   struct ContextStack {
     using container_type = std::vector<Context>;
     container_type theStack;
+    /// Number of actions on the stack, i.e. of enclosing containers
+    std::size_t depth = 0;
+    /// Maximum of `depth`, see `DecodeLimits::depth_max`
+    std::size_t depthMax = std::numeric_limits<std::size_t>::max();
     constexpr auto size() const noexcept { return theStack.size(); }
     auto pop() -> std::optional<Context>;
     void push(Context&&);
@@ -256,13 +282,43 @@ namespace parse_state {
   struct ValueStack {
     using container_type = std::vector<CBORValue>;
     container_type theStack;
+    /// Strings in a stringref table, shared rather than copied per entry
+    using string_table = std::vector<std::shared_ptr<CBORValue const>>;
+    /// String tables of the enclosing stringref namespaces, innermost last
+    std::vector<string_table> stringTables;
     constexpr auto size() const noexcept { return theStack.size(); }
     auto pop() -> std::optional<CBORValue>;
     void push(CBORValue&&);
+    /// Removes and returns all values from position `base` upwards
+    auto take(std::size_t base) -> container_type;
+    /// Enters the string `value` into the innermost string table,
+    /// if there is one, and `value` is long enough; false if that
+    /// exceeds `budget`
+    auto enter_string(CBORValue const& value) -> bool;
+    /// Returns the string that the stringref `content` refers to,
+    /// charging its length; sets `overBudget` if that exceeds `budget`
+    auto resolve_stringref(CBORValue const& content)
+        -> std::optional<CBORValue>;
+    /// Memory the current value may take, see `DecodeLimits::bytes_max`
+    std::size_t budget = std::numeric_limits<std::size_t>::max();
+    /// Memory the current value takes, predicted from declared counts
+    std::size_t estimate = 0;
+    /// Adds `count` objects of `size` bytes to `estimate`, unless that
+    /// exceeds `budget`
+    auto charge(std::uint64_t count, std::size_t size) -> bool;
+    /// Set by an action that exceeded `budget`
+    bool overBudget = false;
+    /// Whether `estimate` is bounded, so that memory may be reserved
+    /// for declared counts up front
+    constexpr auto bounded() const noexcept {
+      return budget != std::numeric_limits<std::size_t>::max();
+    }
   };
   struct ParseState {
     ContextStack cxtStack;
     ValueStack valStack;
+    /// Limits of the parser, which tag decoders get what is left of
+    DecodeLimits limits;
   };
 } // namespace parse_state
 
@@ -311,10 +367,98 @@ public:
   }
 };
 
+/**
+   LL parser for CBOR values
+
+   Once a value is complete, the parser starts over with the next
+   token, so a CBOR sequence (RFC 8742) is parsed by consuming until
+   each `parse_result::Complete`.
+
+   Stringref namespaces (tag 256) are resolved while parsing: the
+   result holds the referenced strings in place of their references
+   (tag 25), and the content in place of the namespace.
+
+   The parser enforces `DecodeLimits` per value: each array, map and
+   tag counts as one level of nesting. The memory a value takes is
+   estimated from the counts as soon as they are read: a node of
+   `sizeof(CBORValue)` per array element, two per map entry, and one
+   per tag content, plus the payload of strings, which for an
+   indefinite-length string is counted for its chunks and again for
+   the string they are joined into. A value whose estimate exceeds
+   the budget is rejected with `parse_error::OverBudget` before the
+   memory is allocated; within a budget, string payloads and the value
+   stack are reserved up front.
+ */
 class Parser {
   ScanState scanState;
   ParseState parseState;
+  TagRegistry const* tagRegistry = nullptr;
+
+  void restart();
 
 public:
+  Parser() { restart(); }
+
+  /**
+     Constructs a parser that rejects values beyond `limits`.
+   */
+  explicit Parser(DecodeLimits const& limits) : parseState{{}, {}, limits} {
+    restart();
+  }
+
+  /**
+     Constructs a parser that converts tagged values with the decoders
+     in `tags`, which must outlive the parser.
+   */
+  explicit Parser(TagRegistry const& tags) : tagRegistry{&tags} { restart(); }
+
+  /**
+     Constructs a parser as above, that rejects values beyond `limits`.
+   */
+  Parser(TagRegistry const& tags, DecodeLimits const& limits)
+      : parseState{{}, {}, limits}, tagRegistry{&tags} {
+    restart();
+  }
+
   auto consume(Term&& term) -> ParseResult;
+
+  /**
+     Scans `octet`, and consumes the token it completes, if any.
+   */
+  auto consume(std::uint8_t octet) -> ParseResult;
+
+  /**
+     Consumes bytes from the front of `bytes`, until a value is
+     complete, an error occurs, or `bytes` is exhausted, and removes
+     them from `bytes`. String payloads are copied in bulk, rather
+     than scanned byte by byte.
+   */
+  auto consume(std::span<std::byte const>& bytes) -> ParseResult;
 };
+
+/**
+   Decodes `bytes`, which must hold exactly one CBOR value.
+ */
+auto decode(std::span<std::uint8_t const> bytes)
+    -> std::expected<CBORValue, ParseError>;
+
+/**
+   Decodes `bytes` as above, converting tagged values with the
+   decoders in `tags`.
+ */
+auto decode(std::span<std::uint8_t const> bytes, TagRegistry const& tags)
+    -> std::expected<CBORValue, ParseError>;
+
+/**
+   Decodes `bytes` as above, rejecting values beyond `limits`.
+ */
+auto decode(std::span<std::uint8_t const> bytes, DecodeLimits const& limits)
+    -> std::expected<CBORValue, ParseError>;
+
+/**
+   Decodes `bytes` as above, converting tagged values with the
+   decoders in `tags`, and rejecting values beyond `limits`.
+ */
+auto decode(std::span<std::uint8_t const> bytes, TagRegistry const& tags,
+            DecodeLimits const& limits)
+    -> std::expected<CBORValue, ParseError>;
@@ -14,6 +14,8 @@
 //
 //  You should have received a copy of the GNU General Public License
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_embedded.h"
+#include "glvi_cbor_encoder.h"
 #include "glvi_cbor_parser.h"
 #include "glvi_cbor_simple.h"
 #include "glvi_cbor_token.h"
@@ -21,6 +23,7 @@
 #include "glvi_cbor_value.h"
 #include <dejagnu.h>
 
+#include <bit>
 #include <source_location>
 
 namespace {
@@ -36,6 +39,23 @@ using vec_tok = std::vector<Token>;
 
 using vec_cbor = std::vector<CBORValue>;
 
+using vec_byte = std::vector<std::byte>;
+
+using vec_u8 = std::vector<std::uint8_t>;
+
+/**
+   Decodes `input`, and re-encodes the result with preferred
+   serialisation.
+ */
+static auto round_trip(vec_u8 const& input) -> std::optional<vec_u8> {
+  auto value = decode(input);
+  if (not value) return std::nullopt;
+  vec_u8 output;
+  for (auto b : encode(*value))
+    output.push_back(std::to_integer<std::uint8_t>(b));
+  return output;
+}
+
 class CBORParserTests : TestState, std::source_location {
   enum class test { passed, failed };
 
@@ -65,6 +85,9 @@ public:
                 fail(loc.function_name());
               },
               [&](parse_result::Complete&& complete) -> void {
+                auto opt = complete.value.as_uint();
+                if (opt and static_cast<std::uint64_t>(*opt) == 0)
+                  return pass(loc.function_name());
 		note("Complete");
                 fail(loc.function_name());
               },
@@ -90,6 +113,8 @@ public:
                 fail(loc.function_name());
               },
               [&](parse_result::Complete&& complete) -> void {
+                if (encode(complete.value) == vec_byte{std::byte{0xf6}})
+                  return pass(loc.function_name());
 		note("Complete");
                 fail(loc.function_name());
               },
@@ -115,6 +140,9 @@ public:
                 fail(loc.function_name());
               },
               [&](parse_result::Complete&& complete) -> void {
+                auto opt = complete.value.as_bstr();
+                if (opt and opt->size() == 0)
+                  return pass(loc.function_name());
 		note("Complete");
                 fail(loc.function_name());
               },
@@ -128,6 +156,317 @@ public:
     note("Exception");
     return fail(current().function_name());
   }
+
+  void test_decode_containers() noexcept try {
+    // [1, {"a": [], "b": h'01'}, 24(-1)], definite and indefinite
+    vec_u8 definite{0x83, 0x01, 0xa2, 0x61, 0x61, 0x80, 0x61, 0x62,
+                    0x41, 0x01, 0xd8, 0x18, 0x20};
+    vec_u8 indefinite{0x9f, 0x01, 0xbf, 0x61, 0x61, 0x9f, 0xff, 0x61,
+                      0x62, 0x5f, 0x41, 0x01, 0xff, 0xff, 0xd8, 0x18,
+                      0x20, 0xff};
+    if (round_trip(definite) == definite and
+        round_trip(indefinite) == definite) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_rejects() noexcept {
+    auto trailing = decode(vec_u8{0x01, 0x02});
+    auto incomplete = decode(vec_u8{0x82, 0x01});
+    auto odd_map = decode(vec_u8{0xbf, 0x01, 0xff});
+    if (not trailing and trailing.error().is_trailing_input() and
+        not incomplete and incomplete.error().is_incomplete() and
+        not odd_map and odd_map.error().is_unexpected_t()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  }
+
+  void test_decode_float_widths() noexcept try {
+    // smallest half subnormal, half -Inf, half NaN with payload,
+    // single 100000.0, and 1.5 in all three widths
+    auto half_subnormal = decode(vec_u8{0xf9, 0x00, 0x01});
+    auto single = decode(vec_u8{0xfa, 0x47, 0xc3, 0x50, 0x00});
+    vec_u8 widths{0x86, 0xf9, 0x00, 0x01, 0xf9, 0xfc, 0x00, 0xf9, 0x7c,
+                  0x01, 0xf9, 0x3e, 0x00, 0xfa, 0x3f, 0xc0, 0x00, 0x00,
+                  0xfb, 0x3f, 0xf8, 0, 0, 0, 0, 0, 0};
+    auto const is_float = [](auto const& value, double expected) {
+      return value and value->visit(adhoc{
+                           [&](CBORFloat const& f) {
+                             return f.value == expected;
+                           },
+                           [](auto const&) { return false; },
+                       });
+    };
+    if (is_float(half_subnormal, 0x1p-24) and is_float(single, 100000.0) and
+        round_trip(widths) == widths) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_tags() noexcept try {
+    // [1(-1), 37(h'00..0f'), 1("x"), 65000("ok"), 32("a")]
+    vec_u8 input{0x85, 0xc1, 0x20, 0xd8, 0x25, 0x50};
+    for (std::uint8_t i = 0; i < 16; ++i) input.push_back(i);
+    input.insert(input.end(), {0xc1, 0x61, 0x78, 0xd9, 0xfd, 0xe8, 0x62,
+                               0x6f, 0x6b, 0xd8, 0x20, 0x61, 0x61});
+    StaticTagRegistry<tag_decoders::EpochTime, tag_decoders::Uuid> tags;
+    tags.add(65000, [](CBORTag&& tagged) -> CBORValue {
+      auto text = tagged.value().as_tstr();
+      if (not text) return std::move(tagged);
+      return CBORCustom(std::move(tagged), std::u8string(text->data(),
+                                                         text->size()));
+    });
+    auto const value = decode(input, tags);
+    auto const encoded = encode(*value);
+    auto const& array = value->visit(adhoc{
+        [](CBORArray const& a) -> CBORArray const* { return &a; },
+        [](auto const&) -> CBORArray const* { return nullptr; },
+    });
+    auto const custom = [&](std::size_t i) {
+      auto const opt = (*array)[i].as_custom_cref();
+      return opt ? &opt->get() : nullptr;
+    };
+    using std::chrono::seconds;
+    auto const time = custom(0)->get<tag_decoders::EpochTime::type>();
+    auto const uuid = custom(1)->get<tag_decoders::Uuid::type>();
+    auto const own = custom(3)->get<std::u8string>();
+    if (time and *time == tag_decoders::EpochTime::type(seconds(-1)) and
+        uuid and (*uuid)[15] == std::byte{15} and
+        (*array)[2].is_tag() and own and *own == u8"ok" and
+        (*array)[4].is_tag() and
+        std::ranges::equal(encoded, input, {},
+                           [](std::byte b) {
+                             return std::to_integer<std::uint8_t>(b);
+                           })) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_embedded_lazily() noexcept try {
+    // {"payload": 24(<<[24(<<{"n": 1}>>)]>>)}
+    CBORMap inner;
+    inner.insert(u8"n"_cbor_tstr, CBORUint(CBOR_U64(1u)));
+    CBORArray middle;
+    middle.push_back(make_embedded(inner));
+    CBORMap outer;
+    outer.insert(u8"payload"_cbor_tstr, make_embedded(middle));
+    auto const encoded = encode(outer);
+    vec_u8 input;
+    for (auto b : encoded) input.push_back(std::to_integer<std::uint8_t>(b));
+    StaticTagRegistry<tag_decoders::Embedded> tags;
+    auto const value = decode(input, tags);
+    auto const embedded = [](CBORValue const& item) -> EmbeddedCBOR const* {
+      auto const custom = item.as_custom_cref();
+      return custom ? custom->get().get<EmbeddedCBOR>() : nullptr;
+    };
+    auto const payload = value->visit(adhoc{
+        [&](CBORMap const& m) { return embedded(m.value(0)); },
+        [](auto const&) -> EmbeddedCBOR const* { return nullptr; },
+    });
+    auto const lazy = payload and not payload->is_decoded();
+    // forwarding writes the received bytes
+    auto const forwarded = encode(*value) == encoded;
+    auto const& level2 = payload->value();
+    auto const level3 = level2->visit(adhoc{
+        [&](CBORArray const& a) { return embedded(a[0]); },
+        [](auto const&) -> EmbeddedCBOR const* { return nullptr; },
+    });
+    auto const lazy3 = level3 and not level3->is_decoded();
+    auto const& innermost = level3->value();
+    // a view may also borrow a buffer
+    auto const inner_bytes = encode(inner);
+    EmbeddedCBOR borrowed(inner_bytes);
+    // 24(<<[[1]]>>): the tag is one level, so the embedded item nests
+    // deeper than what is left of the limits of the parser
+    DecodeLimits limits;
+    limits.depth_max = 2;
+    auto const deep =
+        decode(vec_u8{0xd8, 0x18, 0x43, 0x81, 0x81, 0x01}, tags, limits);
+    auto const deep_view = deep ? embedded(*deep) : nullptr;
+    // [1, 2, 3] and 24(<<[1, 2, 3]>>) are longer than the count limit
+    DecodeLimits counts;
+    counts.array_count_max = 2;
+    auto const long_ = decode(vec_u8{0x83, 0x01, 0x02, 0x03}, tags, counts);
+    auto const long_embedded = decode(
+        vec_u8{0xd8, 0x18, 0x44, 0x83, 0x01, 0x02, 0x03}, tags, counts);
+    auto const long_view =
+        long_embedded ? embedded(*long_embedded) : nullptr;
+    if (lazy and forwarded and payload->is_decoded() and lazy3 and
+        innermost and encode(*innermost) == inner_bytes and
+        borrowed.bytes().data() == inner_bytes.data() and
+        borrowed.value() and encode(*borrowed.value()) == inner_bytes and
+        deep_view and not deep_view->value() and
+        deep_view->value().error().is_insufficient_stack_size() and
+        not long_ and long_.error().is_scanner() and long_view and
+        not long_view->value() and long_view->value().error().is_scanner()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_limits() noexcept try {
+    DecodeLimits limits;
+    limits.array_count_max = 2;
+    limits.depth_max = 2;
+    // [[1]], [[[1]]] and [1, 2, 3]
+    auto const nested = decode(vec_u8{0x81, 0x81, 0x01}, limits);
+    auto const deep = decode(vec_u8{0x81, 0x81, 0x81, 0x01}, limits);
+    auto const long_ = decode(vec_u8{0x83, 0x01, 0x02, 0x03}, limits);
+    // a 4 GiB byte string is rejected on its count
+    auto const bomb = decode(vec_u8{0x5a, 0xff, 0xff, 0xff, 0xff}, limits);
+    if (nested and not deep and deep.error().is_insufficient_stack_size() and
+        not long_ and long_.error().is_scanner() and not bomb and
+        bomb.error().is_scanner()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_budget() noexcept try {
+    DecodeLimits limits;
+    limits.bstr_count_max = std::numeric_limits<std::size_t>::max();
+    limits.array_count_max = std::numeric_limits<std::size_t>::max();
+    limits.bytes_max = 2 * sizeof(CBORValue) + 8;
+    // [h'00010203', "abcd"] fits, [h'00010203', "abcde"] does not
+    vec_u8 strings{0x82, 0x44, 0x00, 0x01, 0x02, 0x03,
+                   0x64, 'a',  'b',  'c',  'd'};
+    auto const fits = decode(strings, limits);
+    strings[6] = 0x65;
+    strings.push_back('e');
+    auto const over = decode(strings, limits);
+    // a 4 GiB byte string is rejected before its payload is gathered
+    auto const bomb = decode(vec_u8{0x5a, 0xff, 0xff, 0xff, 0xff}, limits);
+    // a byte string of 48 bytes fits in 64, but not also as chunks
+    // that are joined into it
+    limits.bytes_max = 64;
+    vec_u8 definite{0x58, 48};
+    definite.insert(definite.end(), 48, 0x00);
+    vec_u8 chunked{0x5f, 0x58, 24};
+    chunked.insert(chunked.end(), 24, 0x00);
+    chunked.insert(chunked.end(), {0x58, 24});
+    chunked.insert(chunked.end(), 24, 0x00);
+    chunked.push_back(0xff);
+    auto const whole = decode(definite, limits);
+    auto const joined = decode(chunked, limits);
+    // arrays of 1024 elements, nested 1024 deep, are rejected on the
+    // estimate long before the innermost one
+    limits.bytes_max = 1 << 20;
+    Parser parser{limits};
+    std::size_t arrays = 0;
+    auto nested = parser.consume(0x99);
+    for (; not nested.is_error() and arrays < 1024; ++arrays) {
+      parser.consume(0x04);
+      nested = parser.consume(0x00);
+      if (not nested.is_error()) nested = parser.consume(0x99);
+    }
+    // the budget is per value, so a parser takes value after value
+    Parser sequence{limits};
+    std::size_t complete = 0;
+    for (auto i = 0; i < 3; ++i)
+      for (auto b : vec_u8{0x44, 0x00, 0x01, 0x02, 0x03})
+        complete += sequence.consume(b).is_complete();
+    if (fits and not over and over.error().is_over_budget() and not bomb and
+        bomb.error().is_over_budget() and nested.is_error() and
+        nested.as_error().is_over_budget() and arrays < 32 and
+        complete == 3 and whole and not joined and
+        joined.error().is_over_budget()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_stringref_budget() noexcept try {
+    // 256([tstr of 10000 bytes, 25(0) x 200]): each reference expands
+    // into another 10000 bytes
+    vec_u8 bomb{0xd9, 0x01, 0x00, 0x98, 0xc9, 0x79, 0x27, 0x10};
+    bomb.insert(bomb.end(), 10000, 'a');
+    for (auto i = 0; i < 200; ++i)
+      bomb.insert(bomb.end(), {0xd8, 0x19, 0x00});
+    auto const unbounded = decode(bomb);
+    DecodeLimits limits;
+    limits.bytes_max = 65536;
+    auto const bounded = decode(bomb, limits);
+    if (unbounded and unbounded->is_array() and
+        encode(*unbounded).size() > 201 * 10000 and not bounded and
+        bounded.error().is_over_budget()) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_decode_bignums() noexcept try {
+    // 2(h'0000 0100'), 3(h'ffff ffff ffff ffff'), and
+    // 3(h'00 01 0000 0000 0000 0002 0000 0000 0000 0003')
+    auto const small = decode(vec_u8{0xc2, 0x44, 0x00, 0x00, 0x01, 0x00});
+    auto const nint = decode(vec_u8{0xc3, 0x48, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff});
+    vec_u8 big{0xc3, 0x52, 0x00, 0x01};
+    for (std::uint8_t last : {0x02, 0x03}) {
+      big.insert(big.end(), 7, 0x00);
+      big.push_back(last);
+    }
+    auto const value = decode(big);
+    auto const bignum = value ? value->as_bignum_cref() : std::nullopt;
+    // the leading zero byte is dropped on encoding
+    vec_u8 shortest(big);
+    shortest[1] = 0x51;
+    shortest.erase(shortest.begin() + 2);
+    CBORBignum const fits(std::vector<std::uint64_t>{42, 0});
+    if (small and small->as_uint() == CBOR_U64{256u} and nint and
+        nint->as_nint() == CBOR_U64{~std::uint64_t{0}} and bignum and
+        bignum->get().is_negative() and
+        std::ranges::equal(bignum->get().limbs(),
+                           std::vector<std::uint64_t>{3, 2, 1}) and
+        round_trip(big) == shortest and
+        encode(fits) == std::vector{std::byte{0x18}, std::byte{42}}) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    note("Exception");
+    return fail(current().function_name());
+  }
+
+  void test_halves_to_doubles() noexcept {
+    std::vector<std::uint16_t> halves;
+    for (std::uint32_t h = 0; h <= 0xffff; ++h)
+      halves.push_back(static_cast<std::uint16_t>(h));
+    std::vector<double> doubles(halves.size());
+    halves_to_doubles(halves, doubles);
+    for (std::size_t i = 0; i < halves.size(); ++i) {
+      if (std::bit_cast<std::uint64_t>(doubles[i]) !=
+          std::bit_cast<std::uint64_t>(from_half(halves[i]))) {
+        note("Mismatch at %zu", i);
+        return fail(current().function_name());
+      }
+    }
+    return pass(current().function_name());
+  }
 };
 
 int main(int argc, char *argv[]) {
@@ -135,5 +474,15 @@ int main(int argc, char *argv[]) {
   testSuite.test_parse_uint();
   testSuite.test_parse_null();
   testSuite.test_parse_nil();
+  testSuite.test_decode_containers();
+  testSuite.test_decode_rejects();
+  testSuite.test_decode_float_widths();
+  testSuite.test_decode_tags();
+  testSuite.test_decode_embedded_lazily();
+  testSuite.test_decode_limits();
+  testSuite.test_decode_budget();
+  testSuite.test_decode_stringref_budget();
+  testSuite.test_decode_bignums();
+  testSuite.test_halves_to_doubles();
   return testSuite.failure();
 }
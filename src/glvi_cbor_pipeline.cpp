@@ -0,0 +1,54 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_pipeline.h"
+#include <array>
+#include <cstdint>
+
+void DecodePipeline::run() {
+  auto parser = tags ? Parser(*tags) : Parser();
+  std::array<ByteChunk, 16> batch;
+  auto within_item = false;
+  while (auto const n = input_.pop_batch(batch.begin(), batch.size())) {
+    for (std::size_t i = 0; i < n; ++i) {
+      for (auto b : batch[i]) {
+        auto result = parser.consume(std::to_integer<std::uint8_t>(b));
+        if (result.is_incomplete()) {
+          within_item = true;
+          continue;
+        }
+        within_item = false;
+        auto pushed = result.is_complete()
+                          ? output_.push(std::move(result.as_complete().value))
+                          : output_.push(std::unexpected(result.as_error()));
+        if (not pushed or result.is_error()) {
+          input_.cancel();
+          output_.close();
+          return;
+        }
+      }
+      batch[i].clear();
+    }
+  }
+  if (within_item)
+    (void)output_.push(std::unexpected(parse_error::Incomplete{}));
+  output_.close();
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_pipeline() {
+  return "GLVI CBOR PIPELINE";
+}
@@ -0,0 +1,275 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_parser.h"
+#include "glvi_cbor_tag_registry.h"
+#include "glvi_cbor_value.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <expected>
+#include <limits>
+#include <optional>
+#include <vector>
+
+/**
+   How a ring side waits for the other side
+ */
+enum class WaitMode {
+  /**
+     Spin on the shared index: lowest latency, but keeps a core busy.
+   */
+  BusyPoll,
+  /**
+     Sleep in `std::atomic::wait`, a futex on Linux. Each push or pop
+     also notifies, which costs a system call only while the other
+     side sleeps.
+   */
+  Futex,
+};
+
+/**
+   Lock-free ring of `T` between one producer thread and one consumer
+   thread.
+
+   The producer owns the tail index, the consumer owns the head index,
+   and each keeps a cached copy of the other's index, so that the
+   shared indices are only read when the ring looks full or empty.
+   The producer ends the stream with `close()`; the consumer stops
+   it early with `cancel()`, after which pushes fail, at the latest
+   once the ring has filled up. Both set a flag bit in the index they
+   own, which also wakes a waiting peer.
+ */
+template <typename T> class SpscRing {
+  static constexpr std::size_t flag =
+      std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1);
+  /// cache line size; std::hardware_destructive_interference_size is
+  /// not ABI-stable across compiler options
+  static constexpr std::size_t line = 64;
+
+  std::vector<std::optional<T>> slots;
+  std::size_t mask;
+  WaitMode mode;
+
+  alignas(line) std::atomic<std::size_t> head = 0;
+  /// consumer's copy of `tail`
+  std::size_t tail_seen = 0;
+
+  alignas(line) std::atomic<std::size_t> tail = 0;
+  /// producer's copy of `head`
+  std::size_t head_seen = 0;
+
+  static void pause() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+  }
+
+  void wait(std::atomic<std::size_t> const& index, std::size_t seen) const
+      noexcept {
+    if (mode == WaitMode::Futex)
+      index.wait(seen, std::memory_order_acquire);
+    else
+      pause();
+  }
+
+  void publish(std::atomic<std::size_t>& index, std::size_t value) noexcept {
+    index.store(value, std::memory_order_release);
+    if (mode == WaitMode::Futex) index.notify_one();
+  }
+
+  /**
+     Consumer: waits until values follow head index `h`, and returns
+     their number; 0 once the stream is closed and drained.
+   */
+  auto wait_available(std::size_t h) noexcept -> std::size_t {
+    auto available = (tail_seen & ~flag) - h;
+    while (available == 0) {
+      tail_seen = tail.load(std::memory_order_acquire);
+      available = (tail_seen & ~flag) - h;
+      if (available > 0 or tail_seen & flag) break;
+      wait(tail, tail_seen);
+    }
+    return available;
+  }
+
+public:
+  /**
+     Constructs a ring of at least `capacity` slots, rounded up to a
+     power of two.
+   */
+  explicit SpscRing(std::size_t capacity, WaitMode mode = WaitMode::Futex)
+      : slots(std::bit_ceil(capacity < 2 ? 2 : capacity)),
+        mask{slots.size() - 1}, mode{mode} {}
+
+  SpscRing(SpscRing const&) = delete;
+  auto operator=(SpscRing const&) -> SpscRing& = delete;
+
+  auto capacity() const noexcept -> std::size_t { return slots.size(); }
+
+  /**
+     Producer: appends `value` if there is room, and returns whether
+     it did. `value` is only moved from on success.
+   */
+  auto try_push(T&& value) -> bool {
+    auto const t = tail.load(std::memory_order_relaxed);
+    if (head_seen & flag) return false;
+    if (t - head_seen == slots.size()) {
+      head_seen = head.load(std::memory_order_acquire);
+      if (head_seen & flag or t - head_seen == slots.size()) return false;
+    }
+    slots[t & mask].emplace(std::move(value));
+    publish(tail, t + 1);
+    return true;
+  }
+
+  /**
+     Producer: appends `value`, waiting while the ring is full.
+     Returns false if the consumer has cancelled.
+   */
+  auto push(T&& value) -> bool {
+    for (;;) {
+      if (try_push(std::move(value))) return true;
+      auto const h = head.load(std::memory_order_acquire);
+      if (h & flag) return false;
+      if (tail.load(std::memory_order_relaxed) - h == slots.size())
+        wait(head, h);
+    }
+  }
+
+  /**
+     Producer: ends the stream. The consumer drains the remaining
+     values, then pops nothing more.
+   */
+  void close() noexcept {
+    publish(tail, tail.load(std::memory_order_relaxed) | flag);
+  }
+
+  /**
+     Consumer: removes up to `max` values into `out`, waiting until
+     there is at least one. Returns the number of values, which is 0
+     once the stream is closed and drained, or cancelled.
+   */
+  template <typename OutputIt>
+  auto pop_batch(OutputIt out, std::size_t max) -> std::size_t {
+    auto const h = head.load(std::memory_order_relaxed);
+    if (h & flag) return 0;
+    auto const n = std::min(wait_available(h), max);
+    for (std::size_t i = 0; i < n; ++i) {
+      auto& slot = slots[(h + i) & mask];
+      *out++ = std::move(*slot);
+      slot.reset();
+    }
+    if (n > 0) publish(head, h + n);
+    return n;
+  }
+
+  /**
+     Consumer: removes one value, waiting until there is one. Returns
+     an empty optional once the stream is closed and drained.
+   */
+  auto pop() -> std::optional<T> {
+    auto const h = head.load(std::memory_order_relaxed);
+    if (h & flag or wait_available(h) == 0) return std::nullopt;
+    auto& slot = slots[h & mask];
+    std::optional<T> value(std::move(*slot));
+    slot.reset();
+    publish(head, h + 1);
+    return value;
+  }
+
+  /**
+     Consumer: returns one value if there is one, without waiting.
+   */
+  auto try_pop() -> std::optional<T> {
+    auto const h = head.load(std::memory_order_relaxed);
+    if (h & flag) return std::nullopt;
+    if ((tail_seen & ~flag) == h) {
+      tail_seen = tail.load(std::memory_order_acquire);
+      if ((tail_seen & ~flag) == h) return std::nullopt;
+    }
+    auto& slot = slots[h & mask];
+    std::optional<T> value(std::move(*slot));
+    slot.reset();
+    publish(head, h + 1);
+    return value;
+  }
+
+  /**
+     Consumer: stops the stream; pushes fail from now on.
+   */
+  void cancel() noexcept {
+    publish(head, head.load(std::memory_order_relaxed) | flag);
+  }
+};
+
+/// Chunk of bytes as received, e.g. from one `read` on a socket
+using ByteChunk = std::vector<std::byte>;
+
+/// Decoded item, or the error that ended decoding
+using DecodedItem = std::expected<CBORValue, ParseError>;
+
+/**
+   Decoding stage between a reader thread and a consumer thread: the
+   reader pushes chunks of a CBOR sequence into `input()` as they
+   arrive, `run()` decodes them on its own thread, and the consumer
+   pops the decoded items from `output()`.
+
+   Items may span chunks; the parser keeps its scanner state across
+   chunk boundaries, so chunks need not be reassembled.
+
+       DecodePipeline pipeline(1024);
+       std::jthread decoder([&] { pipeline.run(); });
+       // reader:   pipeline.input().push(std::move(chunk)); ...
+       //           pipeline.input().close();
+       // consumer: while (auto item = pipeline.output().pop()) ...
+ */
+class DecodePipeline {
+  SpscRing<ByteChunk> input_;
+  SpscRing<DecodedItem> output_;
+  TagRegistry const* tags = nullptr;
+
+public:
+  /**
+     Constructs the pipeline with rings of at least `capacity` slots.
+   */
+  explicit DecodePipeline(std::size_t capacity,
+                          WaitMode mode = WaitMode::Futex)
+      : input_(capacity, mode), output_(capacity, mode) {}
+
+  /**
+     As above, converting tagged values with the decoders in `tags`,
+     which must outlive the pipeline.
+   */
+  DecodePipeline(std::size_t capacity, WaitMode mode,
+                 TagRegistry const& tags)
+      : input_(capacity, mode), output_(capacity, mode), tags{&tags} {}
+
+  auto input() noexcept -> SpscRing<ByteChunk>& { return input_; }
+  auto output() noexcept -> SpscRing<DecodedItem>& { return output_; }
+
+  /**
+     Decodes chunks until the input is closed and drained, then closes
+     the output. An error is pushed as the last item, and cancels the
+     input; so does an output cancelled by the consumer. Input that
+     ends within an item yields `parse_error::Incomplete`.
+   */
+  void run();
+};
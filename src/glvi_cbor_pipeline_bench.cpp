@@ -0,0 +1,91 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/**
+   Measures the latency from pushing a chunk into a `DecodePipeline`
+   to popping the decoded item on a third thread, with both wait
+   modes. Each message carries the time it was sent. Messages are
+   sent at a fixed pace, so that latency is not dominated by queueing.
+   Build with `make glvi_cbor_pipeline_bench`.
+ */
+
+using namespace std::chrono;
+
+namespace {
+
+  constexpr std::size_t count = 200'000;
+  constexpr auto interval = 2us;
+
+  auto now_ns() -> std::uint64_t {
+    return duration_cast<nanoseconds>(
+               steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void run(char const* name, WaitMode mode) {
+    DecodePipeline pipeline(1024, mode);
+    std::vector<std::uint64_t> latencies;
+    latencies.reserve(count);
+    std::jthread decoder([&] { pipeline.run(); });
+    std::jthread consumer([&] {
+      while (auto item = pipeline.output().pop()) {
+        auto const sent = (*item)->visit([](auto const& x) -> std::uint64_t {
+          if constexpr (std::same_as<std::decay_t<decltype(x)>, CBORUint>)
+            return static_cast<std::uint64_t>(CBOR_U64(x));
+          return 0;
+        });
+        latencies.push_back(now_ns() - sent);
+      }
+    });
+    auto next = steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+      while (steady_clock::now() < next) {
+      }
+      next += interval;
+      pipeline.input().push(encode(CBORUint(CBOR_U64(now_ns()))));
+    }
+    pipeline.input().close();
+    consumer.join();
+    std::ranges::sort(latencies);
+    auto const at = [&](double q) {
+      return latencies[static_cast<std::size_t>(q * (latencies.size() - 1))];
+    };
+    std::printf("%-10s p50 %6llu ns  p90 %6llu ns  p99 %6llu ns  "
+                "p99.9 %7llu ns  max %8llu ns\n",
+                name, static_cast<unsigned long long>(at(0.5)),
+                static_cast<unsigned long long>(at(0.9)),
+                static_cast<unsigned long long>(at(0.99)),
+                static_cast<unsigned long long>(at(0.999)),
+                static_cast<unsigned long long>(latencies.back()));
+  }
+
+} // namespace
+
+int main() {
+  if (std::thread::hardware_concurrency() < 3)
+    std::printf("note: fewer than 3 cores, busy polling will time-share\n");
+  run("busy-poll", WaitMode::BusyPoll);
+  run("futex", WaitMode::Futex);
+  return 0;
+}
@@ -0,0 +1,112 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_pipeline.h"
+#include <dejagnu.h>
+#include <source_location>
+#include <thread>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+class CBORPipelineTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(ring_batches_and_closes)
+  {
+    SpscRing<int> ring(3, WaitMode::BusyPoll);
+    auto const capacity = ring.capacity();
+    auto const filled = ring.try_push(1) and ring.try_push(2) and
+                        ring.try_push(3) and ring.try_push(4);
+    auto const full = not ring.try_push(5);
+    std::vector<int> out(8);
+    auto const first = ring.pop_batch(out.begin(), 3);
+    auto const one = ring.try_pop();
+    ring.close();
+    auto const drained = not ring.pop() and
+                         ring.pop_batch(out.begin(), 8) == 0;
+    if (capacity == 4 and filled and full and first == 3 and out[0] == 1 and
+        out[2] == 3 and one == 4 and drained) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(pipeline_decodes_across_chunks)
+  {
+    for (auto mode : {WaitMode::BusyPoll, WaitMode::Futex}) {
+      // items split over chunks of 3 bytes, through rings of 4 slots
+      auto const make_item = [](unsigned i) {
+        CBORArray item;
+        item.push_back(CBORUint(CBOR_U64(i)));
+        item.push_back(u8"payload"_cbor_tstr);
+        return encode(item);
+      };
+      std::vector<std::byte> stream;
+      constexpr unsigned count = 1000;
+      for (unsigned i = 0; i < count; ++i) {
+        auto const item = make_item(i);
+        stream.insert(stream.end(), item.begin(), item.end());
+      }
+      stream.push_back(std::byte{0x82}); // incomplete at the end
+      DecodePipeline pipeline(4, mode);
+      std::jthread decoder([&] { pipeline.run(); });
+      std::jthread reader([&] {
+        for (std::size_t i = 0; i < stream.size(); i += 3) {
+          auto const end = std::min(i + 3, stream.size());
+          pipeline.input().push(ByteChunk(stream.begin() + i,
+                                          stream.begin() + end));
+        }
+        pipeline.input().close();
+      });
+      unsigned decoded = 0;
+      auto in_order = true;
+      std::optional<DecodedItem> last;
+      while (auto item = pipeline.output().pop()) {
+        if (*item) {
+          in_order = in_order and encode(**item) == make_item(decoded);
+          ++decoded;
+        }
+        last = std::move(item);
+      }
+      if (decoded != count or not in_order or not last or *last or
+          not last->error().is_incomplete())
+        return fail(std::source_location::current().function_name());
+    }
+    return pass(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORPipelineTests testSuite{};
+  testSuite.test_ring_batches_and_closes();
+  testSuite.test_pipeline_decodes_across_chunks();
+  return testSuite.failure();
+}
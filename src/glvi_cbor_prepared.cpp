@@ -0,0 +1,189 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_prepared.h"
+#include "glvi_cbor_constant.h"
+#include "glvi_cbor_encoder.h"
+#include <bit>
+#include <cstring>
+
+namespace {
+
+  /// Initial bytes of the fixed-width slot encodings
+  constexpr std::byte uint64_head{0x1b};
+  constexpr std::byte nint64_head{0x3b};
+  constexpr std::byte float64_head{0xfb};
+
+  void store_be64(std::byte* p, std::uint64_t value) noexcept {
+    if constexpr (std::endian::native == std::endian::little)
+      value = std::byteswap(value);
+    std::memcpy(p, &value, sizeof value);
+  }
+
+  auto string_major(SlotKind kind) noexcept -> MajorType {
+    return kind == SlotKind::Bstr ? MajorType::Bstr : MajorType::Tstr;
+  }
+
+} // namespace
+
+auto PreparedMessage::argument(std::size_t slot, SlotKind kind)
+    -> std::expected<std::byte*, PreparedError> {
+  if (slot >= slots.size())
+    return std::unexpected(prepared_error::NoSuchSlot{});
+  auto const& s = slots[slot];
+  if (s.kind != kind)
+    return std::unexpected(prepared_error::WrongKind{});
+  return encoded.data() + s.offset;
+}
+
+auto PreparedMessage::payload(std::size_t slot, SlotKind kind,
+                              std::size_t length)
+    -> std::expected<std::byte*, PreparedError> {
+  if (slot >= slots.size())
+    return std::unexpected(prepared_error::NoSuchSlot{});
+  auto const& s = slots[slot];
+  if (s.kind != kind)
+    return std::unexpected(prepared_error::WrongKind{});
+  if (s.length != length)
+    return std::unexpected(prepared_error::WrongLength{s.length});
+  return encoded.data() + s.offset + head_size(length);
+}
+
+auto PreparedMessage::set_uint(std::size_t slot, std::uint64_t value)
+    -> std::expected<void, PreparedError> {
+  auto p = argument(slot, SlotKind::Uint);
+  if (not p) return std::unexpected(p.error());
+  store_be64(*p + 1, value);
+  return {};
+}
+
+auto PreparedMessage::set_int(std::size_t slot, std::int64_t value)
+    -> std::expected<void, PreparedError> {
+  auto p = argument(slot, SlotKind::Int);
+  if (not p) return std::unexpected(p.error());
+  auto const bits = static_cast<std::uint64_t>(value);
+  // major type 1 encodes -1 - n, which is the complement of n
+  (*p)[0] = value < 0 ? nint64_head : uint64_head;
+  store_be64(*p + 1, value < 0 ? ~bits : bits);
+  return {};
+}
+
+auto PreparedMessage::set_float(std::size_t slot, double value)
+    -> std::expected<void, PreparedError> {
+  auto p = argument(slot, SlotKind::Float);
+  if (not p) return std::unexpected(p.error());
+  store_be64(*p + 1, std::bit_cast<std::uint64_t>(value));
+  return {};
+}
+
+auto PreparedMessage::set_bstr(std::size_t slot,
+                               std::span<std::byte const> value)
+    -> std::expected<void, PreparedError> {
+  auto p = payload(slot, SlotKind::Bstr, value.size());
+  if (not p) return std::unexpected(p.error());
+  if (not value.empty()) std::memcpy(*p, value.data(), value.size());
+  return {};
+}
+
+auto PreparedMessage::set_tstr(std::size_t slot, std::u8string_view value)
+    -> std::expected<void, PreparedError> {
+  auto p = payload(slot, SlotKind::Tstr, value.size());
+  if (not p) return std::unexpected(p.error());
+  if (not value.empty()) std::memcpy(*p, value.data(), value.size());
+  return {};
+}
+
+void MessageTemplateBuilder::head(MajorType major, std::uint64_t arg) {
+  auto& encoded = message.encoded;
+  auto const offset = encoded.size();
+  encoded.resize(offset + head_size(arg));
+  write_head(encoded.begin() + offset, major, arg);
+}
+
+auto MessageTemplateBuilder::slot(SlotKind kind, std::size_t length)
+    -> std::size_t {
+  auto& encoded = message.encoded;
+  auto const offset = encoded.size();
+  switch (kind) {
+  case SlotKind::Uint:
+  case SlotKind::Int:
+    encoded.push_back(uint64_head);
+    encoded.resize(offset + 9);
+    break;
+  case SlotKind::Float:
+    encoded.push_back(float64_head);
+    encoded.resize(offset + 9);
+    break;
+  case SlotKind::Bstr:
+  case SlotKind::Tstr:
+    head(string_major(kind), length);
+    encoded.resize(encoded.size() + length);
+    break;
+  }
+  message.slots.push_back({offset, kind, length});
+  return message.slots.size() - 1;
+}
+
+auto MessageTemplateBuilder::value(CBORValue const& value)
+    -> MessageTemplateBuilder& {
+  (void)encode(value, message.encoded, EncodeMode::Preferred);
+  return *this;
+}
+
+auto MessageTemplateBuilder::array(std::uint64_t n)
+    -> MessageTemplateBuilder& {
+  head(MajorType::Array, n);
+  return *this;
+}
+
+auto MessageTemplateBuilder::map(std::uint64_t n)
+    -> MessageTemplateBuilder& {
+  head(MajorType::Map, n);
+  return *this;
+}
+
+auto MessageTemplateBuilder::tag(std::uint64_t n)
+    -> MessageTemplateBuilder& {
+  head(MajorType::Tag, n);
+  return *this;
+}
+
+auto MessageTemplateBuilder::uint_slot() -> std::size_t {
+  return slot(SlotKind::Uint, 0);
+}
+
+auto MessageTemplateBuilder::int_slot() -> std::size_t {
+  return slot(SlotKind::Int, 0);
+}
+
+auto MessageTemplateBuilder::float_slot() -> std::size_t {
+  return slot(SlotKind::Float, 0);
+}
+
+auto MessageTemplateBuilder::bstr_slot(std::size_t length) -> std::size_t {
+  return slot(SlotKind::Bstr, length);
+}
+
+auto MessageTemplateBuilder::tstr_slot(std::size_t length) -> std::size_t {
+  return slot(SlotKind::Tstr, length);
+}
+
+auto MessageTemplateBuilder::build() && -> std::expected<PreparedMessage,
+                                                         PreparedError> {
+  if (not is_well_formed(message.encoded))
+    return std::unexpected(prepared_error::Malformed{});
+  return std::move(message);
+}
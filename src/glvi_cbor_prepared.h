@@ -0,0 +1,213 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_head.h"
+#include "glvi_cbor_value.h"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/**
+   Errors specific to prepared messages
+ */
+namespace prepared_error {
+
+  /**
+     This error indicates that a slot was set to a value of a
+     different kind than it was declared with.
+   */
+  struct WrongKind {};
+
+  /**
+     This error indicates that a string slot was set to a string whose
+     length differs from the declared length `expected`.
+   */
+  struct WrongLength {
+    std::size_t expected;
+  };
+
+  /**
+     This error indicates that the items added to the builder do not
+     form exactly one well-formed data item.
+   */
+  struct Malformed {};
+
+  /**
+     This error indicates that a slot was set that the message does
+     not have.
+   */
+  struct NoSuchSlot {};
+
+  /**
+     Errors that can occur when preparing or patching messages
+   */
+  using PreparedError =
+      std::variant<WrongKind, WrongLength, Malformed, NoSuchSlot>;
+
+} // namespace prepared_error
+
+/// @copydoc prepared_error::PreparedError
+using prepared_error::PreparedError;
+
+/**
+   Kinds of slots in a prepared message, and their fixed encodings
+ */
+enum class SlotKind : std::uint8_t {
+  /// unsigned integer, always `0x1b` followed by 8 bytes
+  Uint,
+  /// signed integer, `0x1b` or `0x3b` followed by 8 bytes
+  Int,
+  /// floating-point number, always `0xfb` followed by 8 bytes
+  Float,
+  /// byte string of a fixed length
+  Bstr,
+  /// text string of a fixed length
+  Tstr,
+};
+
+/**
+   Encoded message with slots that can be overwritten in place.
+
+   Every slot has a fixed width, so setting a slot never moves other
+   bytes: sending a message costs a copy of the template plus a few
+   stores. Slots are numbered in the order they were added to the
+   builder.
+ */
+class PreparedMessage {
+  /// Slot position and declared kind; `length` is used by strings only
+  struct Slot {
+    std::size_t offset;
+    SlotKind kind;
+    std::size_t length;
+  };
+
+  std::vector<std::byte> encoded;
+  std::vector<Slot> slots;
+
+  friend class MessageTemplateBuilder;
+
+  auto argument(std::size_t slot, SlotKind kind)
+      -> std::expected<std::byte*, PreparedError>;
+
+  auto payload(std::size_t slot, SlotKind kind, std::size_t length)
+      -> std::expected<std::byte*, PreparedError>;
+
+public:
+  /**
+     Returns the encoded message, including the current slot values.
+   */
+  auto bytes() const noexcept -> std::span<std::byte const> {
+    return encoded;
+  }
+
+  /**
+     Returns the number of slots.
+   */
+  auto slot_count() const noexcept -> std::size_t { return slots.size(); }
+
+  /**
+     Returns the kind of slot `slot`, which must be less than
+     `slot_count()`.
+   */
+  auto slot_kind(std::size_t slot) const noexcept -> SlotKind {
+    return slots[slot].kind;
+  }
+
+  auto set_uint(std::size_t slot, std::uint64_t value)
+      -> std::expected<void, PreparedError>;
+
+  auto set_int(std::size_t slot, std::int64_t value)
+      -> std::expected<void, PreparedError>;
+
+  auto set_float(std::size_t slot, double value)
+      -> std::expected<void, PreparedError>;
+
+  /**
+     Overwrites the byte string slot `slot`, which requires `value` to
+     have exactly the declared length.
+   */
+  auto set_bstr(std::size_t slot, std::span<std::byte const> value)
+      -> std::expected<void, PreparedError>;
+
+  /**
+     Overwrites the text string slot `slot`, which requires `value` to
+     have exactly the declared length.
+   */
+  auto set_tstr(std::size_t slot, std::u8string_view value)
+      -> std::expected<void, PreparedError>;
+};
+
+/**
+   Builds a prepared message from fixed items and slots, in encoding
+   order. Containers are declared by their heads; the caller adds the
+   right number of items after each.
+
+       MessageTemplateBuilder builder;
+       builder.map(2);
+       builder.value(u8"seq"_cbor_tstr);
+       auto const seq = builder.uint_slot();
+       builder.value(u8"id"_cbor_tstr);
+       auto const id = builder.tstr_slot(8);
+       auto message = std::move(builder).build();
+ */
+class MessageTemplateBuilder {
+  PreparedMessage message;
+
+  void head(MajorType major, std::uint64_t arg);
+  auto slot(SlotKind kind, std::size_t length) -> std::size_t;
+
+public:
+  /**
+     Appends the preferred serialisation of `value`.
+   */
+  auto value(CBORValue const& value) -> MessageTemplateBuilder&;
+
+  /**
+     Appends the head of an array of `n` items.
+   */
+  auto array(std::uint64_t n) -> MessageTemplateBuilder&;
+
+  /**
+     Appends the head of a map of `n` entries.
+   */
+  auto map(std::uint64_t n) -> MessageTemplateBuilder&;
+
+  /**
+     Appends tag number `n`, which applies to the next item.
+   */
+  auto tag(std::uint64_t n) -> MessageTemplateBuilder&;
+
+  /**
+     Each of the following appends a slot initialised to zero, or to a
+     string of NUL characters, and returns the slot number.
+   */
+  auto uint_slot() -> std::size_t;
+  auto int_slot() -> std::size_t;
+  auto float_slot() -> std::size_t;
+  auto bstr_slot(std::size_t length) -> std::size_t;
+  auto tstr_slot(std::size_t length) -> std::size_t;
+
+  /**
+     Returns the prepared message, provided the items added form
+     exactly one well-formed data item.
+   */
+  auto build() && -> std::expected<PreparedMessage, PreparedError>;
+};
@@ -0,0 +1,328 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "config.h"
+#include "glvi_cbor_ring.h"
+#include "glvi_cbor_constant.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <thread>
+#include <unistd.h>
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+  auto system_error() -> std::unexpected<std::error_code> {
+    return std::unexpected(std::error_code(errno, std::system_category()));
+  }
+
+  auto error(std::errc e) -> std::unexpected<std::error_code> {
+    return std::unexpected(std::make_error_code(e));
+  }
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "atomics in shared memory must not need a lock");
+
+  /**
+     Start of the shared memory. Positions count bytes since the
+     creation of the ring; the frame at position `p` is at offset
+     `p % capacity` of the records.
+   */
+  struct RingHeader {
+    static constexpr std::uint64_t magic_value = 0x474c5649'52494e47;
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    std::atomic<bool> closed;
+    /// written by the writer only, on its own cache line
+    alignas(64) std::atomic<std::uint64_t> head;
+    /// written by the reader only
+    alignas(64) std::atomic<std::uint64_t> tail;
+  };
+
+  /// size of the header, records start after it
+  constexpr std::size_t header_size = sizeof(RingHeader);
+
+  /// frames are aligned to their length field
+  constexpr std::size_t frame_alignment = 8;
+
+  /// length of the padding frame that wraps around to the start
+  constexpr std::uint64_t frame_wrap = ~std::uint64_t{0};
+
+  constexpr auto frame_size(std::size_t length) noexcept -> std::uint64_t {
+    return frame_alignment +
+           (length + frame_alignment - 1) / frame_alignment * frame_alignment;
+  }
+
+  auto header_of(std::byte* base) noexcept -> RingHeader* {
+    return std::launder(reinterpret_cast<RingHeader*>(base));
+  }
+
+  /// Waits a little longer each time it is called.
+  struct Backoff {
+    unsigned round = 0;
+    void operator()() {
+      using namespace std::chrono_literals;
+      if (round < 64) {
+        // spin
+      } else if (round < 128) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(round < 256 ? 10us : 200us);
+      }
+      ++round;
+    }
+  };
+} // namespace
+
+auto RingRecord::value(DecodeLimits const& limits) const
+    -> std::expected<CBORValue, ParseError> {
+  Parser parser(limits);
+  auto rest = encoded;
+  auto result = parser.consume(rest);
+  if (result.is_complete()) return std::move(result.as_complete().value);
+  if (result.is_error()) return std::unexpected(std::move(result.as_error()));
+  return std::unexpected(parse_error::Incomplete{});
+}
+
+#if HAVE_SYS_MMAN_H
+
+auto SharedRing::map(int fd, std::size_t capacity, bool create)
+    -> std::expected<SharedRing, std::error_code> {
+  auto const fail = [fd](std::unexpected<std::error_code> error) {
+    ::close(fd);
+    return error;
+  };
+  auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  if (create) {
+    capacity = (std::max<std::size_t>(capacity, 1) + page - 1) / page * page;
+    if (::ftruncate(fd, static_cast<off_t>(header_size + capacity)) != 0)
+      return fail(system_error());
+  } else {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) return fail(system_error());
+    if (static_cast<std::size_t>(st.st_size) < header_size)
+      return fail(error(std::errc::invalid_argument));
+    capacity = static_cast<std::size_t>(st.st_size) - header_size;
+  }
+  auto const length = header_size + capacity;
+  auto* const address =
+      ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED) return fail(system_error());
+  SharedRing ring;
+  ring.base = std::shared_ptr<std::byte>(
+      static_cast<std::byte*>(address),
+      [length](std::byte* p) { ::munmap(p, length); });
+  ring.ringCapacity = capacity;
+  ring.ringFd = fd;
+  auto* const header = create ? new (address) RingHeader{}
+                              : header_of(ring.base.get());
+  if (create) {
+    header->capacity = capacity;
+    // last, so an attaching reader sees a complete header
+    std::atomic_ref(header->magic)
+        .store(RingHeader::magic_value, std::memory_order_release);
+  } else if (std::atomic_ref(header->magic)
+                     .load(std::memory_order_acquire) !=
+                 RingHeader::magic_value or
+             header->capacity != capacity or
+             capacity % frame_alignment != 0) {
+    return error(std::errc::invalid_argument);
+  }
+  ring.readPos = header->tail.load(std::memory_order_acquire);
+  return ring;
+}
+
+auto SharedRing::create(std::size_t capacity)
+    -> std::expected<SharedRing, std::error_code> {
+#if HAVE_MEMFD_CREATE
+  auto const fd = ::memfd_create("glvi_cbor_ring", MFD_CLOEXEC);
+  if (fd < 0) return system_error();
+  return map(fd, capacity, true);
+#else
+  // an unnamed POSIX shared memory object
+  char name[32];
+  std::snprintf(name, sizeof name, "/glvi_cbor_ring.%ld",
+                static_cast<long>(::getpid()));
+  auto ring = create(name, capacity);
+  (void)remove(name);
+  return ring;
+#endif
+}
+
+auto SharedRing::create(char const* name, std::size_t capacity)
+    -> std::expected<SharedRing, std::error_code> {
+  auto const fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) return system_error();
+  return map(fd, capacity, true);
+}
+
+auto SharedRing::attach(int fd) -> std::expected<SharedRing, std::error_code> {
+  auto const own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (own < 0) return system_error();
+  return map(own, 0, false);
+}
+
+auto SharedRing::attach(char const* name)
+    -> std::expected<SharedRing, std::error_code> {
+  auto const fd = ::shm_open(name, O_RDWR | O_CLOEXEC, 0);
+  if (fd < 0) return system_error();
+  return map(fd, 0, false);
+}
+
+auto SharedRing::remove(char const* name)
+    -> std::expected<void, std::error_code> {
+  if (::shm_unlink(name) != 0) return system_error();
+  return {};
+}
+
+#else
+
+auto SharedRing::map(int fd, std::size_t, bool)
+    -> std::expected<SharedRing, std::error_code> {
+  ::close(fd);
+  return error(std::errc::not_supported);
+}
+
+auto SharedRing::create(std::size_t)
+    -> std::expected<SharedRing, std::error_code> {
+  return error(std::errc::not_supported);
+}
+
+auto SharedRing::create(char const*, std::size_t)
+    -> std::expected<SharedRing, std::error_code> {
+  return error(std::errc::not_supported);
+}
+
+auto SharedRing::attach(int) -> std::expected<SharedRing, std::error_code> {
+  return error(std::errc::not_supported);
+}
+
+auto SharedRing::attach(char const*)
+    -> std::expected<SharedRing, std::error_code> {
+  return error(std::errc::not_supported);
+}
+
+auto SharedRing::remove(char const*) -> std::expected<void, std::error_code> {
+  return error(std::errc::not_supported);
+}
+
+#endif
+
+SharedRing::SharedRing(SharedRing&& other) noexcept
+    : base{std::move(other.base)}, ringCapacity{other.ringCapacity},
+      ringFd{std::exchange(other.ringFd, -1)}, readPos{other.readPos},
+      broken{other.broken} {}
+
+auto SharedRing::operator=(SharedRing&& other) noexcept -> SharedRing& {
+  if (this != &other) {
+    if (ringFd >= 0) ::close(ringFd);
+    base = std::move(other.base);
+    ringCapacity = other.ringCapacity;
+    ringFd = std::exchange(other.ringFd, -1);
+    readPos = other.readPos;
+    broken = other.broken;
+  }
+  return *this;
+}
+
+SharedRing::~SharedRing() {
+  if (ringFd >= 0) ::close(ringFd);
+}
+
+auto SharedRing::try_write(std::span<std::byte const> item)
+    -> std::expected<bool, std::error_code> {
+  if (not is_well_formed(item)) return error(std::errc::invalid_argument);
+  auto const frame = frame_size(item.size());
+  if (frame > ringCapacity) return error(std::errc::message_size);
+  auto* const header = header_of(base.get());
+  auto* const records = base.get() + header_size;
+  // only this writer changes the head
+  auto head = header->head.load(std::memory_order_relaxed);
+  auto const offset = head % ringCapacity;
+  auto const wrap = ringCapacity - offset < frame ? ringCapacity - offset : 0;
+  auto const tail = header->tail.load(std::memory_order_acquire);
+  if (head + wrap + frame - tail > ringCapacity) return false;
+  if (wrap != 0) {
+    std::memcpy(records + offset, &frame_wrap, sizeof frame_wrap);
+    head += wrap;
+  }
+  std::uint64_t const length = item.size();
+  auto* const p = records + head % ringCapacity;
+  std::memcpy(p, &length, sizeof length);
+  std::memcpy(p + sizeof length, item.data(), item.size());
+  header->head.store(head + frame, std::memory_order_release);
+  return true;
+}
+
+auto SharedRing::write(std::span<std::byte const> item)
+    -> std::expected<void, std::error_code> {
+  for (Backoff backoff;; backoff()) {
+    auto const written = try_write(item);
+    if (not written) return std::unexpected(written.error());
+    if (*written) return {};
+  }
+}
+
+void SharedRing::close() noexcept {
+  header_of(base.get())->closed.store(true, std::memory_order_release);
+}
+
+auto SharedRing::try_read() -> std::optional<RingRecord> {
+  auto* const header = header_of(base.get());
+  auto const* const records = base.get() + header_size;
+  auto const head = header->head.load(std::memory_order_acquire);
+  while (not broken and readPos != head) {
+    auto const offset = readPos % ringCapacity;
+    std::uint64_t length;
+    std::memcpy(&length, records + offset, sizeof length);
+    if (length == frame_wrap) {
+      readPos += ringCapacity - offset;
+      continue;
+    }
+    auto const frame = frame_size(length);
+    if (length > ringCapacity or frame > ringCapacity - offset or
+        frame > head - readPos) {
+      broken = true;
+      break;
+    }
+    readPos += frame;
+    return RingRecord(&header->tail,
+                      {records + offset + sizeof length, length}, readPos);
+  }
+  return std::nullopt;
+}
+
+auto SharedRing::read() -> std::optional<RingRecord> {
+  auto* const header = header_of(base.get());
+  for (Backoff backoff; not broken; backoff()) {
+    if (auto record = try_read()) return record;
+    if (header->closed.load(std::memory_order_acquire))
+      return try_read();
+  }
+  return std::nullopt;
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_ring() {
+  return "GLVI CBOR RING";
+}
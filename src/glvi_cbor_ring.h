@@ -0,0 +1,192 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_embedded.h"
+#include "glvi_cbor_parser.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+
+/**
+   Record read from a `SharedRing`, borrowed from the shared memory.
+   The writer may reuse its bytes once the record is destroyed; the
+   records read from a ring must be destroyed in the order read.
+ */
+class RingRecord {
+  std::atomic<std::uint64_t>* tail;
+  std::span<std::byte const> encoded;
+  std::uint64_t end;
+
+public:
+  RingRecord(std::atomic<std::uint64_t>* tail,
+             std::span<std::byte const> encoded, std::uint64_t end) noexcept
+      : tail{tail}, encoded{encoded}, end{end} {}
+
+  RingRecord(RingRecord&& other) noexcept
+      : tail{std::exchange(other.tail, nullptr)}, encoded{other.encoded},
+        end{other.end} {}
+  RingRecord(RingRecord const&) = delete;
+  auto operator=(RingRecord&&) -> RingRecord& = delete;
+  auto operator=(RingRecord const&) -> RingRecord& = delete;
+
+  /**
+     Releases the record to the writer.
+   */
+  ~RingRecord() {
+    if (tail) tail->store(end, std::memory_order_release);
+  }
+
+  /**
+     Returns the encoded record, in the shared memory.
+   */
+  auto bytes() const noexcept -> std::span<std::byte const> {
+    return encoded;
+  }
+
+  /**
+     Returns a lazy view of the record, decoded on first access. The
+     view borrows the shared memory, so the record must outlive it.
+   */
+  auto view() const -> EmbeddedCBOR { return EmbeddedCBOR(encoded); }
+
+  /**
+     Decodes the record, rejecting values beyond `limits`.
+   */
+  auto value(DecodeLimits const& limits = {}) const
+      -> std::expected<CBORValue, ParseError>;
+};
+
+/**
+   Ring of CBOR records in shared memory, passed from one writer to
+   one reader, e.g. in two processes on the same machine, without a
+   system call or a copy per record.
+
+   The region holds a header with the positions written (head) and
+   released (tail) as lock-free atomics, followed by the records.
+   Each record is framed by its length, and kept contiguous, so the
+   reader decodes it in place: `bytes()` and `view()` of a
+   `RingRecord` point into the region.
+
+       auto ring = SharedRing::create(1 << 20);        // writer
+       ... pass ring->fd() to the reader, or fork ...
+       ring->write(encode(message));
+
+       auto ring = SharedRing::attach(fd);              // reader
+       while (auto record = ring->read()) ... record->view() ...
+
+   Waiting for the other side polls with a backoff from spinning to
+   short sleeps.
+ */
+class SharedRing {
+  std::shared_ptr<std::byte> base;
+  std::size_t ringCapacity = 0;
+  int ringFd = -1;
+  /// position of the next record to read, in the reader
+  std::uint64_t readPos = 0;
+  bool broken = false;
+
+  SharedRing() = default;
+
+  static auto map(int fd, std::size_t capacity, bool create)
+      -> std::expected<SharedRing, std::error_code>;
+
+public:
+  /**
+     Creates an anonymous ring with room for `capacity` bytes of
+     framed records, rounded up to a page, in a `memfd_create(2)`
+     region. Other processes attach to it through `fd()`, either
+     inherited or passed over a Unix socket.
+   */
+  static auto create(std::size_t capacity)
+      -> std::expected<SharedRing, std::error_code>;
+
+  /**
+     Creates a ring as above, in the POSIX shared memory object
+     `name`, which must not exist yet; see `shm_open(3)`.
+   */
+  static auto create(char const* name, std::size_t capacity)
+      -> std::expected<SharedRing, std::error_code>;
+
+  /**
+     Attaches to the ring in the shared memory file `fd`. Returns
+     `std::errc::invalid_argument` if it does not hold a ring.
+   */
+  static auto attach(int fd) -> std::expected<SharedRing, std::error_code>;
+
+  /**
+     Attaches to the ring in the POSIX shared memory object `name`.
+   */
+  static auto attach(char const* name)
+      -> std::expected<SharedRing, std::error_code>;
+
+  /**
+     Removes the POSIX shared memory object `name`; rings attached to
+     it stay valid.
+   */
+  static auto remove(char const* name) -> std::expected<void, std::error_code>;
+
+  SharedRing(SharedRing&& other) noexcept;
+  auto operator=(SharedRing&& other) noexcept -> SharedRing&;
+  ~SharedRing();
+
+  /**
+     Returns the file of the shared memory.
+   */
+  auto fd() const noexcept -> int { return ringFd; }
+
+  /**
+     Returns the number of bytes for framed records.
+   */
+  auto capacity() const noexcept -> std::size_t { return ringCapacity; }
+
+  /**
+     Appends the encoded record `item`, if there is room. Returns
+     `std::errc::invalid_argument` if `item` is not exactly one
+     well-formed data item, and `std::errc::message_size` if it does
+     not fit into the ring at all.
+   */
+  auto try_write(std::span<std::byte const> item)
+      -> std::expected<bool, std::error_code>;
+
+  /**
+     Appends `item` as above, waiting for room.
+   */
+  auto write(std::span<std::byte const> item)
+      -> std::expected<void, std::error_code>;
+
+  /**
+     Tells the reader that no more records follow.
+   */
+  void close() noexcept;
+
+  /**
+     Returns the next record, if one has been written.
+   */
+  auto try_read() -> std::optional<RingRecord>;
+
+  /**
+     Returns the next record, waiting for one; `std::nullopt` once
+     the ring is closed and empty, or if a frame is corrupt.
+   */
+  auto read() -> std::optional<RingRecord>;
+};
@@ -0,0 +1,127 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_ring.h"
+#include <algorithm>
+#include <cstdio>
+#include <dejagnu.h>
+#include <source_location>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+namespace {
+  /// Record number `i`: [i, h'...'] with a payload of up to 300 bytes
+  auto make_record(unsigned i) {
+    CBORArray record;
+    record.push_back(CBORUint(CBOR_U64(i)));
+    record.push_back(CBORBstr(std::vector<std::byte>(i * 37 % 301)));
+    return encode(record);
+  }
+} // namespace
+
+class CBORRingTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(pass_records_between_processes)
+  {
+    constexpr unsigned count = 2000;
+    auto ring = SharedRing::create(4096);
+    if (not ring) return fail(std::source_location::current().function_name());
+    auto const pid = ::fork();
+    if (pid == 0) {
+      auto writer = SharedRing::attach(ring->fd());
+      auto ok = writer.has_value();
+      for (unsigned i = 0; ok and i < count; ++i)
+        ok = writer->write(make_record(i)).has_value();
+      if (ok) writer->close();
+      ::_exit(ok ? 0 : 1);
+    }
+    unsigned received = 0;
+    auto in_place = true;
+    while (auto record = ring->read()) {
+      auto const view = record->view();
+      in_place = in_place and
+                 std::ranges::equal(record->bytes(), make_record(received)) and
+                 view.bytes().data() == record->bytes().data() and
+                 view.value() and
+                 encode(*view.value()) == make_record(received);
+      ++received;
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    if (received == count and in_place and WIFEXITED(status) and
+        WEXITSTATUS(status) == 0) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(fill_and_drain_named_ring)
+  {
+    char name[48];
+    std::snprintf(name, sizeof name, "/glvi_cbor_ring_tests.%ld",
+                  static_cast<long>(::getpid()));
+    auto writer = SharedRing::create(name, 4096);
+    auto reader = SharedRing::attach(name);
+    if (not writer or not reader)
+      return fail(std::source_location::current().function_name());
+    std::byte const malformed[] = {std::byte{0x82}, std::byte{0x01}};
+    auto const huge = encode(CBORBstr(std::vector<std::byte>(5000)));
+    auto const rejected =
+        writer->try_write(malformed).error() == std::errc::invalid_argument and
+        writer->try_write(huge).error() == std::errc::message_size;
+    unsigned written = 0;
+    while (writer->try_write(make_record(written)).value()) ++written;
+    unsigned read = 0;
+    for (; auto record = reader->try_read(); ++read)
+      if (not std::ranges::equal(record->bytes(), make_record(read))) break;
+    // room again once read
+    auto const refilled = writer->try_write(make_record(read)).value();
+    writer->close();
+    auto const last = reader->read();
+    auto const drained = last and not reader->read();
+    (void)SharedRing::remove(name);
+    if (rejected and written > 0 and read == written and refilled and
+        drained and not SharedRing::attach(name)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORRingTests testSuite{};
+  testSuite.test_pass_records_between_processes();
+  testSuite.test_fill_and_drain_named_ring();
+  return testSuite.failure();
+}
@@ -28,6 +28,24 @@ auto unexpected_head_error(std::byte octet) -> ScanResult {
   return ScanError{scan_error::UnexpectedHead{octet}};
 }
 
+template <std::unsigned_integral A, std::unsigned_integral B>
+auto protect_size(A a, B b) -> std::optional<scan_error::Excessive> {
+  using C = std::common_type_t<A, B>;
+  if (static_cast<C>(a) <= static_cast<C>(b))
+    return std::nullopt;
+  return {{a}};
+}
+
+auto count_max(Kind kind, DecodeLimits const& limits) -> std::size_t {
+  switch (kind) {
+  case Kind::Bstr : return limits.bstr_count_max;
+  case Kind::Tstr : return limits.tstr_count_max;
+  case Kind::Array: return limits.array_count_max;
+  case Kind::Map  : return limits.map_count_max;
+  default         : return std::numeric_limits<std::size_t>::max();
+  }
+}
+
 auto make_token(Kind kind, std::uint64_t argument = 0,
                 std::vector<std::byte> payload = {}) -> ScanResult {
   return scan_result::Complete{
@@ -64,7 +82,9 @@ auto token_array_empty() -> ScanResult {
   return make_token(Kind::Array);
 }
 
-auto token_array(std::uint64_t arg) -> ScanResult {
+auto token_array(std::uint64_t arg, DecodeLimits const& limits) -> ScanResult {
+  if (auto opt_err = protect_size(arg, limits.array_count_max))
+    return *std::move(opt_err);
   return make_token(Kind::Array, arg);
 }
 
@@ -76,7 +96,9 @@ auto token_map_empty() -> ScanResult {
   return make_token(Kind::Map);
 }
 
-auto token_map(std::uint64_t arg) -> ScanResult {
+auto token_map(std::uint64_t arg, DecodeLimits const& limits) -> ScanResult {
+  if (auto opt_err = protect_size(arg, limits.map_count_max))
+    return *std::move(opt_err);
   return make_token(Kind::Map, arg);
 }
 
@@ -96,22 +118,11 @@ auto token_break() -> ScanResult {
   return make_token(Kind::Break, 0xff);
 }
 
-template <std::unsigned_integral A, std::unsigned_integral B>
-auto protect_size(A a, B b) -> std::optional<scan_error::Excessive> {
-  using C = std::common_type_t<A, B>;
-  if (static_cast<C>(a) <= static_cast<C>(b))
-    return std::nullopt;
-  return {{a}};
-}
-
-auto count_max(Kind kind) -> std::size_t {
-  switch (kind) {
-  case Kind::Bstr : return scan_state::bstr_count_max;
-  case Kind::Tstr : return scan_state::tstr_count_max;
-  case Kind::Array: return scan_state::array_count_max;
-  case Kind::Map  : return scan_state::map_count_max;
-  default         : return std::numeric_limits<std::size_t>::max();
-  }
+auto token_float(std::uint64_t bits, std::size_t width) -> ScanResult {
+  return scan_result::Complete{
+      scan_state::Head{},
+      token::Float{bits, static_cast<std::uint8_t>(width)},
+  };
 }
 
 struct Argc {
@@ -129,16 +140,35 @@ constexpr Argc ARGC_N4{4};
 constexpr Argc ARGC_N8{8};
 
 auto gather_argument(Kind kind, Argc count) -> ScanResult {
-  return scan_result::Incomplete(scan_state::Arg{kind, 0, count});
+  return scan_result::Incomplete(scan_state::Arg{kind, 0, count, count});
 }
 
-auto gather_bytes(Kind kind, std::uint64_t count) {
+auto gather_bytes(Kind kind, std::uint64_t count) -> ScanResult {
   return scan_result::Incomplete{scan_state::Pay{kind, {}, count}};
 }
 
+/**
+   Gathers a string whose count is in the head byte. Such counts are
+   small, but a limit may be smaller still, e.g. what is left of
+   `DecodeLimits::bytes_max`.
+ */
+auto gather_bytes(Kind kind, std::uint64_t count, DecodeLimits const& limits)
+    -> ScanResult {
+  if (auto opt_err = protect_size(count, count_max(kind, limits)))
+    return *std::move(opt_err);
+  return gather_bytes(kind, count);
+}
+
 auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
+  static DecodeLimits const defaults;
+  return scan(std::move(state), byte, defaults);
+}
+
+auto scan(ScanState&& state, std::uint8_t byte, DecodeLimits const& limits)
+    -> ScanResult {
   struct ByteConsumer {
     std::uint8_t byte;
+    DecodeLimits const& limits;
     auto operator()(scan_state::Head) -> ScanResult {
       switch (byte) {
       case CASES_0x00_0x17: return token_uint(byte);
@@ -154,7 +184,7 @@ auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
       case 0x3b           : return gather_argument(Kind::Nint, ARGC_N8);
 
       case 0x40           : return token_bstr_empty();
-      case CASES_0x41_0x57: return gather_bytes(Kind::Bstr, (byte - 0x40));
+      case CASES_0x41_0x57: return gather_bytes(Kind::Bstr, (byte - 0x40), limits);
       case 0x58           : return gather_argument(Kind::Bstr, ARGC_N1);
       case 0x59           : return gather_argument(Kind::Bstr, ARGC_N2);
       case 0x5a           : return gather_argument(Kind::Bstr, ARGC_N4);
@@ -162,7 +192,7 @@ auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
       case 0x5f           : return token_bstr_indef();
 
       case 0x60           : return token_tstr_empty();
-      case CASES_0x61_0x77: return gather_bytes(Kind::Tstr, (byte - 0x60));
+      case CASES_0x61_0x77: return gather_bytes(Kind::Tstr, (byte - 0x60), limits);
       case 0x78           : return gather_argument(Kind::Tstr, ARGC_N1);
       case 0x79           : return gather_argument(Kind::Tstr, ARGC_N2);
       case 0x7a           : return gather_argument(Kind::Tstr, ARGC_N4);
@@ -170,7 +200,7 @@ auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
       case 0x7f           : return token_tstr_indef();
 
       case 0x80           : return token_array_empty();
-      case CASES_0x81_0x97: return token_array(byte - 0x80);
+      case CASES_0x81_0x97: return token_array(byte - 0x80, limits);
       case 0x98           : return gather_argument(Kind::Array, ARGC_N1);
       case 0x99           : return gather_argument(Kind::Array, ARGC_N2);
       case 0x9a           : return gather_argument(Kind::Array, ARGC_N4);
@@ -178,7 +208,7 @@ auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
       case 0x9f           : return token_array_indef();
 
       case 0xa0           : return token_map_empty();
-      case CASES_0xa1_0xb7: return token_map(byte - 0xa0);
+      case CASES_0xa1_0xb7: return token_map(byte - 0xa0, limits);
       case 0xb8           : return gather_argument(Kind::Map, ARGC_N1);
       case 0xb9           : return gather_argument(Kind::Map, ARGC_N2);
       case 0xba           : return gather_argument(Kind::Map, ARGC_N4);
@@ -209,10 +239,12 @@ auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
       arg.pending -= 1;
       if (arg.pending > 0) {
         return scan_result::Incomplete{std::move(arg)};
+      } else if (arg.kind == Kind::Float) {
+        return token_float(arg.arg, arg.width);
       } else if (arg.arg == 0) {
         return make_token(arg.kind);
       } else {
-        if (auto opt_err = protect_size(arg.arg, count_max(arg.kind)))
+        if (auto opt_err = protect_size(arg.arg, count_max(arg.kind, limits)))
           return *std::move(opt_err);
         switch (arg.kind) {
         case Kind::Bstr:
@@ -238,7 +270,7 @@ auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult {
       }
     }
   };
-  return std::visit(ByteConsumer{byte}, std::move(state));
+  return std::visit(ByteConsumer{byte, limits}, std::move(state));
 }
 
 struct Scanner {
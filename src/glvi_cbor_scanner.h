@@ -17,6 +17,8 @@
 #pragma once
 #include "config.h"
 #include "glvi_cbor_token.h"
+#include <cstddef>
+#include <limits>
 
 /**
    Errors specific to lexical scanning
@@ -39,11 +41,7 @@ namespace scan_error {
 
      When one of the definite-length major types -- that is byte
      string, text string, array, or map -- is specified as having a
-     count value larger than a hard-coded maximum.
-
-     ```c++
-     auto max_count = std::numeric_limits<std::size_t>::max();
-     ```
+     count value larger than its limit in `DecodeLimits`.
    */
   struct Excessive {
     std::size_t count;
@@ -63,51 +61,45 @@ using scan_error::ScanError;
 namespace scan_state {
 
   /**
-     Limits the maximum number of bytes in a CBOR byte string.
-
-     Settings this to any number > 0 will cause the scanner to reject
-     `BSTR` tokens whose argument exceeds this value.
+     Default limit of the number of bytes in a CBOR byte string, as
+     chosen with `configure --enable-cbor-bstr-count-max`; see
+     `DecodeLimits`.
    */
 #if defined(GLVI_CBOR_BSTR_COUNT_MAX) && GLVI_CBOR_BSTR_COUNT_MAX > 0
-  static std::size_t bstr_count_max = GLVI_CBOR_BSTR_COUNT_MAX;
+  inline constexpr std::size_t bstr_count_max = GLVI_CBOR_BSTR_COUNT_MAX;
 #else
-  static std::size_t bstr_count_max = std::numeric_limits<std::size_t>::max();
+  inline constexpr std::size_t bstr_count_max = std::numeric_limits<std::size_t>::max();
 #endif
 
   /**
-     Limits the maximum number of bytes in a CBOR byte string.
-
-     Settings this to any number > 0 will cause the scanner to reject
-     `TSTR` tokens whose argument exceeds this value.
+     Default limit of the number of bytes in a CBOR text string, as
+     chosen with `configure --enable-cbor-tstr-count-max`; see
+     `DecodeLimits`.
    */
 #if defined(GLVI_CBOR_TSTR_COUNT_MAX) && GLVI_CBOR_TSTR_COUNT_MAX > 0
-  static std::size_t tstr_count_max = GLVI_CBOR_TSTR_COUNT_MAX;
+  inline constexpr std::size_t tstr_count_max = GLVI_CBOR_TSTR_COUNT_MAX;
 #else
-  static std::size_t tstr_count_max = std::numeric_limits<std::size_t>::max();
+  inline constexpr std::size_t tstr_count_max = std::numeric_limits<std::size_t>::max();
 #endif
 
   /**
-     Limits the maximum number of entries for CBOR arrays.
-
-     Settings this to any number > 0 will cause the scanner to reject
-     `Array` tokens whose argument exceeds this value.
+     Default limit of the number of entries in a CBOR array, as chosen
+     with `configure --enable-cbor-array-count-max`; see `DecodeLimits`.
    */
 #if defined(GLVI_CBOR_ARRAY_COUNT_MAX) && GLVI_CBOR_ARRAY_COUNT_MAX > 0
-  static std::size_t array_count_max = GLVI_CBOR_ARRAY_COUNT_MAX;
+  inline constexpr std::size_t array_count_max = GLVI_CBOR_ARRAY_COUNT_MAX;
 #else
-  static std::size_t array_count_max = std::numeric_limits<std::size_t>::max();
+  inline constexpr std::size_t array_count_max = std::numeric_limits<std::size_t>::max();
 #endif
 
   /**
-     Limits the maximum number of entries for CBOR maps.
-
-     Settings this to any number > 0 will cause the scanner to reject
-     `Map` tokens whose argument exceeds this value.
+     Default limit of the number of entries in a CBOR map, as chosen
+     with `configure --enable-cbor-map-count-max`; see `DecodeLimits`.
    */
 #if defined(GLVI_CBOR_MAP_COUNT_MAX) && GLVI_CBOR_MAP_COUNT_MAX > 0
-  static std::size_t map_count_max = GLVI_CBOR_MAP_COUNT_MAX;
+  inline constexpr std::size_t map_count_max = GLVI_CBOR_MAP_COUNT_MAX;
 #else
-  static std::size_t map_count_max = std::numeric_limits<std::size_t>::max();
+  inline constexpr std::size_t map_count_max = std::numeric_limits<std::size_t>::max();
 #endif
 
   /**
@@ -122,6 +114,8 @@ namespace scan_state {
     Kind kind;
     std::uint64_t arg;
     std::size_t pending;
+    /// total number of argument bytes
+    std::size_t width;
   };
 
   /**
@@ -141,6 +135,32 @@ namespace scan_state {
 /// State of the lexical scanner
 using scan_state::ScanState;
 
+/**
+   Limits applied while decoding, so that the limits can differ per
+   connection: tiny for untrusted clients, large for replication
+   between trusted hosts. The counts default to the values chosen with
+   `configure`, nesting depth and memory are unlimited by default.
+
+       DecodeLimits untrusted;
+       untrusted.bstr_count_max = 4096;
+       untrusted.depth_max = 16;
+       untrusted.bytes_max = 64 * 1024;
+       auto value = decode(bytes, untrusted);
+
+   The scanner rejects a string, array or map whose count exceeds its
+   limit with `scan_error::Excessive`, as soon as the count is read.
+ */
+struct DecodeLimits {
+  std::size_t bstr_count_max = scan_state::bstr_count_max;
+  std::size_t tstr_count_max = scan_state::tstr_count_max;
+  std::size_t array_count_max = scan_state::array_count_max;
+  std::size_t map_count_max = scan_state::map_count_max;
+  /// Arrays, maps and tags enclosing one another; see `Parser`
+  std::size_t depth_max = std::numeric_limits<std::size_t>::max();
+  /// Memory per value, estimated from the declared counts; see `Parser`
+  std::size_t bytes_max = std::numeric_limits<std::size_t>::max();
+};
+
 /**
    Possible results when scanning input
  */
@@ -256,6 +276,12 @@ public:
  */
 auto scan(ScanState&& state, std::uint8_t byte) -> ScanResult;
 
+/**
+   Scans `byte` as above, rejecting counts beyond `limits`.
+ */
+auto scan(ScanState&& state, std::uint8_t byte, DecodeLimits const& limits)
+    -> ScanResult;
+
 /**
    Scans the input range specified by `[first,last)`.
 
@@ -25,11 +25,22 @@
 struct CBORSimple {
   constexpr CBORSimple(std::uint8_t n) : number{n} {}
 
+  /**
+     Extract the simple value number.
+   */
+  constexpr explicit operator std::uint8_t() const noexcept { return number; }
+
+  /**
+     Compares two CBOR simple values.
+   */
+  friend constexpr bool operator==(CBORSimple const&,
+                                   CBORSimple const&) = default;
+
 private:
   std::uint8_t number;
 };
 
-constexpr CBORSimple const CBOR_False{0xf4};
-constexpr CBORSimple const CBOR_True{0xf5};
-constexpr CBORSimple const CBOR_Null{0xf6};
-constexpr CBORSimple const CBOR_Undefined{0xf7};
+constexpr CBORSimple const CBOR_False{20};
+constexpr CBORSimple const CBOR_True{21};
+constexpr CBORSimple const CBOR_Null{22};
+constexpr CBORSimple const CBOR_Undefined{23};
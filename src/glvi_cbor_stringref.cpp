@@ -0,0 +1,146 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_stringref.h"
+#include "glvi_cbor_encoder.h"
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+  /**
+     Strings seen so far in one namespace, by content, for byte
+     strings and text strings separately. The keys view strings in
+     the value being encoded.
+   */
+  struct StringTable {
+    std::unordered_map<std::string_view, std::uint64_t> bstrs;
+    std::unordered_map<std::string_view, std::uint64_t> tstrs;
+    std::uint64_t size = 0;
+  };
+
+  /**
+     Encoder that mirrors the decoder's string table: each string
+     either refers to an earlier occurrence, or is written out and,
+     if long enough, entered into the table.
+   */
+  struct StringRefEncoder {
+    std::vector<std::byte>& out;
+    std::vector<StringTable> tables;
+    /// Contents of bignums, which are not held by the value
+    std::vector<std::vector<std::byte>> contents;
+
+    void head(MajorType major, std::uint64_t arg) {
+      auto const pos = out.size();
+      out.resize(pos + head_size(arg));
+      write_head(out.begin() + pos, major, arg);
+    }
+
+    void string(MajorType major, void const* p, std::size_t n) {
+      auto& table = tables.back();
+      auto& seen = major == MajorType::Bstr ? table.bstrs : table.tstrs;
+      std::string_view const key(static_cast<char const*>(p), n);
+      if (auto it = seen.find(key); it != seen.end()) {
+        head(MajorType::Tag, stringref_tag);
+        head(MajorType::Uint, it->second);
+        return;
+      }
+      if (n >= stringref_length_min(table.size))
+        seen.emplace(key, table.size++);
+      head(major, n);
+      auto const first = static_cast<std::byte const*>(p);
+      out.insert(out.end(), first, first + n);
+    }
+
+    void operator()(CBORUint const& x) {
+      head(MajorType::Uint, static_cast<std::uint64_t>(CBOR_U64(x)));
+    }
+
+    void operator()(CBORNint const& x) {
+      head(MajorType::Nint, static_cast<std::uint64_t>(CBOR_U64(x)));
+    }
+
+    void operator()(CBORBstr const& x) {
+      string(MajorType::Bstr, x.data(), x.size());
+    }
+
+    void operator()(CBORTstr const& x) {
+      string(MajorType::Tstr, x.data(), x.size());
+    }
+
+    void operator()(CBORArray const& x) {
+      head(MajorType::Array, x.size());
+      for (auto const& element : x)
+        element.visit(*this);
+    }
+
+    void operator()(CBORMap const& x) {
+      head(MajorType::Map, x.size());
+      for (CBORMap::size_type i = 0; i < x.size(); ++i) {
+        x.key(i).visit(*this);
+        x.value(i).visit(*this);
+      }
+    }
+
+    void operator()(CBORTag const& x) {
+      auto const tag = static_cast<std::uint64_t>(x.tag());
+      head(MajorType::Tag, tag);
+      // a nested namespace starts with an empty table
+      if (tag == stringref_namespace_tag) tables.emplace_back();
+      x.value().visit(*this);
+      if (tag == stringref_namespace_tag) tables.pop_back();
+    }
+
+    void operator()(CBORSimple const& x) {
+      head(MajorType::Simple, static_cast<std::uint8_t>(x));
+    }
+
+    void operator()(CBORFloat const& x) {
+      auto const pos = out.size();
+      out.resize(pos + float_size(x, EncodeMode::Preferred));
+      write_float(out.begin() + pos, x, EncodeMode::Preferred);
+    }
+
+    void operator()(CBORCustom const& x) { (*this)(x.as_tag()); }
+
+    void operator()(CBORBignum const& x) {
+      if (x.fits_u64())
+        return head(x.is_negative() ? MajorType::Nint : MajorType::Uint,
+                    x.low_limb());
+      // the decoder sees the content as a byte string like any other,
+      // which the table may refer to until the end
+      auto& bytes = contents.emplace_back(x.byte_size());
+      x.write_bytes(bytes.data());
+      head(MajorType::Tag, x.is_negative() ? 3 : 2);
+      string(MajorType::Bstr, bytes.data(), bytes.size());
+    }
+  };
+
+} // namespace
+
+auto encode_stringref(CBORValue const& value) -> std::vector<std::byte> {
+  std::vector<std::byte> out;
+  StringRefEncoder encoder{out, {}, {}};
+  encoder.head(MajorType::Tag, stringref_namespace_tag);
+  encoder.tables.emplace_back();
+  value.visit(encoder);
+  return out;
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_stringref() {
+  return "GLVI CBOR STRINGREF";
+}
@@ -0,0 +1,56 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_value.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+   Tag numbers of the stringref extension,
+   see http://cbor.schmorp.de/stringref
+ */
+constexpr std::uint64_t stringref_tag = 25;
+constexpr std::uint64_t stringref_namespace_tag = 256;
+
+/**
+   Returns the minimum length of a string that is assigned index
+   `index` in a stringref namespace: only strings longer than a
+   reference to them are entered into the table.
+ */
+constexpr auto stringref_length_min(std::uint64_t index) noexcept
+    -> std::size_t {
+  if (index < 24) return 3;
+  if (index <= 0xff) return 4;
+  if (index <= 0xffff) return 5;
+  if (index <= 0xffffffff) return 7;
+  return 11;
+}
+
+/**
+   Encodes `value` within a stringref namespace (tag 256), using
+   preferred serialisation except that repeated byte and text strings
+   are replaced by references (tag 25) wherever these are shorter.
+
+   Map entries are written in the order given, as the references
+   depend on the order in which strings appear.
+
+   The parser resolves references while decoding, and drops the
+   namespace tag; tags 25 in `value` itself would be taken for
+   references.
+ */
+auto encode_stringref(CBORValue const& value) -> std::vector<std::byte>;
@@ -48,7 +48,7 @@ public:
   template<typename CBORMajorType>
   explicit CBORTag(CBOR_U64 n, CBORMajorType&& v)
     : number(n)
-    , storage(std::make_shared<value_type>(std::move(v)))
+    , storage(std::make_shared<value_type>(std::forward<CBORMajorType>(v)))
   {}
 
   CBOR_U64 tag() const noexcept { return number; }
@@ -0,0 +1,98 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_tag_registry.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void TagRegistry::add(std::uint64_t tag, TagDecoder decoder) {
+  decoders.insert_or_assign(tag, std::move(decoder));
+}
+
+auto TagRegistry::decode(CBORTag&& tagged) const -> CBORValue {
+  auto const it = decoders.find(static_cast<std::uint64_t>(tagged.tag()));
+  if (it == decoders.end()) return std::move(tagged);
+  return it->second(std::move(tagged));
+}
+
+namespace {
+
+  using std::chrono::nanoseconds;
+
+  /**
+     Converts `seconds` to nanoseconds, if representable.
+   */
+  auto to_nanoseconds(double seconds) noexcept -> std::optional<nanoseconds> {
+    // 2^63 is exact as a double, and the first value out of range
+    constexpr double limit = 0x1p63;
+    auto const ns = std::round(seconds * 1e9);
+    if (not (ns >= -limit and ns < limit)) return std::nullopt;
+    return nanoseconds(static_cast<nanoseconds::rep>(ns));
+  }
+
+  auto to_nanoseconds(std::uint64_t seconds, bool negative) noexcept
+      -> std::optional<nanoseconds> {
+    constexpr std::uint64_t max =
+        std::numeric_limits<nanoseconds::rep>::max() / 1'000'000'000;
+    // major type 1 encodes -1 - n
+    if (seconds >= max) return std::nullopt;
+    auto const s = static_cast<nanoseconds::rep>(seconds);
+    return nanoseconds((negative ? -1 - s : s) * 1'000'000'000);
+  }
+
+} // namespace
+
+auto tag_decoders::DateTime::decode(CBORTag&& tagged) -> CBORValue {
+  auto const opt_tstr = tagged.value().as_tstr_cref();
+  if (not opt_tstr) return std::move(tagged);
+  auto const& tstr = opt_tstr->get();
+  auto const time =
+      parse_rfc3339(std::u8string_view(tstr.data(), tstr.size()));
+  if (not time) return std::move(tagged);
+  return CBORCustom(std::move(tagged), *time);
+}
+
+auto tag_decoders::EpochTime::decode(CBORTag&& tagged) -> CBORValue {
+  auto const& content = tagged.value();
+  std::optional<nanoseconds> since_epoch;
+  if (auto const n = content.as_uint()) {
+    since_epoch = to_nanoseconds(static_cast<std::uint64_t>(*n), false);
+  } else if (auto const n = content.as_nint()) {
+    since_epoch = to_nanoseconds(static_cast<std::uint64_t>(*n), true);
+  } else if (content.is_float()) {
+    content.visit([&](auto const& x) {
+      if constexpr (std::same_as<std::remove_cvref_t<decltype(x)>, CBORFloat>)
+        since_epoch = to_nanoseconds(x.value);
+    });
+  }
+  if (not since_epoch) return std::move(tagged);
+  return CBORCustom(std::move(tagged), type(*since_epoch));
+}
+
+auto tag_decoders::Uuid::decode(CBORTag&& tagged) -> CBORValue {
+  auto const opt_bstr = tagged.value().as_bstr_cref();
+  if (not opt_bstr or opt_bstr->get().size() != type().size())
+    return std::move(tagged);
+  type uuid;
+  std::copy_n(opt_bstr->get().data(), uuid.size(), uuid.begin());
+  return CBORCustom(std::move(tagged), uuid);
+}
+
+[[maybe_unused]]
+char const *_glvi_cbor_tag_registry() {
+  return "GLVI CBOR TAG REGISTRY";
+}
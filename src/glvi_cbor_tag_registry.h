@@ -0,0 +1,180 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_datetime.h"
+#include "glvi_cbor_scanner.h"
+#include "glvi_cbor_value.h"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+/**
+   Converts a tagged value while it is being parsed, e.g. into a
+   `CBORCustom` holding a user type. Returns the converted value, or
+   `tagged` itself if the content is not understood.
+ */
+using TagDecoder = std::function<CBORValue(CBORTag&& tagged)>;
+
+/**
+   Tag decoders by tag number, consulted by the parser as soon as the
+   content of a tag is complete, so tagged values are converted in the
+   same pass. Tags without a decoder stay `CBORTag`s.
+
+       TagRegistry tags;
+       tags.add(37, tag_decoders::Uuid::decode);
+       auto value = decode(bytes, tags);
+ */
+class TagRegistry {
+  std::unordered_map<std::uint64_t, TagDecoder> decoders;
+
+public:
+  virtual ~TagRegistry() = default;
+
+  /**
+     Registers `decoder` for tag number `tag`, replacing any decoder
+     registered before.
+   */
+  void add(std::uint64_t tag, TagDecoder decoder);
+
+  /**
+     Converts `tagged` with the decoder registered for its tag number.
+   */
+  virtual auto decode(CBORTag&& tagged) const -> CBORValue;
+
+  /**
+     Converts `tagged` as above, for a parser that enforces `limits`.
+     Decoders that decode CBOR embedded in the content enforce the
+     same limits on it.
+   */
+  virtual auto decode(CBORTag&& tagged, DecodeLimits const& limits) const
+      -> CBORValue {
+    (void)limits;
+    return decode(std::move(tagged));
+  }
+};
+
+/**
+   Tag decoders known at compile time: a type with the tag number as
+   `tag`, and the conversion as a static member function `decode`.
+ */
+template <typename Decoder>
+concept static_tag_decoder = requires(CBORTag&& tagged) {
+  { Decoder::tag } -> std::convertible_to<std::uint64_t>;
+  { Decoder::decode(std::move(tagged)) } -> std::same_as<CBORValue>;
+};
+
+/**
+   Static tag decoders that also take the `DecodeLimits` of the parser
+ */
+template <typename Decoder>
+concept limited_tag_decoder =
+    static_tag_decoder<Decoder> and
+    requires(CBORTag&& tagged, DecodeLimits const& limits) {
+      { Decoder::decode(std::move(tagged), limits) }
+          -> std::same_as<CBORValue>;
+    };
+
+/**
+   Tag registry with a fixed set of `Decoders`, dispatched on the tag
+   number without a lookup; the comparisons against constant tag
+   numbers compile to a switch. Decoders added at run time handle the
+   remaining tags, as in `TagRegistry`.
+ */
+template <static_tag_decoder... Decoders>
+class StaticTagRegistry : public TagRegistry {
+  static constexpr auto unique_tags() -> bool {
+    std::array<std::uint64_t, sizeof...(Decoders)> tags{Decoders::tag...};
+    for (std::size_t i = 0; i < tags.size(); ++i)
+      for (std::size_t j = 0; j < i; ++j)
+        if (tags[i] == tags[j]) return false;
+    return true;
+  }
+  static_assert(unique_tags(), "each tag needs exactly one decoder");
+
+  template <static_tag_decoder Decoder>
+  static auto decode_with(CBORTag&& tagged, DecodeLimits const* limits)
+      -> CBORValue {
+    if constexpr (limited_tag_decoder<Decoder>)
+      if (limits) return Decoder::decode(std::move(tagged), *limits);
+    return Decoder::decode(std::move(tagged));
+  }
+
+  auto dispatch(CBORTag&& tagged, DecodeLimits const* limits) const
+      -> CBORValue {
+    auto const n = static_cast<std::uint64_t>(tagged.tag());
+    std::optional<CBORValue> result;
+    (void)((n == Decoders::tag and
+            (result.emplace(decode_with<Decoders>(std::move(tagged), limits)),
+             true)) or
+           ...);
+    if (result) return *std::move(result);
+    return TagRegistry::decode(std::move(tagged));
+  }
+
+public:
+  auto decode(CBORTag&& tagged) const -> CBORValue override {
+    return dispatch(std::move(tagged), nullptr);
+  }
+
+  auto decode(CBORTag&& tagged, DecodeLimits const& limits) const
+      -> CBORValue override {
+    return dispatch(std::move(tagged), &limits);
+  }
+};
+
+/**
+   Decoders for some of the tags registered with IANA
+ */
+namespace tag_decoders {
+
+  /**
+     Tag 0: standard date/time string, see RFC 8949 §3.4.1. Decodes
+     into a `CBORTime` with `parse_rfc3339`; strings it rejects stay
+     tagged.
+   */
+  struct DateTime {
+    using type = CBORTime;
+    static constexpr std::uint64_t tag = 0;
+    static auto decode(CBORTag&& tagged) -> CBORValue;
+  };
+
+  /**
+     Tag 1: epoch-based date/time, see RFC 8949 §3.4.2. Decodes into
+     a `CBORTime`; times outside its range of about ±292 years stay
+     tagged.
+   */
+  struct EpochTime {
+    using type = CBORTime;
+    static constexpr std::uint64_t tag = 1;
+    static auto decode(CBORTag&& tagged) -> CBORValue;
+  };
+
+  /**
+     Tag 37: UUID, see RFC 9562 §4. Decodes a byte string of 16 bytes
+     into a `std::array<std::byte, 16>`.
+   */
+  struct Uuid {
+    using type = std::array<std::byte, 16>;
+    static constexpr std::uint64_t tag = 37;
+    static auto decode(CBORTag&& tagged) -> CBORValue;
+  };
+
+} // namespace tag_decoders
@@ -39,12 +39,12 @@ public:
   /**
      Move-constructs a CBOR text string from a C++ UTF-8 string.
    */
-  explicit CBORTstr(storage_type&& other) : storage(std::move(other)) {}
+  constexpr explicit CBORTstr(storage_type&& other) : storage(std::move(other)) {}
 
   /**
      Copy-constructs a CBOR text string from a C++ UTF-8 string.
    */
-  explicit CBORTstr(storage_type const& other) : storage(other) {}
+  constexpr explicit CBORTstr(storage_type const& other) : storage(other) {}
 
   /**
      Move-assigns a CBOR text string from a C++ UTF-8 string.
@@ -67,6 +67,11 @@ public:
    */
   constexpr auto size() const noexcept { return storage.size(); }
 
+  /**
+     Returns a pointer to the first byte of the text string.
+   */
+  constexpr auto data() const noexcept { return storage.data(); }
+
   /**
      Returns the byte at index `i` from the byte string
    */
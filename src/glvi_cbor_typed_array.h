@@ -0,0 +1,365 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include "glvi_cbor_float.h"
+#include "glvi_cbor_head.h"
+#include "glvi_cbor_value.h"
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+/**
+   Errors specific to typed arrays
+ */
+namespace typed_array_error {
+
+  /**
+     This error indicates that the value is not a byte string tagged
+     with one of the typed array tags 64..87 of RFC 8746, or that it
+     is tagged with the reserved tag 76.
+   */
+  struct NotTypedArray {};
+
+  /**
+     This error indicates that the elements cannot be represented
+     without loss in the requested element type, or that the element
+     type (128-bit floats, tags 83 and 87) is not supported.
+   */
+  struct NotRepresentable {};
+
+  /**
+     This error indicates that the payload length is not a multiple
+     of the element size.
+   */
+  struct BadLength {
+    std::size_t length;
+  };
+
+  /**
+     Errors that can occur when accessing typed arrays
+   */
+  using TypedArrayError =
+      std::variant<NotTypedArray, NotRepresentable, BadLength>;
+
+} // namespace typed_array_error
+
+/// @copydoc typed_array_error::TypedArrayError
+using typed_array_error::TypedArrayError;
+
+/**
+   Element types of typed arrays, see RFC 8746 §2.1
+ */
+struct TypedArrayLayout {
+  enum class Kind : std::uint8_t { Unsigned, Signed, Float };
+
+  Kind kind;
+  /// size of one element in bytes
+  std::uint8_t size;
+  /// byte order of the elements
+  std::endian endian;
+  /// uint8 elements with clamped arithmetic (tag 68)
+  bool clamped = false;
+
+  /**
+     Decodes the layout from a tag number, if it is one of the typed
+     array tags 64..87.
+   */
+  static constexpr auto from_tag(std::uint64_t tag) noexcept
+      -> std::optional<TypedArrayLayout> {
+    if (tag < 64 or tag > 87) return std::nullopt;
+    auto const f = (tag >> 4) & 1;
+    auto const s = (tag >> 3) & 1;
+    auto const e = (tag >> 2) & 1;
+    auto const ll = tag & 3;
+    auto const endian = e ? std::endian::little : std::endian::big;
+    if (f) {
+      return TypedArrayLayout{Kind::Float, std::uint8_t(2 << ll), endian};
+    }
+    auto const size = std::uint8_t(1 << ll);
+    if (size == 1) {
+      // the endianness bit marks clamped uint8; sint8 has no variant
+      if (s and e) return std::nullopt;
+      return TypedArrayLayout{s ? Kind::Signed : Kind::Unsigned, 1,
+                              std::endian::big, not s and e};
+    }
+    return TypedArrayLayout{s ? Kind::Signed : Kind::Unsigned, size, endian};
+  }
+
+  /**
+     Returns the tag number for this layout.
+   */
+  constexpr auto tag() const noexcept -> std::uint64_t {
+    std::uint64_t const ll = std::countr_zero(
+        static_cast<unsigned>(kind == Kind::Float ? size / 2 : size));
+    std::uint64_t const e = size == 1 ? clamped : endian == std::endian::little;
+    return 64 | std::uint64_t(kind == Kind::Float) << 4 |
+           std::uint64_t(kind == Kind::Signed) << 3 | e << 2 | ll;
+  }
+
+  /**
+     Returns the layout of elements of type `T` in byte order `endian`.
+   */
+  template <typename T>
+    requires std::integral<T> or std::floating_point<T>
+  static constexpr auto of(std::endian endian = std::endian::native) noexcept
+      -> TypedArrayLayout {
+    if constexpr (std::floating_point<T>)
+      return {Kind::Float, sizeof(T), sizeof(T) == 1 ? std::endian::big : endian};
+    else if constexpr (std::signed_integral<T>)
+      return {Kind::Signed, sizeof(T), sizeof(T) == 1 ? std::endian::big : endian};
+    else
+      return {Kind::Unsigned, sizeof(T), sizeof(T) == 1 ? std::endian::big : endian};
+  }
+
+  /**
+     Whether every element of this layout is exactly representable as
+     a `T`.
+   */
+  template <typename T> constexpr auto fits() const noexcept -> bool {
+    switch (kind) {
+    case Kind::Unsigned:
+      if constexpr (std::unsigned_integral<T>) return size <= sizeof(T);
+      else if constexpr (std::signed_integral<T>) return size < sizeof(T);
+      else return false;
+    case Kind::Signed:
+      if constexpr (std::signed_integral<T>) return size <= sizeof(T);
+      else return false;
+    case Kind::Float:
+      if constexpr (std::floating_point<T>)
+        return size <= 8 and size <= sizeof(T);
+      else return false;
+    }
+    return false;
+  }
+};
+
+/**
+   Elements of a typed array, either viewed in place, or converted
+   into a buffer owned by this object.
+ */
+template <typename T> class TypedArray {
+  std::vector<T> owned;
+  std::span<T const> elements;
+  bool borrowed;
+
+public:
+  explicit TypedArray(std::span<T const> view) noexcept
+      : elements{view}, borrowed{true} {}
+
+  explicit TypedArray(std::vector<T>&& buffer) noexcept
+      : owned{std::move(buffer)}, elements{owned}, borrowed{false} {}
+
+  // Moving a vector keeps its buffer, so `elements` stays valid.
+  TypedArray(TypedArray&&) noexcept = default;
+  TypedArray& operator=(TypedArray&&) noexcept = default;
+  TypedArray(TypedArray const&) = delete;
+  TypedArray& operator=(TypedArray const&) = delete;
+
+  auto span() const noexcept -> std::span<T const> { return elements; }
+
+  /**
+     Whether the elements are viewed in place, without a copy.
+   */
+  auto is_borrowed() const noexcept -> bool { return borrowed; }
+};
+
+namespace typed_array {
+
+  /// Unsigned integer type of `N` bytes
+  template <std::size_t N>
+  using bits_t = std::conditional_t<
+      N == 1, std::uint8_t,
+      std::conditional_t<N == 2, std::uint16_t,
+                         std::conditional_t<N == 4, std::uint32_t,
+                                            std::uint64_t>>>;
+
+  /**
+     Loads `n` elements of `N` bytes each in byte order `endian`.
+     Written as a plain loop over `std::byteswap`, which compilers
+     turn into vector byte shuffles.
+   */
+  template <std::size_t N>
+  void load(std::byte const* p, std::size_t n, std::endian endian,
+            bits_t<N>* out) noexcept {
+    if (n > 0) std::memcpy(out, p, n * N);
+    if constexpr (N > 1) {
+      if (endian != std::endian::native)
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = std::byteswap(out[i]);
+    }
+  }
+
+  /**
+     Converts `n` elements of `layout` at `p` to `T`, which must fit.
+   */
+  template <typename T, std::size_t N>
+  void convert(TypedArrayLayout layout, std::byte const* p, std::size_t n,
+               T* out) {
+    using bits = bits_t<N>;
+    std::vector<bits> raw(n);
+    load<N>(p, n, layout.endian, raw.data());
+    using Kind = TypedArrayLayout::Kind;
+    if (layout.kind == Kind::Float) {
+      if constexpr (std::floating_point<T>) {
+        if constexpr (N == 2) {
+          if constexpr (std::same_as<T, double>) {
+            halves_to_doubles(raw, std::span<double>(out, n));
+          } else {
+            for (std::size_t i = 0; i < n; ++i)
+              out[i] = static_cast<T>(from_half(raw[i]));
+          }
+        } else if constexpr (N == 4) {
+          for (std::size_t i = 0; i < n; ++i)
+            out[i] = static_cast<T>(std::bit_cast<float>(raw[i]));
+        } else if constexpr (N == 8) {
+          for (std::size_t i = 0; i < n; ++i)
+            out[i] = static_cast<T>(std::bit_cast<double>(raw[i]));
+        }
+      }
+    } else if (layout.kind == Kind::Signed) {
+      for (std::size_t i = 0; i < n; ++i)
+        out[i] = static_cast<T>(static_cast<std::make_signed_t<bits>>(raw[i]));
+    } else {
+      for (std::size_t i = 0; i < n; ++i)
+        out[i] = static_cast<T>(raw[i]);
+    }
+  }
+
+  /**
+     Stores `elements` at `p` in byte order `endian`.
+   */
+  template <typename T>
+  void store(std::byte* p, std::span<T const> elements,
+             std::endian endian) noexcept {
+    if (elements.empty()) return;
+    std::memcpy(p, elements.data(), elements.size_bytes());
+    if constexpr (sizeof(T) > 1) {
+      using bits = bits_t<sizeof(T)>;
+      if (endian != std::endian::native) {
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+          bits x;
+          std::memcpy(&x, p + i * sizeof x, sizeof x);
+          x = std::byteswap(x);
+          std::memcpy(p + i * sizeof x, &x, sizeof x);
+        }
+      }
+    }
+  }
+
+} // namespace typed_array
+
+/**
+   Accesses the typed array with tag number `tag` and payload
+   `payload` as elements of type `T`.
+
+   If the elements have type `T`, native byte order, and the payload
+   is suitably aligned, the result views `payload` in place and is
+   valid as long as `payload` is. Otherwise, the elements are
+   byte-swapped or widened into a buffer owned by the result.
+ */
+template <typename T>
+  requires std::integral<T> or std::floating_point<T>
+auto typed_array_as(std::uint64_t tag, std::span<std::byte const> payload)
+    -> std::expected<TypedArray<T>, TypedArrayError> {
+  auto const opt_layout = TypedArrayLayout::from_tag(tag);
+  if (not opt_layout)
+    return std::unexpected(typed_array_error::NotTypedArray{});
+  auto const layout = *opt_layout;
+  if (not layout.fits<T>())
+    return std::unexpected(typed_array_error::NotRepresentable{});
+  if (payload.size() % layout.size != 0)
+    return std::unexpected(typed_array_error::BadLength{payload.size()});
+  auto const n = payload.size() / layout.size;
+  auto const exact = TypedArrayLayout::of<T>();
+  auto const aligned =
+      reinterpret_cast<std::uintptr_t>(payload.data()) % alignof(T) == 0;
+  if (layout.kind == exact.kind and layout.size == exact.size and
+      (layout.size == 1 or layout.endian == std::endian::native) and aligned) {
+    return TypedArray<T>(
+        std::span(reinterpret_cast<T const*>(payload.data()), n));
+  }
+  std::vector<T> buffer(n);
+  auto const p = payload.data();
+  switch (layout.size) {
+  case 1: typed_array::convert<T, 1>(layout, p, n, buffer.data()); break;
+  case 2: typed_array::convert<T, 2>(layout, p, n, buffer.data()); break;
+  case 4: typed_array::convert<T, 4>(layout, p, n, buffer.data()); break;
+  default: typed_array::convert<T, 8>(layout, p, n, buffer.data()); break;
+  }
+  return TypedArray<T>(std::move(buffer));
+}
+
+/**
+   Accesses the decoded typed array `value`, a byte string tagged
+   with one of the tags 64..87, as elements of type `T`. A borrowed
+   result views the byte string inside `value`.
+ */
+template <typename T>
+  requires std::integral<T> or std::floating_point<T>
+auto typed_array_as(CBORValue const& value)
+    -> std::expected<TypedArray<T>, TypedArrayError> {
+  auto const opt_tag = value.as_tag_cref();
+  if (not opt_tag)
+    return std::unexpected(typed_array_error::NotTypedArray{});
+  auto const& tag = opt_tag->get();
+  auto const opt_bstr = tag.value().as_bstr_cref();
+  if (not opt_bstr)
+    return std::unexpected(typed_array_error::NotTypedArray{});
+  auto const& bstr = opt_bstr->get();
+  return typed_array_as<T>(static_cast<std::uint64_t>(tag.tag()),
+                           std::span(bstr.data(), bstr.size()));
+}
+
+/**
+   Appends the encoding of `elements` as a typed array in byte order
+   `endian` to `out`: tag, byte string head, and the elements.
+ */
+template <typename T, std::size_t Extent>
+  requires std::integral<T> or std::floating_point<T>
+void append_typed_array(std::vector<std::byte>& out,
+                        std::span<T const, Extent> elements,
+                        std::endian endian = std::endian::native) {
+  auto const tag = TypedArrayLayout::of<T>(endian).tag();
+  auto const length = elements.size_bytes();
+  auto const pos = out.size();
+  out.resize(pos + head_size(tag) + head_size(length) + length);
+  auto it = write_head(out.begin() + pos, MajorType::Tag, tag);
+  it = write_head(it, MajorType::Bstr, length);
+  // `it` is the end of `out` if there are no elements
+  typed_array::store<T>(out.data() + (it - out.begin()), elements, endian);
+}
+
+/**
+   Makes a typed array value from `elements` in byte order `endian`.
+ */
+template <typename T, std::size_t Extent>
+  requires std::integral<T> or std::floating_point<T>
+auto make_typed_array(std::span<T const, Extent> elements,
+                      std::endian endian = std::endian::native) -> CBORTag {
+  std::vector<std::byte> payload(elements.size_bytes());
+  typed_array::store<T>(payload.data(), elements, endian);
+  return CBORTag(CBOR_U64{TypedArrayLayout::of<T>(endian).tag()},
+                 CBORBstr(std::move(payload)));
+}
@@ -0,0 +1,206 @@
+//  -*- mode: c++; coding: utf-8-unix; -*-
+//  cbor: Utilities for decoding Concise Binary Object Representation
+//  Copyright (C) 2025 GLVI Gesellschaft für Luftverkehrsinformatik mbH.
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or (at
+//  your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+#include "glvi_cbor_encoder.h"
+#include "glvi_cbor_parser.h"
+#include "glvi_cbor_typed_array.h"
+#include <array>
+#include <cstring>
+#include <dejagnu.h>
+#include <limits>
+#include <source_location>
+
+using vec_byte = std::vector<std::byte>;
+
+template <typename... Octets> auto bytes(Octets... octets) -> vec_byte {
+  return vec_byte{std::byte(octets)...};
+}
+
+static_assert(TypedArrayLayout::of<std::uint8_t>().tag() == 64);
+static_assert(TypedArrayLayout::of<std::uint16_t>(std::endian::big).tag() == 65);
+static_assert(TypedArrayLayout::of<std::int32_t>(std::endian::little).tag() == 78);
+static_assert(TypedArrayLayout::of<float>(std::endian::little).tag() == 85);
+static_assert(TypedArrayLayout::of<double>(std::endian::big).tag() == 82);
+static_assert(TypedArrayLayout::from_tag(68)->clamped);
+static_assert(TypedArrayLayout::from_tag(84)->size == 2);
+static_assert(not TypedArrayLayout::from_tag(76));
+static_assert(not TypedArrayLayout::from_tag(88));
+
+#define TEST_CASE(name) auto test_##name() noexcept try
+
+class CBORTypedArrayTests : TestState {
+  unsigned numFailed_ = 0;
+
+  void fail(std::string msg) {
+    TestState::fail(std::move(msg));
+    numFailed_++;
+  }
+
+  /**
+     Decodes `encoded`, which must hold a single data item.
+   */
+  static auto decode_bytes(vec_byte const& encoded) -> CBORValue {
+    std::vector<std::uint8_t> octets;
+    for (auto b : encoded) octets.push_back(std::to_integer<std::uint8_t>(b));
+    return decode(octets).value();
+  }
+
+public:
+  inline auto success() const noexcept { return numFailed_ == 0; }
+  inline auto failure() const noexcept { return numFailed_ > 0; }
+
+  TEST_CASE(tag_layouts)
+  {
+    // every tag in 64..87 except 76 round-trips through its layout
+    for (std::uint64_t tag = 64; tag <= 87; ++tag) {
+      auto const layout = TypedArrayLayout::from_tag(tag);
+      if (tag == 76 ? layout.has_value()
+                    : (not layout or layout->tag() != tag))
+        return fail(std::source_location::current().function_name());
+    }
+    return pass(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(encode_both_endians)
+  {
+    std::array<std::uint16_t, 2> const values{0x0102, 0xa0b0};
+    vec_byte big, little;
+    append_typed_array(big, std::span(values), std::endian::big);
+    append_typed_array(little, std::span(values), std::endian::little);
+    // no elements: the payload is empty
+    vec_byte empty;
+    append_typed_array(empty, std::span<std::uint16_t const>{},
+                       std::endian::big);
+    if (big == bytes(0xd8, 65, 0x44, 0x01, 0x02, 0xa0, 0xb0) and
+        little == bytes(0xd8, 69, 0x44, 0x02, 0x01, 0xb0, 0xa0) and
+        empty == bytes(0xd8, 65, 0x40)) {
+      auto const value = make_typed_array(std::span(values), std::endian::big);
+      if (encode(CBORValue(value)) == big)
+        return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(view_native)
+  {
+    std::array<std::int32_t, 3> const values{-1, 0, 1 << 30};
+    vec_byte encoded;
+    append_typed_array(encoded, std::span(values));
+    auto const value = decode_bytes(encoded);
+    auto const array = typed_array_as<std::int32_t>(value);
+    if (array and array->is_borrowed() and
+        std::ranges::equal(array->span(), values)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(swap_and_widen)
+  {
+    constexpr auto foreign = std::endian::native == std::endian::little
+                                 ? std::endian::big
+                                 : std::endian::little;
+    std::array<std::int16_t, 3> const values{-2, 300, -32768};
+    vec_byte encoded;
+    append_typed_array(encoded, std::span(values), foreign);
+    auto const value = decode_bytes(encoded);
+    auto const same = typed_array_as<std::int16_t>(value);
+    auto const wide = typed_array_as<std::int64_t>(value);
+    auto const bad = typed_array_as<std::uint64_t>(value);
+    if (same and not same->is_borrowed() and
+        std::ranges::equal(same->span(), values) and wide and
+        std::ranges::equal(wide->span(), values) and not bad and
+        std::holds_alternative<typed_array_error::NotRepresentable>(
+            bad.error())) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(misaligned)
+  {
+    // the payload starts at an odd offset inside `storage`
+    vec_byte storage(9);
+    float const one = 1.0f;
+    std::memcpy(storage.data() + 1, &one, sizeof one);
+    auto const payload = std::span(storage).subspan(1, sizeof one);
+    auto const tag = TypedArrayLayout::of<float>().tag();
+    auto const array = typed_array_as<float>(tag, payload);
+    if (array and not array->is_borrowed() and array->span().size() == 1 and
+        array->span()[0] == 1.0f) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(half_floats)
+  {
+    // float16 big endian: 1.0, -2.0, 65504, infinity
+    auto const value = decode_bytes(bytes(0xd8, 80, 0x48, 0x3c, 0x00, 0xc0,
+                                          0x00, 0x7b, 0xff, 0x7c, 0x00));
+    auto const doubles = typed_array_as<double>(value);
+    auto const floats = typed_array_as<float>(value);
+    std::array<double, 4> const expected{
+        1.0, -2.0, 65504.0, std::numeric_limits<double>::infinity()};
+    if (doubles and std::ranges::equal(doubles->span(), expected) and
+        floats and std::ranges::equal(floats->span(), expected)) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+
+  TEST_CASE(rejects)
+  {
+    auto const odd = decode_bytes(bytes(0xd8, 66, 0x43, 0x00, 0x00, 0x01));
+    auto const plain = decode_bytes(bytes(0x43, 0x00, 0x00, 0x01));
+    auto const wide = typed_array_as<std::uint32_t>(odd);
+    auto const untagged = typed_array_as<std::uint8_t>(plain);
+    if (not wide and
+        std::holds_alternative<typed_array_error::BadLength>(wide.error()) and
+        not untagged and
+        std::holds_alternative<typed_array_error::NotTypedArray>(
+            untagged.error())) {
+      return pass(std::source_location::current().function_name());
+    }
+    return fail(std::source_location::current().function_name());
+  } catch (...) {
+    return fail(std::source_location::current().function_name());
+  }
+};
+
+int main(int argc, char *argv[]) {
+  CBORTypedArrayTests testSuite{};
+  testSuite.test_tag_layouts();
+  testSuite.test_encode_both_endians();
+  testSuite.test_view_native();
+  testSuite.test_swap_and_widen();
+  testSuite.test_misaligned();
+  testSuite.test_half_floats();
+  testSuite.test_rejects();
+  return testSuite.failure();
+}
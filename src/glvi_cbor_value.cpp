@@ -31,6 +31,8 @@ static_assert(std::is_nothrow_constructible_v<CBORValue, CBORMap&&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORTag&&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORSimple&&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORFloat&&>);
+static_assert(std::is_nothrow_constructible_v<CBORValue, CBORCustom&&>);
+static_assert(std::is_nothrow_constructible_v<CBORValue, CBORBignum&&>);
 
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORUint const&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORNint const&>);
@@ -41,6 +43,8 @@ static_assert(std::is_constructible_v<CBORValue, CBORMap const&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORTag const&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORSimple const&>);
 static_assert(std::is_nothrow_constructible_v<CBORValue, CBORFloat const&>);
+static_assert(std::is_nothrow_constructible_v<CBORValue, CBORCustom const&>);
+static_assert(std::is_constructible_v<CBORValue, CBORBignum const&>);
 
 static_assert(CBORValue().is_simple());
 static_assert(CBORValue(CBORUint()).is_uint());
@@ -16,7 +16,9 @@
 //  along with this program. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 #include "glvi_cbor_array.h"
+#include "glvi_cbor_bignum.h"
 #include "glvi_cbor_bstr.h"
+#include "glvi_cbor_custom.h"
 #include "glvi_cbor_float.h"
 #include "glvi_cbor_map.h"
 #include "glvi_cbor_nint.h"
@@ -37,7 +39,8 @@ class CBORValue {
 public:
   using storage_type =
       std::variant<CBORUint, CBORNint, CBORBstr, CBORTstr, CBORArray, CBORMap,
-                   CBORTag, CBORSimple, CBORFloat>;
+                   CBORTag, CBORSimple, CBORFloat, CBORCustom,
+                   CBORBignum>;
 
 private:
   storage_type storage;
@@ -51,7 +54,8 @@ public:
   constexpr explicit CBORValue() noexcept : storage(CBOR_Undefined) {}
 
   /**
-     Move-constructs a CBOR value from a value of one of the CBOR major types.
+     Constructs a CBOR value from a value of one of the CBOR major types,
+     moving from rvalues and copying lvalues.
      @tparam Type CBOR major type
      @param value of `Type`
    */
@@ -59,7 +63,7 @@ public:
     requires std::constructible_from<storage_type, Type&&>
   constexpr CBORValue(Type&& value) noexcept(
       std::is_nothrow_constructible_v<storage_type, Type&&>)
-      : storage(std::move(value)) {}
+      : storage(std::forward<Type>(value)) {}
 
   /**
      Copy-constructs a CBOR value from a value of one of the CBOR major types.
@@ -108,6 +112,14 @@ public:
     return std::holds_alternative<CBORFloat>(storage);
   }
 
+  constexpr auto is_custom() const noexcept {
+    return std::holds_alternative<CBORCustom>(storage);
+  }
+
+  constexpr auto is_bignum() const noexcept {
+    return std::holds_alternative<CBORBignum>(storage);
+  }
+
   auto as_uint() const noexcept -> std::optional<CBOR_U64> {
     using type = CBORUint;
     if (std::holds_alternative<type>(storage)) {
@@ -278,4 +290,89 @@ public:
   }
 
   auto move_tag(CBORTag& target) noexcept -> bool;
+
+  /**
+     If the CBOR value holds a bignum, returns a constant reference to
+     it; otherwise, returns an empty optional.
+   */
+  auto as_bignum_cref() const noexcept
+      -> std::optional<std::reference_wrapper<CBORBignum const>> {
+    using type = CBORBignum;
+    if (std::holds_alternative<type>(storage)) {
+      return std::cref(std::get<type>(storage));
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  /**
+     If the CBOR value holds a custom value, returns a constant
+     reference to it; otherwise, returns an empty optional.
+   */
+  auto as_custom_cref() const noexcept
+      -> std::optional<std::reference_wrapper<CBORCustom const>> {
+    using type = CBORCustom;
+    if (std::holds_alternative<type>(storage)) {
+      return std::cref(std::get<type>(storage));
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  template <typename Visitor>
+  constexpr auto visit(Visitor&& visitor) const& {
+    return std::visit(std::forward<Visitor>(visitor), storage);
+  }
+
+  template <typename Visitor>
+  constexpr auto visit(Visitor&& visitor) && {
+    return std::visit(std::forward<Visitor>(visitor), std::move(storage));
+  }
 };
+
+constexpr CBORArray::CBORArray(storage_type&& other) noexcept
+    : elements(std::move(other)) {}
+
+constexpr auto CBORArray::size() const noexcept -> size_type {
+  return elements.size();
+}
+
+constexpr auto CBORArray::operator[](size_type i) const noexcept
+    -> value_type const& {
+  return elements[i];
+}
+
+constexpr auto CBORArray::begin() const noexcept -> const_iterator {
+  return elements.begin();
+}
+
+constexpr auto CBORArray::end() const noexcept -> const_iterator {
+  return elements.end();
+}
+
+constexpr void CBORArray::push_back(value_type&& value) {
+  elements.push_back(std::move(value));
+}
+
+constexpr auto CBORMap::size() const noexcept -> size_type {
+  return entries.size() / 2;
+}
+
+constexpr auto CBORMap::key(size_type i) const noexcept
+    -> value_type const& {
+  return entries[2 * i];
+}
+
+constexpr auto CBORMap::value(size_type i) const noexcept
+    -> value_type const& {
+  return entries[2 * i + 1];
+}
+
+constexpr void CBORMap::insert(value_type&& key, value_type&& value) {
+  entries.push_back(std::move(key));
+  entries.push_back(std::move(value));
+}
+
+constexpr void CBORMap::reserve(size_type n) {
+  entries.reserve(2 * n);
+}
@@ -69,11 +69,27 @@ public:
   } catch (...) {
     return fail(current().function_name());
   }
+
+  TEST_CASE(construct_from_lvalue) {
+    CBORTstr text = u8"foo"_cbor_tstr;
+    CBORValue x = text;
+    CBORTag y{0_cbor, text};
+    auto const x_text = x.as_tstr();
+    auto const y_text = y.value().as_tstr();
+    if (text == u8"foo"s and x_text and *x_text == u8"foo"s and y_text and
+        *y_text == u8"foo"s) {
+      return pass(current().function_name());
+    }
+    return fail(current().function_name());
+  } catch (...) {
+    return fail(current().function_name());
+  }
 };
 
 int main(int argc, char *argv[]) {
   CBORValueTests testSuite{};
   testSuite.test_construct_tag();
   testSuite.test_move_tag();
+  testSuite.test_construct_from_lvalue();
   return testSuite.failure();
 }
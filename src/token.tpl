@@ -37,6 +37,9 @@ namespace token {
   /// [+ comment +]
   struct [+ kind +] {[+ IF value_type +]
     [+ value_type +] value;
+    [+ ENDIF +][+ IF width_type +]
+    /// number of bytes the argument occupied in the input
+    [+ width_type +] width = 0;
     [+ ENDIF +]
     friend constexpr auto kind([+kind+]) noexcept -> Kind { return Kind::[+kind+]; }
   };